@@ -0,0 +1,111 @@
+/**
+ * batch_engine.hpp
+ *
+ * Runs many independent instances (lanes) of one program at once, for
+ * input sweeps. Registers are kept structure-of-arrays, regs[32][lanes],
+ * and one decoded instruction is applied to every lane sitting at the
+ * same PC, with a lane mask selecting which results are kept. The lane
+ * loops are plain element-wise code the compiler vectorizes.
+ *
+ * Divergent lanes are split into groups by PC; the group with the lowest
+ * PC runs next, which lets lanes that skipped ahead over a branch merge
+ * again when the others catch up. Each lane has its own data and stack
+ * arena in one contiguous allocation; the text is decoded once and shared.
+ *
+ * At start every lane gets first + lane * step in a0 and its lane index
+ * in tp. Run limits count steps (one instruction over one lane group).
+ */
+
+#ifndef BATCH_ENGINE_HPP
+#define BATCH_ENGINE_HPP
+
+#include "common.hpp"
+#include "watchdog.hpp"
+
+class BatchEngine {
+public:
+    static constexpr int MAX_LANES = 65536;
+    static constexpr size_t LANE_ALIGN = 8;     // Lane count rounded up for the vector loops
+
+    struct Config {
+        int lanes = 64;
+        SignedWord first = 0;               // a0 of lane 0
+        SignedWord step = 1;                // a0 increment per lane
+        uint32_t data_size = 16 * 1024;     // Per-lane bytes from DATA_BASE
+        uint32_t stack_size = 16 * 1024;    // Per-lane bytes below the stack top
+        int show = 8;                       // Lanes listed in the report
+    };
+
+    BatchEngine();
+
+    // Validate and apply a configuration; error set on failure
+    static bool validate(const Config& cfg, std::string& error);
+    void configure(const Config& cfg);
+    const Config& get_config() const;
+
+    // Decode the text, copy the data image into every lane, reset registers
+    void start(const std::vector<Word>& text, Address text_addr,
+               const std::vector<Byte>& data, Address data_addr);
+
+    // Run until every lane stops or a limit is reached
+    StopReason run(const RunLimits& limits);
+
+    void print_config() const;
+    void print_stats() const;
+
+private:
+    enum class LaneState : uint8_t { RUNNING, HALTED, EXITED, TRAPPED };
+
+    Config config;
+    size_t lanes;                       // Padded to LANE_ALIGN; padding never runs
+    size_t arena_size;
+
+    std::vector<Instruction> program;
+    Address text_base;
+    Address data_base;
+    uint32_t data_bytes;                // data_size, grown to fit the data image
+    Address stack_base;
+
+    std::vector<Word> regs;             // 32 x lanes, register-major
+    std::vector<Address> pcs;
+    std::vector<Word> mask;             // ~0 for lanes in the current group
+    std::vector<Address> targets;       // Per-lane next PC of a control transfer
+    std::vector<Byte> arena;            // lanes x (data_size + stack_size)
+    std::vector<LaneState> state;
+    std::vector<Word> exit_codes;
+    std::vector<uint64_t> retired;
+
+    // Current group: lanes at group_pc; every other running lane is at
+    // waiting_pc or beyond
+    Address group_pc;
+    Address waiting_pc;
+    size_t running;
+
+    uint64_t steps;
+    uint64_t regroups;
+    double seconds;
+    Watchdog watchdog;
+
+    Word* reg(int r) { return &regs[static_cast<size_t>(r) * lanes]; }
+
+    // Pick the lowest-PC group; false when no lane is running
+    bool regroup();
+
+    // Execute the group's instruction; true if lanes may have diverged
+    bool execute(const Instruction& ins);
+
+    template <typename F> void write_lanes(int rd, F value);
+    template <typename B> void alu_lanes(const Instruction& ins, B operand_b);
+    void branch_lanes(const Instruction& ins);
+    void advance(Address next);
+    bool jump_lanes();
+    bool memory_lanes(const Instruction& ins);
+    void stop_lanes(LaneState s);
+
+    // Host pointer for bytes at addr in a lane's arena, nullptr if unmapped
+    Byte* translate(size_t lane, Address addr, int bytes);
+
+    static const char* state_name(LaneState s);
+};
+
+#endif // BATCH_ENGINE_HPP
@@ -0,0 +1,71 @@
+/**
+ * block_analyzer.hpp
+ *
+ * Steady-state throughput of a straight-line block or loop body on the
+ * 5-stage Pipeline, without running the program around it.
+ *
+ * The block is laid out 'iterations' times back to back in a scratch
+ * memory and run on a private Pipeline with the same hazard, forwarding
+ * and branch settings, synthetic register values and no caches or store
+ * buffer (perfect memory). Control flow is pinned so every copy runs in
+ * order: a closing branch back to the block start becomes an always-
+ * taken branch to the next copy (same redirect penalty, still reading
+ * its first source register), other branches become never-taken, jumps
+ * jump to the next instruction (keeping rd), and ecall/ebreak become nops.
+ *
+ * Every cycle the pipeline registers are sampled to build a per-
+ * instruction timeline (IF, ID, EX, MEM, WB).
+ */
+
+#ifndef BLOCK_ANALYZER_HPP
+#define BLOCK_ANALYZER_HPP
+
+#include "common.hpp"
+
+class BlockAnalyzer {
+public:
+    static constexpr int MAX_BLOCK = 256;           // Instructions
+    static constexpr int MAX_ITERATIONS = 10000;
+    static constexpr int TIMELINE_WIDTH = 96;       // Cycle columns
+
+    struct Config {
+        int iterations = 100;
+        int timeline = 2;           // Iterations shown in the timeline
+        bool hazard_detection = true;
+        bool forwarding = true;
+        BranchStage branch_stage = BranchStage::EX;
+    };
+
+    // Simulate the block (encoded words starting at start); error set on failure
+    bool analyze(const std::vector<Word>& block, Address start, const Config& cfg,
+                 std::string& error);
+
+    void print_report() const;
+
+private:
+    enum Stage { IF, ID, EX, MEM, STAGES };
+
+    // Cycles an instruction sat in each pipeline register (-1 = never)
+    struct Slot {
+        int64_t first[STAGES];
+        int64_t last[STAGES];
+    };
+
+    Config config;
+    Address block_start;
+    std::vector<Instruction> original;
+    std::vector<std::string> notes;     // How control flow was pinned, per instruction
+    std::vector<Slot> slots;            // iterations x block size, program order
+
+    uint64_t cycles;
+    uint64_t instructions;
+    uint64_t stalls;
+    uint64_t flushes;
+    uint64_t forwards;
+
+    Word pin(const Instruction& ins, size_t index, std::string& note) const;
+    int64_t retire_cycle(size_t dyn) const;
+    void print_timeline() const;
+};
+
+#endif // BLOCK_ANALYZER_HPP
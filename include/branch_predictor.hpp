@@ -0,0 +1,121 @@
+/**
+ * branch_predictor.hpp
+ *
+ * Conditional branch direction predictors for trace-driven evaluation.
+ * Predictors consume batches of outcomes and train as they go; each
+ * record is predicted before its outcome is applied, as in hardware
+ * with immediate update.
+ */
+
+#ifndef BRANCH_PREDICTOR_HPP
+#define BRANCH_PREDICTOR_HPP
+
+#include "common.hpp"
+
+// One conditional branch: PC (word aligned) | 2 if backward | 1 if taken
+using BranchRecord = uint32_t;
+
+class BranchPredictor {
+public:
+    virtual ~BranchPredictor() = default;
+
+    virtual std::string name() const = 0;
+    virtual uint64_t storage_bits() const = 0;
+    virtual void reset() = 0;
+
+    // Predict and train on count records in order; returns mispredictions
+    virtual uint64_t run(const BranchRecord* records, size_t count) = 0;
+};
+
+// Backward taken, forward not taken
+class StaticPredictor : public BranchPredictor {
+public:
+    std::string name() const override;
+    uint64_t storage_bits() const override;
+    void reset() override;
+    uint64_t run(const BranchRecord* records, size_t count) override;
+};
+
+// PC-indexed table of 2-bit counters
+class BimodalPredictor : public BranchPredictor {
+public:
+    explicit BimodalPredictor(int index_bits);
+    std::string name() const override;
+    uint64_t storage_bits() const override;
+    void reset() override;
+    uint64_t run(const BranchRecord* records, size_t count) override;
+
+private:
+    int index_bits;
+    std::vector<uint8_t> counters;
+};
+
+// 2-bit counters indexed by PC xor global history
+class GsharePredictor : public BranchPredictor {
+public:
+    GsharePredictor(int index_bits, int history_bits);
+    std::string name() const override;
+    uint64_t storage_bits() const override;
+    void reset() override;
+    uint64_t run(const BranchRecord* records, size_t count) override;
+
+private:
+    int index_bits;
+    int history_bits;
+    std::vector<uint8_t> counters;
+    uint64_t history;
+};
+
+// Bimodal and gshare components with a PC-indexed chooser
+class TournamentPredictor : public BranchPredictor {
+public:
+    TournamentPredictor(int index_bits, int history_bits);
+    std::string name() const override;
+    uint64_t storage_bits() const override;
+    void reset() override;
+    uint64_t run(const BranchRecord* records, size_t count) override;
+
+private:
+    int index_bits;
+    int history_bits;
+    std::vector<uint8_t> local;
+    std::vector<uint8_t> global;
+    std::vector<uint8_t> chooser;   // >= 2 selects the gshare component
+    uint64_t history;
+};
+
+// Reduced TAGE: a bimodal base and tagged tables over geometrically
+// increasing history lengths (up to 64). The longest matching table
+// provides the prediction; mispredictions allocate in a longer table.
+class TagePredictor : public BranchPredictor {
+public:
+    static constexpr int MAX_TABLES = 8;
+
+    TagePredictor(int base_bits, int table_bits, int num_tables,
+                  int min_history, int max_history);
+    std::string name() const override;
+    uint64_t storage_bits() const override;
+    void reset() override;
+    uint64_t run(const BranchRecord* records, size_t count) override;
+
+private:
+    static constexpr int TAG_BITS = 9;
+    static constexpr uint64_t AGING_PERIOD = 256 * 1024;   // Branches between useful-bit decay
+
+    struct Entry {
+        uint16_t tag = 0;       // 0 = empty; computed tags have the top bit set
+        int8_t ctr = 0;         // 3-bit signed, taken if >= 0
+        uint8_t useful = 0;     // 2-bit
+    };
+
+    int base_bits;
+    int table_bits;
+    int num_tables;
+    std::array<int, MAX_TABLES> history_len;
+    std::vector<uint8_t> base;
+    std::vector<Entry> tables;      // num_tables x 2^table_bits, table-major
+    uint64_t history;
+    uint64_t branches;
+};
+
+#endif // BRANCH_PREDICTOR_HPP
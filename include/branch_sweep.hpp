@@ -0,0 +1,54 @@
+/**
+ * branch_sweep.hpp
+ *
+ * Single-pass evaluation of many branch predictors.
+ * The functional engine hands over every retired instruction; conditional
+ * branch outcomes are buffered and each full batch is run through one
+ * predictor at a time, so that predictor's tables stay in cache for the
+ * whole batch instead of every predictor being touched per branch.
+ */
+
+#ifndef BRANCH_SWEEP_HPP
+#define BRANCH_SWEEP_HPP
+
+#include "common.hpp"
+#include "branch_predictor.hpp"
+#include <memory>
+
+class BranchSweep {
+public:
+    static constexpr size_t BATCH_SIZE = 4096;
+
+    // Default set: static, bimodal and gshare at several sizes and
+    // history lengths, tournament and TAGE-lite
+    BranchSweep();
+
+    void reset();
+
+    // Account one retired instruction
+    void retire(const Instruction& ins, bool taken) {
+        instructions++;
+        if (!ins.branch) return;
+        batch[batch_size++] = (ins.pc & ~3u) | (ins.imm < 0 ? 2u : 0u) | (taken ? 1u : 0u);
+        if (batch_size == BATCH_SIZE) flush();
+    }
+
+    // Run the buffered outcomes through every predictor
+    void flush();
+
+    void print_config() const;
+    void print_stats();
+
+private:
+    std::vector<std::unique_ptr<BranchPredictor>> predictors;
+    std::vector<uint64_t> mispredicts;
+
+    std::array<BranchRecord, BATCH_SIZE> batch;
+    size_t batch_size;
+
+    uint64_t instructions;
+    uint64_t branches;
+    uint64_t taken_count;
+};
+
+#endif // BRANCH_SWEEP_HPP
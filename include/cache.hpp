@@ -0,0 +1,110 @@
+/**
+ * cache.hpp
+ *
+ * Set-associative cache level for timing.
+ * Write-back, write-allocate, LRU replacement. Holds tags only; data
+ * always comes from Memory. A miss is forwarded to the next level and
+ * the latencies add up. Each line remembers when its fill completes, so
+ * a hit on a line still in flight (demand or prefetch) waits for it.
+ */
+
+#ifndef CACHE_HPP
+#define CACHE_HPP
+
+#include "common.hpp"
+#include "prefetcher.hpp"
+#include "stats.hpp"
+
+// One level of the memory hierarchy (cache or DRAM)
+class MemoryLevel {
+public:
+    virtual ~MemoryLevel() = default;
+
+    // Access one line; returns total latency in cycles including lower levels
+    virtual int access(Address addr, bool write, uint64_t now) = 0;
+
+    virtual void reset() = 0;
+    virtual void print_config() const = 0;
+    virtual void print_stats() const = 0;
+
+    // Register counters under prefix (e.g. "caches.l1d")
+    virtual void register_stats(StatsRegistry& stats, const std::string& prefix) const = 0;
+};
+
+class Cache : public MemoryLevel {
+public:
+    struct Config {
+        uint32_t size = 32 * 1024;  // Bytes
+        uint32_t line_size = 64;    // Bytes
+        int assoc = 8;
+        int latency = 1;            // Hit latency in cycles
+    };
+
+    Cache(const std::string& name, const Config& config, MemoryLevel* next);
+
+    // Validate and apply a configuration; error set on failure
+    static bool validate(const Config& config, std::string& error);
+    void configure(const Config& cfg);
+    const Config& get_config() const;
+    void set_next(MemoryLevel* level);
+
+    // Prefetcher trained on demand accesses (NONE = no prefetching)
+    void set_prefetcher(const Prefetcher::Config& pf_config);
+    const Prefetcher::Config& get_prefetcher_config() const;
+
+    // Demand access from the core: trains the prefetcher and issues its
+    // prefetches. Lower levels only see access().
+    int demand_access(Address addr, bool write, uint64_t now, Address pc);
+
+    // MemoryLevel
+    int access(Address addr, bool write, uint64_t now) override;
+    void reset() override;
+    void print_config() const override;
+    void print_stats() const override;
+    void register_stats(StatsRegistry& stats, const std::string& prefix) const override;
+
+    // Statistics
+    uint64_t get_accesses() const;
+    uint64_t get_misses() const;
+
+private:
+    struct Line {
+        uint32_t tag = 0;
+        bool valid = false;
+        bool dirty = false;
+        bool prefetched = false;    // Filled by a prefetch, not yet used
+        uint64_t last_use = 0;
+        uint64_t ready_at = 0;      // Cycle the fill completes
+    };
+
+    std::string name;
+    Config config;
+    MemoryLevel* next;
+
+    uint32_t num_sets;
+    int line_shift;
+    std::vector<Line> lines;    // num_sets * assoc, set-major
+    uint64_t use_clock;
+
+    Prefetcher::Config pf_config;
+    std::unique_ptr<Prefetcher> prefetcher;
+    std::vector<Address> pf_candidates;
+    bool last_trigger;          // Last demand access missed or hit a prefetched line
+
+    // Statistics
+    uint64_t accesses;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t writebacks;
+    uint64_t total_latency;
+    uint64_t pf_issued;
+    uint64_t pf_useful;         // Prefetched lines later used by a demand access
+    uint64_t pf_late;           // ...but the demand access arrived before the fill
+    uint64_t pf_unused;         // Prefetched lines evicted without use
+
+    Line* find(Address addr, uint32_t& set, uint32_t& tag);
+    Line* allocate(uint32_t set, uint64_t now);
+    void prefetch(Address addr, uint64_t now);
+};
+
+#endif // CACHE_HPP
@@ -0,0 +1,103 @@
+/**
+ * coherence.hpp
+ *
+ * MESI coherence timing model over private per-hart L1 data caches.
+ * A directory (snoop filter) records which harts hold each cached line,
+ * so hits never look at other caches and misses only visit the holders.
+ *
+ * Counts upgrades, invalidations and cache-to-cache transfers. Every
+ * line remembers the bytes its hart touched since the fill; a write that
+ * invalidates a copy whose touched bytes it does not overlap is counted
+ * as false sharing, per line, for the hotspot report.
+ */
+
+#ifndef COHERENCE_HPP
+#define COHERENCE_HPP
+
+#include "common.hpp"
+#include <unordered_map>
+
+class CoherenceModel {
+public:
+    static constexpr int MAX_HARTS = 16;
+
+    struct Config {
+        int harts = 2;
+        uint32_t size = 32 * 1024;      // Per-hart L1 bytes
+        uint32_t line_size = 64;        // Bytes, at most 64
+        int assoc = 8;
+        int hit_latency = 1;
+        int upgrade_latency = 10;       // S -> M: invalidate the other copies
+        int transfer_latency = 20;      // Line supplied by another cache
+        int memory_latency = 100;       // Line supplied by memory
+    };
+
+    CoherenceModel();
+    explicit CoherenceModel(const Config& cfg);
+
+    // Validate and apply a configuration; error set on failure
+    static bool validate(const Config& cfg, std::string& error);
+    void configure(const Config& cfg);
+    const Config& get_config() const;
+    void reset();
+
+    // Data access by a hart; returns latency in cycles
+    int access(int hart, Address addr, int bytes, bool write);
+
+    void print_config() const;
+    void print_stats() const;
+
+    // Lines with the most invalidations, labelled with the nearest symbol
+    void print_hotspots(const std::map<std::string, Address>& symbols, size_t count = 10) const;
+
+private:
+    enum class State : uint8_t { I, S, E, M };
+
+    struct Line {
+        uint32_t line_addr = 0;     // addr >> line_shift
+        State state = State::I;
+        uint64_t touched = 0;       // Byte mask accessed by this hart since the fill
+        uint64_t last_use = 0;
+    };
+
+    struct HartStats {
+        uint64_t accesses = 0;
+        uint64_t misses = 0;
+        uint64_t upgrades = 0;
+        uint64_t transfers_in = 0;      // Misses served by another cache
+        uint64_t invalidated = 0;       // Copies lost to other harts' writes
+    };
+
+    struct Hotspot {
+        uint64_t invalidations = 0;
+        uint64_t false_sharing = 0;
+        uint64_t transfers = 0;
+        uint32_t writers = 0;           // Harts whose writes invalidated (mask)
+        uint32_t victims = 0;           // Harts that lost their copy (mask)
+    };
+
+    Config config;
+    uint32_t num_sets;
+    int line_shift;
+
+    std::vector<Line> lines;            // harts x sets x assoc
+    std::vector<HartStats> stats;
+    uint64_t use_clock;
+
+    // Directory: line address -> mask of harts holding it
+    std::unordered_map<uint32_t, uint32_t> holders;
+    std::unordered_map<uint32_t, Hotspot> hotspots;
+
+    uint64_t invalidations;
+    uint64_t false_sharing;
+    uint64_t transfers;
+    uint64_t writebacks;
+    uint64_t memory_fetches;
+
+    Line* find(int hart, uint32_t line_addr);
+    Line* allocate(int hart, uint32_t line_addr);
+    void invalidate_others(int hart, uint32_t line_addr, uint32_t mask, uint64_t write_bytes);
+    static std::string hart_list(uint32_t mask);
+};
+
+#endif // COHERENCE_HPP
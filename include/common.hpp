@@ -32,6 +32,9 @@ using HalfWord = uint16_t;      // 16-bit
 
 constexpr int NUM_REGISTERS = 32;
 
+// ecall with a7 == SYS_EXIT ends the program with exit code a0
+constexpr Word SYS_EXIT = 93;
+
 // =============================================================================
 // Instruction Format
 // =============================================================================
@@ -111,6 +114,12 @@ struct Instruction {
     bool jump = false;          // Jump instruction?
     bool alu_src = false;       // Use immediate as ALU input B?
     AluOp alu_op = AluOp::NONE;
+
+    // Operand usage: register fields that are really read/written, as
+    // opposed to immediate bits that happen to sit in the same positions
+    bool reads_rs1 = false;
+    bool reads_rs2 = false;
+    bool writes_rd = false;     // reg_write with rd != x0
     
     Address pc = 0;             // PC where fetched
     std::string text;           // Disassembly string
@@ -172,6 +181,51 @@ enum class Forward {
     MEM_WB      // Forward from MEM/WB
 };
 
+// Pipeline stage in which branches and jumps redirect fetch.
+// Each stage later costs one more squashed slot per taken branch.
+enum class BranchStage {
+    ID,         // Comparator in decode: 1 slot, extra interlocks
+    EX,         // 2 slots
+    MEM         // 3 slots
+};
+
+inline const char* branch_stage_name(BranchStage stage) {
+    switch (stage) {
+        case BranchStage::ID:  return "ID";
+        case BranchStage::EX:  return "EX";
+        case BranchStage::MEM: return "MEM";
+    }
+    return "?";
+}
+
+// =============================================================================
+// Run Control
+// =============================================================================
+
+// Why an engine run stopped
+enum class StopReason {
+    NONE,           // Still running
+    HALTED,         // ecall
+    EXITED,         // ecall exit (a7 = 93), exit code in a0
+    BREAKPOINT,
+    WATCHPOINT,     // Store to a watched address
+    TRAP,           // ebreak or illegal instruction
+    ROI_START,      // Reached start of region of interest
+    ROI_END,        // Reached end of region of interest
+    CONDITION,      // run-until predicate became true
+    INSN_LIMIT,
+    CYCLE_LIMIT,
+    TIME_LIMIT,
+    INTERRUPTED     // Ctrl-C
+};
+
+// Per-run budgets (0 = unlimited)
+struct RunLimits {
+    uint64_t max_instructions = 0;
+    uint64_t max_cycles = 0;
+    double max_seconds = 0;
+};
+
 // =============================================================================
 // Utility Functions
 // =============================================================================
@@ -186,11 +240,23 @@ inline SignedWord sign_extend(Word value, int bits) {
     return static_cast<SignedWord>(value);
 }
 
+// Write "0x" + zero-padded hex digits into dst (needs 10 bytes), returns length
+inline int format_hex(char* dst, Word value, int width = 8) {
+    static const char digits[] = "0123456789abcdef";
+    int n = 8;
+    while (n > width && ((value >> ((n - 1) * 4)) & 0xF) == 0) n--;
+    dst[0] = '0';
+    dst[1] = 'x';
+    for (int i = 0; i < n; i++) {
+        dst[2 + i] = digits[(value >> ((n - 1 - i) * 4)) & 0xF];
+    }
+    return 2 + n;
+}
+
 // Format as hex string
 inline std::string to_hex(Word value, int width = 8) {
-    std::ostringstream oss;
-    oss << "0x" << std::hex << std::setfill('0') << std::setw(width) << value;
-    return oss.str();
+    char tmp[10];
+    return std::string(tmp, format_hex(tmp, value, width));
 }
 
 // Register ABI name
@@ -205,6 +271,51 @@ inline std::string reg_name(int reg) {
     return "x" + std::to_string(reg);
 }
 
+// Register index from "x5" or ABI name ("t0", "fp"), -1 if unknown
+inline int reg_index(const std::string& name) {
+    if (name.empty()) return -1;
+
+    if (name[0] == 'x') {
+        try {
+            size_t used = 0;
+            int n = std::stoi(name.substr(1), &used);
+            if (used != name.size() - 1) return -1;
+            return (n >= 0 && n < 32) ? n : -1;
+        } catch (...) { return -1; }
+    }
+
+    static const std::map<std::string, int> abi = {
+        {"zero",0},{"ra",1},{"sp",2},{"gp",3},{"tp",4},
+        {"t0",5},{"t1",6},{"t2",7},{"s0",8},{"fp",8},{"s1",9},
+        {"a0",10},{"a1",11},{"a2",12},{"a3",13},{"a4",14},{"a5",15},
+        {"a6",16},{"a7",17},{"s2",18},{"s3",19},{"s4",20},{"s5",21},
+        {"s6",22},{"s7",23},{"s8",24},{"s9",25},{"s10",26},{"s11",27},
+        {"t3",28},{"t4",29},{"t5",30},{"t6",31}
+    };
+    auto it = abi.find(name);
+    return (it != abi.end()) ? it->second : -1;
+}
+
+// Stop reason to string
+inline const char* stop_reason_name(StopReason reason) {
+    switch (reason) {
+        case StopReason::NONE:        return "running";
+        case StopReason::HALTED:      return "halted";
+        case StopReason::EXITED:      return "exited";
+        case StopReason::BREAKPOINT:  return "breakpoint";
+        case StopReason::WATCHPOINT:  return "watchpoint";
+        case StopReason::TRAP:        return "trap";
+        case StopReason::ROI_START:   return "start of region of interest";
+        case StopReason::ROI_END:     return "end of region of interest";
+        case StopReason::CONDITION:   return "condition met";
+        case StopReason::INSN_LIMIT:  return "instruction limit reached";
+        case StopReason::CYCLE_LIMIT: return "cycle limit reached";
+        case StopReason::TIME_LIMIT:  return "time limit reached";
+        case StopReason::INTERRUPTED: return "interrupted";
+    }
+    return "unknown";
+}
+
 // Instruction type to string
 inline std::string ins_name(InsType type) {
     switch (type) {
@@ -259,4 +370,56 @@ inline std::string ins_name(InsType type) {
     }
 }
 
+// Bytes read or written by a load/store
+inline int access_bytes(InsType type) {
+    switch (type) {
+        case InsType::LB: case InsType::LBU: case InsType::SB: return 1;
+        case InsType::LH: case InsType::LHU: case InsType::SH: return 2;
+        default: return 4;
+    }
+}
+
+// =============================================================================
+// Instruction Mix
+// =============================================================================
+
+constexpr int NUM_INS_TYPES = static_cast<int>(InsType::UNKNOWN) + 1;
+
+// Engines count retired instructions per InsType (one indexed add); the
+// classes are summed from those counts when statistics are read
+enum class InsClass { ALU, MULDIV, LOAD, STORE, BRANCH, JUMP, SYSTEM, COUNT };
+
+constexpr int NUM_INS_CLASSES = static_cast<int>(InsClass::COUNT);
+
+inline InsClass ins_class(InsType type) {
+    if (type >= InsType::LB && type <= InsType::LHU) return InsClass::LOAD;
+    if (type >= InsType::SB && type <= InsType::SW) return InsClass::STORE;
+    if (type >= InsType::BEQ && type <= InsType::BGEU) return InsClass::BRANCH;
+    if (type == InsType::JAL || type == InsType::JALR) return InsClass::JUMP;
+    if (type >= InsType::MUL && type <= InsType::REMU) return InsClass::MULDIV;
+    if (type == InsType::ECALL || type == InsType::EBREAK) return InsClass::SYSTEM;
+    return InsClass::ALU;
+}
+
+inline const char* ins_class_name(InsClass c) {
+    switch (c) {
+        case InsClass::ALU:    return "alu";
+        case InsClass::MULDIV: return "muldiv";
+        case InsClass::LOAD:   return "load";
+        case InsClass::STORE:  return "store";
+        case InsClass::BRANCH: return "branch";
+        case InsClass::JUMP:   return "jump";
+        case InsClass::SYSTEM: return "system";
+        default:               return "unknown";
+    }
+}
+
+inline uint64_t class_count(const std::array<uint64_t, NUM_INS_TYPES>& counts, InsClass c) {
+    uint64_t n = 0;
+    for (int t = 0; t < NUM_INS_TYPES - 1; t++) {
+        if (ins_class(static_cast<InsType>(t)) == c) n += counts[t];
+    }
+    return n;
+}
+
 #endif // COMMON_HPP
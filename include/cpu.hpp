@@ -13,43 +13,102 @@
 #include "register_file.hpp"
 #include "alu.hpp"
 #include "decoder.hpp"
+#include "predicate.hpp"
+#include "watchdog.hpp"
+#include "timing_model.hpp"
+#include "branch_sweep.hpp"
+#include "loop_profiler.hpp"
 
 class CPU {
 public:
     CPU(Memory& mem, RegisterFile& regs);
     void reset();
 
-    // Execute one instruction, returns false if halted
-    bool step();
+    // Execute one instruction, returns NONE or why execution stopped
+    StopReason step();
 
-    // Run until halt or breakpoint
-    void run();
+    // Execute up to max_steps instructions. Returns NONE if all ran,
+    // otherwise the reason for stopping (halt, breakpoint, limit, Ctrl-C...)
+    StopReason run(uint64_t max_steps = std::numeric_limits<uint64_t>::max());
+
+    // Same, also stopping (CONDITION) once the predicate holds
+    StopReason run_until(Predicate& pred);
+    Predicate::State predicate_state() const;
 
     // State access
     Address get_pc() const;
     void set_pc(Address addr);
     uint64_t get_cycle_count() const;
     uint64_t get_instruction_count() const;
+    void register_stats(StatsRegistry& stats, const std::string& prefix) const;
     bool is_halted() const;
+    Word get_exit_code() const;
 
     // Last executed instruction (for display)
     const Instruction& get_last_instruction() const;
 
+    // Run limits (0 = unlimited), applied per run
+    void set_limits(const RunLimits& run_limits);
+    const RunLimits& get_limits() const;
+
+    // Call sample every period instructions (or cycles) during runs (0 = off)
+    void set_sampling(uint64_t period, bool by_cycles, std::function<void()> sample);
+
     // Breakpoints
     void add_breakpoint(Address addr);
     void remove_breakpoint(Address addr);
     void clear_breakpoints();
     bool has_breakpoint(Address addr) const;
 
+    // Watchpoints (stop after a store touches the word)
+    void add_watchpoint(Address addr);
+    void clear_watchpoints();
+
+    // Region of interest: stop when execution reaches end
+    void set_roi_end(Address addr);
+    void clear_roi_end();
+
+    // Stop once per run from reset when execution reaches start
+    void set_roi_start(Address addr);
+    void clear_roi_start();
+
+    // Timing model fed with every retired instruction (nullptr = none)
+    void set_timing_model(TimingModel* model);
+
+    // Branch predictor sweep fed with every retired instruction (nullptr = none)
+    void set_branch_sweep(BranchSweep* sweep);
+
+    // Loop profiler fed with every taken branch and jump (nullptr = none)
+    void set_loop_profiler(LoopProfiler* profiler);
+
 private:
     Memory& mem;
     RegisterFile& regs;
     Address pc;
     uint64_t cycles;
     uint64_t instructions;
+    std::array<uint64_t, NUM_INS_TYPES> type_counts;    // Retired per InsType
     bool halted;
+    StopReason halt_reason;
+    Word exit_code;
     Instruction last_ins;
+    Address last_mem_addr;
     std::vector<Address> breakpoints;
+    std::vector<Address> watchpoints;
+    bool watch_hit;
+    bool roi_enabled;
+    Address roi_end;
+    bool roi_start_enabled;
+    bool roi_start_armed;
+    Address roi_start;
+
+    // Limits
+    RunLimits limits;
+    Watchdog watchdog;
+
+    TimingModel* timing;
+    BranchSweep* branch_sweep;
+    LoopProfiler* loops;
 
     // Pipeline stages (all in one cycle for single-cycle)
     Word fetch();
@@ -0,0 +1,94 @@
+/**
+ * dataflow_model.hpp
+ *
+ * Dataflow limit of the retired instruction stream: every instruction
+ * starts as soon as its register and memory (store -> load) producers
+ * have completed, with perfect branch prediction, unlimited functional
+ * units and fixed per-class latencies. The unbounded window gives the
+ * critical path; a window of W additionally lets an instruction start
+ * only after the one W places earlier has retired in order.
+ *
+ * Several window sizes are evaluated in one pass. Each keeps O(W) state:
+ * a ring of retire cycles and the stores of the last W instructions,
+ * which are the only ones that can still delay a load. The unbounded
+ * window remembers the last STORE_HISTORY stores.
+ *
+ * Also collects the RAW dependency distance (in dynamic instructions)
+ * of every register and memory operand.
+ */
+
+#ifndef DATAFLOW_MODEL_HPP
+#define DATAFLOW_MODEL_HPP
+
+#include "common.hpp"
+#include "timing_model.hpp"
+#include <deque>
+#include <unordered_map>
+
+class DataflowModel : public TimingModel {
+public:
+    static constexpr int MAX_WINDOWS = 8;
+    static constexpr int MAX_WINDOW = 1 << 20;
+    static constexpr size_t STORE_HISTORY = 1 << 16;    // Unbounded window
+    static constexpr int DISTANCE_BUCKETS = 9;          // 1, 2, 3, 4, 5-8, ... 65+
+
+    struct Config {
+        std::vector<int> windows = {16, 64, 256, 0};    // 0 = unbounded
+        int alu_latency = 1;        // ALU, branches, jumps
+        int mul_latency = 3;
+        int div_latency = 20;
+        int load_latency = 3;       // Address generation + L1 hit
+        int store_latency = 1;      // Until a load can read the data
+    };
+
+    DataflowModel();
+    explicit DataflowModel(const Config& cfg);
+
+    void set_config(const Config& cfg);
+    const Config& get_config() const;
+
+    // TimingModel
+    const char* name() const override;
+    void reset() override;
+    void retire(const RetiredInsn& r) override;
+    uint64_t get_cycle_count() const override;     // Largest window
+    uint64_t get_instruction_count() const override;
+    void print_config() const override;
+    void print_stats() const override;
+    void register_stats(StatsRegistry& stats, const std::string& prefix) const override;
+
+private:
+    struct StoreEntry {
+        uint64_t seq;
+        uint64_t ready;
+    };
+
+    struct Window {
+        int size;                                   // 0 = unbounded
+        std::array<uint64_t, NUM_REGISTERS> reg_ready;
+        std::vector<uint64_t> retired;              // In-order retire cycle of seq % size
+        uint64_t critical_path;                     // Latest completion so far
+        std::unordered_map<Address, StoreEntry> stores;     // Word -> last store
+        std::deque<std::pair<Address, uint64_t>> store_order;
+    };
+
+    Config config;
+    std::vector<Window> windows;                    // Ascending, unbounded last
+
+    uint64_t instructions;
+    std::array<uint64_t, NUM_REGISTERS> reg_writer; // Sequence number + 1 of the last writer
+    std::array<bool, NUM_REGISTERS> reg_loaded;     // Last writer was a load
+    std::array<uint64_t, DISTANCE_BUCKETS> reg_distance;
+    std::array<uint64_t, DISTANCE_BUCKETS> mem_distance;
+    uint64_t reg_operands;                          // Operands read from registers
+    uint64_t mem_operands;                          // Loads that read a tracked store
+    uint64_t stalls_forwarding;                     // 5-stage Pipeline estimates, in cycles
+    uint64_t stalls_no_forwarding;
+
+    int latency(const Instruction& ins) const;
+    void expire_stores(Window& w, uint64_t seq) const;
+    static int distance_bucket(uint64_t distance);
+    static std::string window_name(int size);
+};
+
+#endif // DATAFLOW_MODEL_HPP
@@ -0,0 +1,59 @@
+/**
+ * dram.hpp
+ *
+ * DRAM timing: independent banks with an open row buffer each.
+ * Row hit: tCL. Closed bank: tRCD + tCL. Row conflict: tRP + tRCD + tCL.
+ * Every access also pays a fixed controller/bus latency, and waits for
+ * its bank to finish the previous access.
+ */
+
+#ifndef DRAM_HPP
+#define DRAM_HPP
+
+#include "common.hpp"
+#include "cache.hpp"
+
+class Dram : public MemoryLevel {
+public:
+    struct Config {
+        int banks = 8;
+        uint32_t row_size = 2048;   // Bytes per row (per bank)
+        int t_rcd = 14;             // Activate to read
+        int t_cl = 14;              // Read to data
+        int t_rp = 14;              // Precharge
+        int bus_latency = 4;        // Controller and transfer
+    };
+
+    explicit Dram(const Config& config);
+
+    static bool validate(const Config& config, std::string& error);
+    void configure(const Config& cfg);
+    const Config& get_config() const;
+
+    // MemoryLevel
+    int access(Address addr, bool write, uint64_t now) override;
+    void reset() override;
+    void print_config() const override;
+    void print_stats() const override;
+    void register_stats(StatsRegistry& stats, const std::string& prefix) const override;
+
+private:
+    struct Bank {
+        bool open = false;
+        uint32_t row = 0;
+        uint64_t ready = 0;     // Cycle the bank can start the next access
+    };
+
+    Config config;
+    std::vector<Bank> banks;
+
+    // Statistics
+    uint64_t accesses;
+    uint64_t row_hits;
+    uint64_t row_empty;
+    uint64_t row_conflicts;
+    uint64_t queue_cycles;
+    uint64_t total_latency;
+};
+
+#endif // DRAM_HPP
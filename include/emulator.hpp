@@ -14,6 +14,18 @@
 #include "assembler.hpp"
 #include "cpu.hpp"
 #include "pipeline.hpp"
+#include "output_buffer.hpp"
+#include "predicate.hpp"
+#include "timing_model.hpp"
+#include "stats.hpp"
+#include "sampler.hpp"
+#include "memory_hierarchy.hpp"
+#include "miss_profiler.hpp"
+#include "branch_sweep.hpp"
+#include "smp.hpp"
+#include "batch_engine.hpp"
+#include "interval_model.hpp"
+#include <memory>
 
 class Emulator {
 public:
@@ -36,11 +48,17 @@ public:
     // Execute a single command, returns false to quit
     bool execute_command(const std::string& input);
 
+    // Execute a command file without prompts, returns false to quit
+    bool run_script(const std::string& filename);
+
 private:
     Memory mem;
     RegisterFile regs;
     CPU cpu;
     Pipeline pipeline;
+    MemoryHierarchy caches;
+    Smp smp;
+    BatchEngine batch;
     Assembler assembler;
     Assembler::Result asm_result;
 
@@ -48,11 +66,36 @@ private:
     bool running;
     bool program_loaded;
 
+    // Buffered output for bulk step/trace printing
+    OutputBuffer out;
+
+    // Nesting depth of 'source' scripts
+    int script_depth;
+
+    // Timing model attached to the single-cycle CPU (optional)
+    std::unique_ptr<TimingModel> timing;
+
+    // Branch predictor sweep attached to the single-cycle CPU (optional)
+    std::unique_ptr<BranchSweep> branch_sweep;
+
+    // Named statistics of every component, for 'stats text|json|csv'
+    StatsRegistry stats;
+
+    // Interval snapshots of the current engine (optional)
+    std::unique_ptr<Sampler> sampler;
+
+    // Loop profiler attached to the current engine (optional)
+    std::unique_ptr<LoopProfiler> loop_profiler;
+
+    // Data cache misses by instruction and data object (optional)
+    std::unique_ptr<MissProfiler> miss_profiler;
+
     // Command handlers
     void cmd_help();
     void cmd_load(const std::string& filename);
-    void cmd_run();
-    void cmd_step(int count);
+    void cmd_run(Predicate* until = nullptr);
+    void cmd_step(int count, bool quiet, const std::string& filename,
+                  Predicate* until = nullptr);
     void cmd_reset();
     void cmd_regs();
     void cmd_reg(const std::string& reg_name);
@@ -62,19 +105,50 @@ private:
     void cmd_mode(const std::string& mode_str);
     void cmd_hazards(const std::string& state);
     void cmd_forward(const std::string& state);
+    void cmd_resolve(const std::string& stage);
+    void cmd_cache(const std::vector<std::string>& tokens);
+    void cmd_storebuf(const std::vector<std::string>& tokens);
     void cmd_break(const std::string& target);
     void cmd_breakpoints();
+    void cmd_watch(const std::string& target);
+    void cmd_roi(const std::vector<std::string>& tokens);
     void cmd_clear();
     void cmd_symbols();
     void cmd_disasm(Address addr, int count);
     void cmd_pipeline();
-    void cmd_stats();
+    void cmd_stats(const std::vector<std::string>& tokens);
+    void cmd_sample(const std::vector<std::string>& tokens);
+    void cmd_loops(const std::vector<std::string>& tokens);
+    void cmd_misses(const std::vector<std::string>& tokens);
+    void cmd_limit(const std::vector<std::string>& tokens);
+    void cmd_timing(const std::vector<std::string>& tokens);
+    void cmd_bpsweep(const std::vector<std::string>& tokens);
+    void cmd_smp(const std::vector<std::string>& tokens);
+    void cmd_batch(const std::vector<std::string>& tokens);
+    void cmd_analyze(const std::vector<std::string>& tokens);
+    void cmd_validate(const std::vector<std::string>& tokens);
+    bool cmd_repeat(const std::vector<std::string>& tokens);
+    bool cmd_if(const std::vector<std::string>& tokens);
 
     // Helpers
     void print_welcome();
     void print_prompt();
+    std::string describe_stop(StopReason reason) const;
+    bool roi_started(StopReason reason);
+    uint64_t instruction_count() const;     // Of the current engine
+    uint64_t cycle_count() const;
+    void register_timing_stats();
+    void stop_sampling(const char* why);
+    void attach_loop_profiler();
     void print_instruction(Address pc);
+    void print_instruction(OutputBuffer& buf, const Instruction& ins);
     Address resolve_address(const std::string& str);
+    IntervalModel::Config interval_config() const;
+    int parse_register(const std::string& name);
+    bool compile_predicate(const std::string& text, Predicate& pred, size_t& used);
+    bool compile_predicate(const std::string& text, Predicate& pred);
+    bool test_predicate(Predicate& pred);
+    static std::string join(const std::vector<std::string>& tokens, size_t start, size_t end);
     std::vector<std::string> tokenize(const std::string& input);
 };
 
@@ -0,0 +1,98 @@
+/**
+ * inorder_model.hpp
+ *
+ * Trace-driven timing model of an in-order superscalar core.
+ * Up to 'width' instructions issue to EX together, subject to pairing
+ * rules: one memory op and one branch/jump per cycle, and no RAW
+ * dependency inside the group. Results are forwarded from every lane.
+ *
+ * The stage sequence is IF x fetch_stages, ID x decode_stages, EX (latency
+ * per operation class), MEM x mem_stages, WB. Hazard windows, forwarding
+ * distances and the taken-branch penalty are derived from it; the default
+ * matches the 5-stage Pipeline.
+ */
+
+#ifndef INORDER_MODEL_HPP
+#define INORDER_MODEL_HPP
+
+#include "common.hpp"
+#include "timing_model.hpp"
+
+class InOrderModel : public TimingModel {
+public:
+    static constexpr int MAX_WIDTH = 8;
+
+    struct Config {
+        int width = 2;              // Fetch/decode/issue width (1-MAX_WIDTH)
+        bool forwarding = true;     // Forward from the end of EX and MEM, all lanes
+
+        // Stage sequence
+        int fetch_stages = 1;
+        int decode_stages = 1;
+        int mem_stages = 1;         // Load data available after the last one
+        int alu_latency = 1;        // EX cycles: ALU, address generation, branches
+        int mul_latency = 1;        // Pipelined multiplier
+        int div_latency = 1;        // Unpipelined divider, blocks EX
+        BranchStage branch_stage = BranchStage::EX;
+    };
+
+    InOrderModel();
+    explicit InOrderModel(const Config& cfg);
+
+    void set_config(const Config& cfg);
+    const Config& get_config() const;
+
+    // TimingModel
+    const char* name() const override;
+    void reset() override;
+    void retire(const RetiredInsn& r) override;
+    uint64_t get_cycle_count() const override;
+    uint64_t get_instruction_count() const override;
+    void print_config() const override;
+    void print_stats() const override;
+    void register_stats(StatsRegistry& stats, const std::string& prefix) const override;
+
+private:
+    Config config;
+
+    // Derived from the stage sequence
+    uint64_t first_ex;          // EX cycle of the first instruction
+    uint64_t redirect_delay;    // Taken branch EX cycle -> target EX cycle
+
+    // Issue group being filled; all its instructions are in EX at cur_cycle
+    uint64_t cur_cycle;
+    int group_size;
+    bool group_mem;
+    bool group_ctrl;
+
+    // Scoreboard: earliest EX cycle that can consume each register
+    std::array<uint64_t, NUM_REGISTERS> reg_ready;
+
+    // Earliest EX cycle after a taken branch/jump redirects fetch
+    uint64_t fetch_ready;
+
+    // Earliest EX cycle while the divider or a cache miss blocks the pipe
+    uint64_t ex_free;
+
+    // Cycle the last instruction leaves WB
+    uint64_t last_done;
+
+    // Statistics
+    uint64_t instructions;
+    std::array<uint64_t, MAX_WIDTH + 1> issue_hist;    // Cycles with k issued
+    uint64_t split_width;       // Group full
+    uint64_t split_mem;         // Second memory op
+    uint64_t split_ctrl;        // Second branch/jump
+    uint64_t split_dep;         // Operand not ready (includes intra-group RAW)
+    uint64_t split_redirect;    // Waiting for fetch after a taken branch
+    uint64_t split_struct;      // EX blocked by the divider or a cache miss
+    uint64_t data_stall_cycles;
+    uint64_t control_stall_cycles;
+    uint64_t struct_stall_cycles;
+
+    void close_group(uint64_t next_cycle);
+    int ex_latency(const Instruction& ins) const;
+    std::string stage_list() const;
+};
+
+#endif // INORDER_MODEL_HPP
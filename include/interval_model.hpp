@@ -0,0 +1,124 @@
+/**
+ * interval_model.hpp
+ *
+ * Fast approximate timing of the 5-stage Pipeline for whole-program runs
+ * on the single-cycle engine.
+ *
+ * Basic blocks (straight-line runs up to the first branch, jump or system
+ * instruction) are cached by start PC. The first time a block retires it
+ * is scheduled statically with the Pipeline's interlock rules under the
+ * configured hazard, forwarding and branch settings: load-use stalls and
+ * the extra waits of an ID-stage comparator. Later executions only add
+ * what varies at runtime:
+ *   - operands produced by the previous block's last instructions
+ *   - the redirect penalty after taken branches and jumps (the Pipeline
+ *     predicts not taken, so every taken branch is a misprediction)
+ *   - I-cache and D-cache miss latency, serialized like a blocking pipe,
+ *     except that a fetch miss hides the operand wait of the instruction
+ *     it delays
+ *   - the I-cache fills of the squashed fetches behind a taken branch
+ *
+ * The store buffer is not modelled.
+ */
+
+#ifndef INTERVAL_MODEL_HPP
+#define INTERVAL_MODEL_HPP
+
+#include "common.hpp"
+#include "timing_model.hpp"
+#include <unordered_map>
+
+class IntervalModel : public TimingModel {
+public:
+    static constexpr int MAX_BLOCK = 64;        // Instructions per cached block
+
+    struct Config {
+        bool hazard_detection = true;
+        bool forwarding = true;
+        BranchStage branch_stage = BranchStage::EX;
+    };
+
+    IntervalModel();
+    explicit IntervalModel(const Config& cfg);
+
+    void set_config(const Config& cfg);
+    const Config& get_config() const;
+
+    // TimingModel
+    const char* name() const override;
+    void reset() override;
+    void retire(const RetiredInsn& r) override;
+    uint64_t get_cycle_count() const override;
+    uint64_t get_instruction_count() const override;
+    void print_config() const override;
+    void print_stats() const override;
+    void register_stats(StatsRegistry& stats, const std::string& prefix) const override;
+
+private:
+    // Only the first HEAD instructions of a block can wait on the previous
+    // block, and only its writers in the last TAIL ID cycles can delay the next
+    static constexpr int HEAD = 2;
+    static constexpr int TAIL = 2;
+
+    // Register read by a head instruction before the block writes it
+    struct HeadRead {
+        uint8_t reg;
+        uint8_t index;          // Head instruction
+        bool id_branch;         // Comparator in ID: waits longer
+    };
+
+    // Last writer of a register close to the end of the block
+    struct TailWrite {
+        uint8_t reg;
+        uint8_t back;           // ID cycles before the block's last one
+        bool load;
+    };
+
+    struct Block {
+        std::vector<Instruction> recorded;      // Only while first retiring
+        int size = 0;
+        int span = 0;           // ID cycles from the first to the last instruction
+        int head_offset[HEAD] = {0, 0};
+        std::vector<uint8_t> waits;             // ID cycles each waits on operands
+        std::vector<HeadRead> head_reads;
+        std::vector<TailWrite> tail_writes;
+        uint64_t executions = 0;
+    };
+
+    Config config;
+    int redirect_penalty;       // Squashed slots per taken branch or jump
+
+    std::unordered_map<Address, Block> blocks;
+
+    // Block being retired
+    Block* block;
+    bool recording;
+    int pos;
+    Address expect_pc;
+    uint64_t block_extra;       // Cache miss cycles so far
+    std::array<int, MAX_BLOCK> fetch_stall;     // I-cache miss cycles per instruction
+    bool fetch_missed;
+
+    // Schedule: ID cycle of the last completed block, and the earliest ID
+    // cycle at which a consumer of each register may leave ID
+    uint64_t last_id;
+    uint64_t pending_redirect;
+    std::array<uint64_t, NUM_REGISTERS> use_ready;
+    std::array<uint64_t, NUM_REGISTERS> branch_ready;
+
+    // Statistics
+    uint64_t instructions;
+    uint64_t block_runs;
+    uint64_t abandoned;         // Blocks left before their end
+    uint64_t data_stalls;
+    uint64_t boundary_stalls;   // Part of data_stalls caused by the previous block
+    uint64_t control_stalls;
+    uint64_t icache_stalls;
+    uint64_t dcache_stalls;
+
+    void enter(Address pc);
+    void build(Block& b) const;
+    void complete(bool taken);
+};
+
+#endif // INTERVAL_MODEL_HPP
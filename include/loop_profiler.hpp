@@ -0,0 +1,81 @@
+/**
+ * loop_profiler.hpp
+ *
+ * Natural loops of the executed code with trip counts and per-iteration
+ * cost.
+ *
+ * The engines report control-flow edges only: taken branches and jumps
+ * (the Pipeline's redirects), never fall-through instructions. A taken
+ * branch or plain jump to an address at or before itself is a back edge;
+ * its target is the loop header and the loop body is the address range
+ * up to the furthest back edge seen for that header. Calls and returns
+ * are tracked as a depth so that loops in a called function do not end
+ * the caller's loop.
+ *
+ * A loop instance starts at its first back edge and ends at the first
+ * edge at the same depth that leaves or bypasses the body (including the
+ * next back edge of an enclosing loop). Trip counts are header executions
+ * per entry, so loops left before their first back edge are not seen.
+ * Iterations are measured from one back edge to the next, with the engine
+ * counters sampled at the edge.
+ */
+
+#ifndef LOOP_PROFILER_HPP
+#define LOOP_PROFILER_HPP
+
+#include "common.hpp"
+#include <unordered_map>
+
+class LoopProfiler {
+public:
+    // Engine totals at an edge; the functional CPU has no stall counts
+    struct Counters {
+        uint64_t instructions = 0;
+        uint64_t cycles = 0;
+        uint64_t data_stalls = 0;
+        uint64_t control_stalls = 0;    // Squashed slots
+        uint64_t icache_stalls = 0;
+        uint64_t dcache_stalls = 0;
+    };
+
+    LoopProfiler();
+
+    void reset();
+
+    // Taken control transfer by ins to target
+    void edge(const Instruction& ins, Address target, const Counters& now);
+
+    // Cycle columns are shown when the feeding engine models stalls
+    void set_timed(bool has_cycles);
+
+    void print_report(const std::map<std::string, Address>& symbols) const;
+
+private:
+    struct Loop {
+        Address header = 0;
+        Address latch = 0;          // Furthest back-edge source
+        uint64_t entries = 0;
+        uint64_t closed = 0;        // Entries whose trip count is final
+        uint64_t trips = 0;         // Header executions over closed entries
+        uint64_t max_trip = 0;
+        uint64_t iterations = 0;    // Back edge to back edge
+        Counters cost;              // Summed over those iterations
+    };
+
+    struct Active {
+        Loop* loop;
+        int depth;
+        uint64_t trip;              // Header executions so far
+        Counters last;              // At the latest back edge
+    };
+
+    std::unordered_map<Address, Loop> loops;
+    std::vector<Active> active;     // Innermost last
+    int depth;
+    bool timed;
+
+    static bool contains(const Loop& loop, Address pc);
+    void close(const Active& a);
+};
+
+#endif // LOOP_PROFILER_HPP
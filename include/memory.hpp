@@ -9,6 +9,7 @@
 #define MEMORY_HPP
 
 #include "common.hpp"
+#include "stats.hpp"
 
 class Memory {
 public:
@@ -40,6 +41,9 @@ public:
     void write_block(Address addr, const std::vector<Word>& words);
     void write_bytes(Address addr, const std::vector<Byte>& bytes);
 
+    // Read without touching the access counters (debugger/predicates)
+    Word peek_word(Address addr) const;
+
     // Display
     void dump(Address start, size_t bytes = 64) const;
     void dump_words(Address start, size_t count = 8) const;
@@ -48,6 +52,7 @@ public:
     size_t bytes_used() const;
     uint64_t get_read_count() const;
     uint64_t get_write_count() const;
+    void register_stats(StatsRegistry& stats, const std::string& prefix) const;
 
 private:
     std::map<Address, Byte> mem;
@@ -0,0 +1,91 @@
+/**
+ * memory_hierarchy.hpp
+ *
+ * L1 instruction and data caches over a unified L2 and DRAM.
+ * Used for timing only by the pipeline and the trace-driven models;
+ * functional data always lives in Memory.
+ *
+ * Configuration file: one 'level.key = value' per line, '#' comments.
+ *   l1i.size / l1i.line / l1i.assoc / l1i.latency   (same for l1d, l2)
+ *   l1i.prefetcher = none|nextline|stride|stream        (same for l1d)
+ *   l1i.pf_degree / l1i.pf_distance                     (same for l1d)
+ *   dram.banks / dram.row / dram.trcd / dram.tcl / dram.trp / dram.bus
+ */
+
+#ifndef MEMORY_HIERARCHY_HPP
+#define MEMORY_HIERARCHY_HPP
+
+#include "common.hpp"
+#include "cache.hpp"
+#include "dram.hpp"
+
+class MissProfiler;
+
+class MemoryHierarchy {
+public:
+    MemoryHierarchy();
+
+    // Off by default: every access then takes a single cycle
+    void set_enabled(bool on);
+    bool is_enabled() const { return enabled; }
+
+    // Load 'level.key = value' settings; error describes the first problem
+    bool load_config(const std::string& filename, std::string& error);
+
+    // Same enable flag, geometry, latencies and prefetchers as other, with
+    // cold caches and no miss profiler
+    void copy_config(const MemoryHierarchy& other);
+
+    // Prefetcher on an L1 cache ("l1i" or "l1d"); false for an unknown level
+    bool set_prefetcher(const std::string& level, const Prefetcher::Config& config);
+
+    // Latency in cycles of an instruction fetch, load or store. pc is the
+    // instruction making the access (trains PC-indexed prefetchers).
+    int fetch(Address addr, uint64_t now) {
+        return enabled ? l1i.demand_access(addr, false, now, addr) : 1;
+    }
+    int load(Address addr, uint64_t now, Address pc = 0) {
+        if (!enabled) return 1;
+        return profiler ? profiled(addr, false, now, pc, true)
+                        : l1d.demand_access(addr, false, now, pc);
+    }
+    int store(Address addr, uint64_t now, Address pc = 0) {
+        if (!enabled) return 1;
+        return profiler ? profiled(addr, true, now, pc, true)
+                        : l1d.demand_access(addr, true, now, pc);
+    }
+
+    // Store buffer write-back of the store at pc; nothing waits for it
+    int drain(Address addr, uint64_t now, Address pc) {
+        if (!enabled) return 1;
+        return profiler ? profiled(addr, true, now, pc, false)
+                        : l1d.demand_access(addr, true, now, pc);
+    }
+
+    // Report every L1 data access to a miss profiler (nullptr: none).
+    // reset() clears its counts along with the caches'.
+    void set_miss_profiler(MissProfiler* p) { profiler = p; }
+
+    // Hit latency of the L1 data cache (best case for a load)
+    int get_l1d_latency() const { return enabled ? l1d.get_config().latency : 1; }
+
+    void reset();
+    void print_config() const;
+    void print_stats() const;
+
+    // Register every level under prefix.l1i, .l1d, .l2 and .dram. The
+    // prefetch counters follow the prefetchers attached at the time.
+    void register_stats(StatsRegistry& stats, const std::string& prefix) const;
+
+private:
+    bool enabled;
+    Dram dram;
+    Cache l2;
+    Cache l1i;
+    Cache l1d;
+    MissProfiler* profiler;
+
+    int profiled(Address addr, bool write, uint64_t now, Address pc, bool waits);
+};
+
+#endif // MEMORY_HIERARCHY_HPP
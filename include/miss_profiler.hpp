@@ -0,0 +1,77 @@
+/**
+ * miss_profiler.hpp
+ *
+ * Delinquent loads: L1 data cache misses attributed to the load or store
+ * that made them and to the data object they touched.
+ *
+ * The memory hierarchy reports every demand data access (and every store
+ * buffer write-back) with the instruction's pc, the address and the
+ * latency. Instructions are counted in a flat array with one slot per
+ * text word. Data objects are the symbols of the data segment, each
+ * running up to the next symbol or the end of the segment; their start
+ * addresses are kept sorted for a binary search. Addresses outside the
+ * data segment fall into two catch-all objects: the stack (nearer to
+ * STACK_TOP than to the data segment) and everything else.
+ *
+ * Stall cycles are the latency beyond the L1 hit. The Pipeline waits for
+ * all of it; the trace-driven timing models may hide some of it, and
+ * store buffer write-backs never stall.
+ */
+
+#ifndef MISS_PROFILER_HPP
+#define MISS_PROFILER_HPP
+
+#include "common.hpp"
+#include "assembler.hpp"
+
+class MissProfiler {
+public:
+    struct Counts {
+        uint64_t accesses = 0;
+        uint64_t misses = 0;        // L1 data cache
+        uint64_t dram = 0;          // Misses served by DRAM
+        uint64_t stall_cycles = 0;
+    };
+
+    enum class Order { MISSES, STALLS };
+
+    MissProfiler();
+
+    // Size the tables to a program; counts start from zero
+    void configure(const Assembler::Result& program);
+    void reset();
+
+    // One data access by the instruction at pc
+    void record(Address pc, Address addr, bool miss, bool dram, int stall_cycles);
+
+    // Top instructions and data objects, heaviest first
+    void print_report(size_t top, Order order) const;
+
+private:
+    struct Object {
+        std::string name;
+        Address start;
+        Address end;
+        Counts counts;
+    };
+
+    Address text_addr;
+    std::vector<Word> text;             // For disassembly in the report
+    std::vector<Counts> by_pc;          // One slot per text word
+    Counts other_pc;                    // pc outside the text segment
+
+    std::vector<Object> objects;        // Data symbols, then stack and other
+    std::vector<Address> starts;        // Data symbol starts, ascending
+    Address data_end;
+    Address stack_floor;
+
+    // Text labels by address, for locating instructions
+    std::vector<std::pair<Address, std::string>> labels;
+
+    Counts total;
+
+    size_t object_of(Address addr) const;
+    std::string location(Address pc) const;
+};
+
+#endif // MISS_PROFILER_HPP
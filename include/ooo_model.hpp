@@ -0,0 +1,142 @@
+/**
+ * ooo_model.hpp
+ *
+ * Trace-driven timing model of an out-of-order core.
+ * Instructions are fetched and dispatched in order into a reorder buffer,
+ * renamed onto physical registers, issue from an issue queue when their
+ * operands are ready and a functional unit is free, and commit in order.
+ *
+ * Every structure is bounded and O(1) or O(log n) per instruction:
+ * ring buffers for the ROB, load/store queues and free list, a heap of
+ * issue times for the issue queue, and a per-cycle busy bitmap calendar
+ * for the functional units.
+ *
+ * Dispatch never moves back and nothing issues before the dispatch cycle,
+ * so calendar slots and store-to-load dependences at or before it are
+ * dead. The calendar doubles when a live slot would be reused; dead store
+ * entries are dropped whenever their table has doubled since the last pass.
+ */
+
+#ifndef OOO_MODEL_HPP
+#define OOO_MODEL_HPP
+
+#include "common.hpp"
+#include "timing_model.hpp"
+#include <queue>
+#include <unordered_map>
+
+class OoOModel : public TimingModel {
+public:
+    static constexpr int MAX_WIDTH = 8;
+    static constexpr int MAX_UNITS = 8;     // Per functional unit class
+
+    struct Config {
+        int width = 4;              // Fetch/dispatch/issue/commit width
+        int rob_size = 128;
+        int iq_size = 48;
+        int phys_regs = 128;        // Integer physical registers (> 32)
+        int lq_size = 32;
+        int sq_size = 24;
+        int alu_units = 3;
+        int branch_units = 1;
+        int mul_units = 1;          // MUL pipelined, DIV/REM unpipelined
+        int mem_units = 2;          // Load/store ports
+        int frontend_depth = 3;     // Fetch to dispatch (decode, rename)
+    };
+
+    OoOModel();
+    explicit OoOModel(const Config& cfg);
+
+    void set_config(const Config& cfg);
+    const Config& get_config() const;
+
+    // TimingModel
+    const char* name() const override;
+    void reset() override;
+    void retire(const RetiredInsn& r) override;
+    uint64_t get_cycle_count() const override;
+    uint64_t get_instruction_count() const override;
+    void print_config() const override;
+    void print_stats() const override;
+    void register_stats(StatsRegistry& stats, const std::string& prefix) const override;
+
+private:
+    enum FuClass { FU_ALU, FU_BRANCH, FU_MUL, FU_MEM, FU_COUNT };
+
+    static constexpr int LOAD_LATENCY = 3;      // Address generation + L1 hit
+    static constexpr int MUL_LATENCY = 3;
+    static constexpr int DIV_LATENCY = 20;
+    static constexpr int RAS_SIZE = 8;
+
+    // Functional unit calendar: one slot per cycle, tagged with its cycle
+    static constexpr size_t CALENDAR_SIZE = 8192;       // Initial slots
+    static constexpr size_t STORE_PRUNE_MIN = 1024;
+    struct CalendarSlot {
+        uint64_t cycle = 0;
+        uint8_t issued = 0;
+        uint8_t busy[FU_COUNT] = {};    // Bit i set = unit i busy
+    };
+
+    Config config;
+    int units[FU_COUNT];
+
+    // Front end
+    uint64_t fetch_cycle;
+    int fetch_count;
+    uint64_t fetch_ready;               // Earliest fetch after a mispredict
+    std::array<Address, RAS_SIZE> ras;
+    int ras_top;
+
+    // Dispatch (in order)
+    uint64_t dispatch_cycle;
+    int dispatch_count;
+
+    // Reorder buffer and load/store queues: commit cycle of each entry
+    std::vector<uint64_t> rob;
+    std::vector<uint64_t> lq;
+    std::vector<uint64_t> sq;
+    uint64_t loads;
+    uint64_t stores;
+
+    // Issue queue: issue cycles of entries still waiting
+    std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t>> iq;
+
+    // Renaming
+    std::array<int, NUM_REGISTERS> rat;
+    std::vector<uint64_t> preg_ready;   // Cycle a result can be consumed
+    std::vector<int> free_list;         // Ring of free physical registers
+    std::vector<uint64_t> free_at;      // Cycle each free-list entry is released
+    size_t free_head;
+
+    // Memory dependences: word address -> cycle the last store's data is ready
+    std::unordered_map<Address, uint64_t> store_ready;
+    size_t store_prune_at;              // Size that triggers the next pruning
+
+    std::vector<CalendarSlot> calendar;
+
+    // Commit (in order)
+    uint64_t commit_cycle;
+    int commit_count;
+
+    // Statistics
+    uint64_t instructions;
+    uint64_t branches;
+    uint64_t mispredicts;
+    uint64_t stall_rob;
+    uint64_t stall_iq;
+    uint64_t stall_regs;
+    uint64_t stall_lsq;
+    uint64_t rob_occupancy;             // Sum of dispatch->commit cycles
+    uint64_t iq_occupancy;              // Sum of dispatch->issue cycles
+    uint64_t fu_busy[FU_COUNT];
+
+    static FuClass fu_class(const Instruction& ins);
+    static int latency(const Instruction& ins);
+    bool predict(const RetiredInsn& r);
+    uint64_t schedule(FuClass fu, uint64_t earliest, int occupancy);
+    CalendarSlot& slot(uint64_t cycle);
+    void grow_calendar();
+    void prune_store_ready();
+};
+
+#endif // OOO_MODEL_HPP
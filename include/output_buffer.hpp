@@ -0,0 +1,46 @@
+/**
+ * output_buffer.hpp
+ *
+ * Reusable character buffer for bulk REPL output.
+ * Text is formatted straight into the buffer and written to the
+ * destination stream in large chunks instead of one line at a time.
+ */
+
+#ifndef OUTPUT_BUFFER_HPP
+#define OUTPUT_BUFFER_HPP
+
+#include "common.hpp"
+
+class OutputBuffer {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 64 * 1024;
+
+    explicit OutputBuffer(std::ostream& out = std::cout, size_t capacity = DEFAULT_CAPACITY);
+    ~OutputBuffer();
+
+    // Redirect output (flushes pending data to the old stream first)
+    void set_stream(std::ostream& out);
+
+    // Append text
+    void put(char c);
+    void put(const char* s);
+    void put(const std::string& s);
+
+    // Append numbers
+    void put_hex(Word value, int width = 8);    // "0x" prefixed, zero padded
+    void put_dec(uint64_t value);
+    void put_signed(int64_t value);
+
+    // Write buffered data to the stream
+    void flush();
+
+private:
+    std::ostream* out;
+    std::vector<char> buf;
+    size_t len;
+
+    // Make room for n more bytes
+    void reserve(size_t n);
+};
+
+#endif // OUTPUT_BUFFER_HPP
@@ -15,31 +15,55 @@
 #include "alu.hpp"
 #include "decoder.hpp"
 #include "hazard_unit.hpp"
+#include "output_buffer.hpp"
+#include "predicate.hpp"
+#include "watchdog.hpp"
+#include "store_buffer.hpp"
+#include "memory_hierarchy.hpp"
+#include "loop_profiler.hpp"
 
 class Pipeline {
 public:
     Pipeline(Memory& mem, RegisterFile& regs);
     void reset();
 
-    // Execute one cycle
-    bool cycle();
+    // Execute one cycle, returns NONE or why execution stopped
+    StopReason cycle();
 
-    // Run until halt or breakpoint
-    void run();
+    // Execute up to max_cycles cycles. Returns NONE if all ran,
+    // otherwise the reason for stopping (halt, breakpoint, limit, Ctrl-C...)
+    StopReason run(uint64_t max_cycles = std::numeric_limits<uint64_t>::max());
+
+    // Same, also stopping (CONDITION) once the predicate holds
+    StopReason run_until(Predicate& pred);
+    Predicate::State predicate_state() const;
 
     // Control toggles
     void set_hazard_detection(bool enabled);
     void set_forwarding(bool enabled);
+    void set_branch_stage(BranchStage stage);
     bool get_hazard_detection() const;
     bool get_forwarding() const;
+    BranchStage get_branch_stage() const;
+
+    // Store buffer (depth 0 = stores write through with no buffering)
+    StoreBuffer& get_store_buffer();
+
+    // Cache hierarchy for fetch and data access timing (nullptr = none)
+    void set_memory_hierarchy(MemoryHierarchy* hierarchy);
+
+    // Loop profiler fed with every redirect (nullptr = none)
+    void set_loop_profiler(LoopProfiler* profiler);
 
     // State access
     Address get_pc() const;
     void set_pc(Address addr);
     uint64_t get_cycle_count() const;
     uint64_t get_instruction_count() const;
+    void register_stats(StatsRegistry& stats, const std::string& prefix) const;
     bool is_halted() const;
     bool is_stalled() const;
+    Word get_exit_code() const;
 
     // Pipeline register access (for display)
     const IF_ID& get_if_id() const;
@@ -49,6 +73,14 @@ public:
 
     // Display pipeline state
     void print_state() const;
+    void print_state(OutputBuffer& out) const;
+
+    // Run limits (0 = unlimited), applied per run
+    void set_limits(const RunLimits& run_limits);
+    const RunLimits& get_limits() const;
+
+    // Call sample every period instructions (or cycles) during runs (0 = off)
+    void set_sampling(uint64_t period, bool by_cycles, std::function<void()> sample);
 
     // Breakpoints
     void add_breakpoint(Address addr);
@@ -56,10 +88,31 @@ public:
     void clear_breakpoints();
     bool has_breakpoint(Address addr) const;
 
+    // Watchpoints (stop after a store touches the word)
+    void add_watchpoint(Address addr);
+    void clear_watchpoints();
+
+    // Region of interest: stop when fetch reaches end
+    void set_roi_end(Address addr);
+    void clear_roi_end();
+
+    // Stop once per run from reset when fetch reaches start
+    void set_roi_start(Address addr);
+    void clear_roi_start();
+
     // Statistics
     uint64_t get_stall_count() const;
+    uint64_t get_branch_stall_count() const;
     uint64_t get_flush_count() const;
     uint64_t get_forward_count() const;
+    uint64_t get_phantom_forward_count() const;
+    uint64_t get_stalls_avoided() const;
+    uint64_t get_sb_forward_count() const;
+    uint64_t get_sb_full_stall_count() const;
+    uint64_t get_sb_conflict_stall_count() const;
+    uint64_t get_icache_stall_count() const;
+    uint64_t get_dcache_stall_count() const;
+    uint64_t get_skipped_cycle_count() const;
 
 private:
     Memory& mem;
@@ -78,18 +131,70 @@ private:
     // Control
     bool hazard_detection;
     bool forwarding;
+    BranchStage branch_stage;
+    bool redirecting;       // Fetch squashed this cycle by a taken branch
     bool halted;
     bool stalled;
+    bool phantom_load_use;  // Load rd matched only immediate bits of the next instruction
+    StopReason halt_reason;
+    Word exit_code;
+
+    // Stop events raised by stages during a cycle
+    bool trap_hit;
+    bool illegal_hit;
+    bool watch_hit;
+
+    // Architectural writes made this cycle (for predicate tracking and
+    // MEM/WB forwarding, since WB runs before the other stages)
+    int wb_rd;
+    Word wb_value;
+    bool mem_stored;
+    Address mem_store_addr;
 
     // Statistics
     uint64_t cycles;
     uint64_t instructions;
+    std::array<uint64_t, NUM_INS_TYPES> type_counts;    // Retired per InsType
+    uint64_t redirects;         // Taken branches and jumps (all mispredicted)
     uint64_t stalls;
+    uint64_t branch_stalls;
     uint64_t flushes;
     uint64_t forwards;
+    uint64_t phantom_forwards;  // Field matches on operands never read
+    uint64_t stalls_avoided;    // Load-use stalls a field-only compare would add
+    uint64_t sb_forwards;
+    uint64_t sb_full_stalls;
+    uint64_t sb_conflict_stalls;
 
-    // Breakpoints
+    uint64_t icache_stalls;
+    uint64_t dcache_stalls;
+    uint64_t skipped_cycles;    // Stall cycles jumped over by run()
+
+    StoreBuffer store_buffer;
+
+    // Cache timing: cycles left on the outstanding fetch / data access
+    MemoryHierarchy* caches;
+    bool fetch_started;
+    int fetch_wait;
+    bool dmem_started;
+    int dmem_wait;
+
+    LoopProfiler* loops;
+
+    // Breakpoints, watchpoints, region of interest
     std::vector<Address> breakpoints;
+    bool break_reported;    // Already stopped at break_pc; fetch stalls keep pc there
+    Address break_pc;
+    std::vector<Address> watchpoints;
+    bool roi_enabled;
+    Address roi_end;
+    bool roi_start_enabled;
+    bool roi_start_armed;
+    Address roi_start;
+
+    // Limits
+    RunLimits limits;
+    Watchdog watchdog;
 
     // Stage implementations
     void stage_if();
@@ -101,6 +206,23 @@ private:
     // Hazard detection
     bool detect_load_use_hazard();
     bool detect_control_hazard();
+    bool detect_branch_hazard();
+    bool detect_store_buffer_stall();
+    bool load_waits_for_store() const;
+    bool load_uses_dport() const;
+    bool detect_dcache_stall();
+
+    // Event-driven skipping: cycles until the next event (cache fill done,
+    // store buffer drain) while nothing but stall counters would change
+    uint64_t quiet_cycles() const;
+    void skip_cycles(uint64_t n);
+
+    // Breakpoint at pc not yet reported for this arrival
+    bool breakpoint_pending() const;
+
+    // Redirect fetch to a taken branch target, squashing younger stages
+    void redirect(const Instruction& ins, Address target);
+    bool resolve_in_id(const Instruction& ins, Address& target);
 
     // Forwarding
     Forward get_forward_a();
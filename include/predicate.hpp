@@ -0,0 +1,133 @@
+/**
+ * predicate.hpp
+ *
+ * Run-until predicates.
+ * An expression over registers, memory words, PC and counters is compiled
+ * once into a small stack bytecode. The engines evaluate it after each
+ * instruction, but only when something it reads may have changed.
+ *
+ * Grammar (C-like precedence):
+ *   expr    := or
+ *   or      := and ('||' and)*
+ *   and     := cmp ('&&' cmp)*
+ *   cmp     := bitor (('=='|'!='|'<'|'<='|'>'|'>=') bitor)?
+ *   bitor   := bitxor ('|' bitxor)*      bitxor := bitand ('^' bitand)*
+ *   bitand  := shift ('&' shift)*        shift  := sum (('<<'|'>>') sum)*
+ *   sum     := term (('+'|'-') term)*    term   := unary (('*'|'/'|'%') unary)*
+ *   unary   := ('-'|'!'|'~') unary | primary
+ *   primary := number | symbol | register | 'reg' register
+ *            | 'pc' | 'cycles' | 'instructions'
+ *            | 'mem' '[' expr ']' | '[' expr ']' | '(' expr ')'
+ *
+ * Registers and memory words are signed 32-bit values.
+ */
+
+#ifndef PREDICATE_HPP
+#define PREDICATE_HPP
+
+#include "common.hpp"
+#include "memory.hpp"
+#include "register_file.hpp"
+
+class Predicate {
+public:
+    // Machine state an expression can read
+    struct State {
+        Address pc;
+        uint64_t cycles;
+        uint64_t instructions;
+        const RegisterFile& regs;
+        const Memory& mem;
+    };
+
+    // Compile an expression. Parsing stops at the first token that cannot
+    // continue the expression; the number of characters consumed is
+    // returned in 'used'. Returns false and sets 'error' on failure.
+    bool compile(const std::string& text, const std::map<std::string, Address>& symbols,
+                 size_t& used, std::string& error);
+
+    // Evaluate against the current state (always re-runs the bytecode)
+    int64_t eval(const State& state) const;
+
+    // Test with dependency tracking: the cached result is reused
+    // unless observe() saw a change to something the expression reads
+    bool test(const State& state);
+
+    // Report what the last instruction/cycle wrote (rd = 0 for none)
+    void observe(int rd, bool stored, Address store_addr) {
+        if (always_dirty
+            || ((reg_mask >> rd) & 1)
+            || (stored && reads_mem && (mem_dynamic || watches(store_addr)))) {
+            dirty = true;
+        }
+    }
+
+    // Force re-evaluation on the next test()
+    void invalidate() { dirty = true; }
+
+    const std::string& source() const { return text; }
+    size_t size() const { return code.size(); }
+
+private:
+    enum class Op : uint8_t {
+        CONST, REG, MEM, PC, CYCLES, INSTRUCTIONS,
+        NEG, NOT, BNOT,
+        ADD, SUB, MUL, DIV, REM, AND, OR, XOR, SHL, SHR,
+        EQ, NE, LT, LE, GT, GE, LAND, LOR
+    };
+
+    struct Insn {
+        Op op;
+        int64_t arg;
+    };
+
+    static constexpr int MAX_STACK = 32;
+
+    std::vector<Insn> code;
+    std::string text;
+
+    // Dependencies
+    uint32_t reg_mask = 0;              // Registers read (bit 0 never set)
+    bool always_dirty = false;          // Reads pc or counters
+    bool reads_mem = false;
+    bool mem_dynamic = false;           // Some address is computed at run time
+    std::vector<Address> mem_addrs;     // Constant word addresses read
+
+    // Cached result
+    bool dirty = true;
+    bool cached = false;
+
+    bool watches(Address store_addr) const;
+
+    // Parser state
+    const std::string* src = nullptr;
+    const std::map<std::string, Address>* syms = nullptr;
+    size_t pos = 0;
+    std::string err;
+
+    void skip_space();
+    bool peek(const char* tok);
+    bool accept(const char* tok);
+    std::string ident();
+
+    bool parse_or();
+    bool parse_and();
+    bool parse_cmp();
+    bool parse_bitor();
+    bool parse_bitxor();
+    bool parse_bitand();
+    bool parse_shift();
+    bool parse_sum();
+    bool parse_term();
+    bool parse_unary();
+    bool parse_primary();
+
+    // Emit with constant folding
+    void emit(Op op, int64_t arg = 0);
+    void emit_unary(Op op);
+    void emit_binary(Op op);
+
+    static int64_t apply(Op op, int64_t a, int64_t b);
+};
+
+#endif // PREDICATE_HPP
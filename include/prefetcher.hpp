@@ -0,0 +1,101 @@
+/**
+ * prefetcher.hpp
+ *
+ * Hardware prefetcher models attached to a cache.
+ * The cache reports each demand access; the prefetcher returns line
+ * addresses to bring in. Degree is the number of lines per trigger,
+ * distance how far ahead (in lines or strides) the first one is.
+ */
+
+#ifndef PREFETCHER_HPP
+#define PREFETCHER_HPP
+
+#include "common.hpp"
+#include <memory>
+
+class Prefetcher {
+public:
+    enum class Type { NONE, NEXT_LINE, STRIDE, STREAM };
+
+    struct Config {
+        Type type = Type::NONE;
+        int degree = 1;
+        int distance = 1;
+    };
+
+    virtual ~Prefetcher() = default;
+
+    // Demand access at addr by the instruction at pc. 'trigger' is set for
+    // a miss or the first hit on a prefetched line. Appends addresses to fetch.
+    virtual void observe(Address pc, Address addr, bool trigger,
+                         std::vector<Address>& prefetches) = 0;
+    virtual void reset() = 0;
+
+    static std::unique_ptr<Prefetcher> create(const Config& config, uint32_t line_size);
+    static const char* type_name(Type type);
+    static bool parse_type(const std::string& name, Type& type);
+};
+
+// Prefetch the lines following a missing line
+class NextLinePrefetcher : public Prefetcher {
+public:
+    NextLinePrefetcher(int degree, int distance, uint32_t line_size);
+    void observe(Address pc, Address addr, bool trigger, std::vector<Address>& prefetches) override;
+    void reset() override;
+
+private:
+    int degree;
+    int distance;
+    uint32_t line_size;
+};
+
+// Per-PC stride detection with 2-bit confidence
+class StridePrefetcher : public Prefetcher {
+public:
+    StridePrefetcher(int degree, int distance);
+    void observe(Address pc, Address addr, bool trigger, std::vector<Address>& prefetches) override;
+    void reset() override;
+
+private:
+    static constexpr int TABLE_SIZE = 64;
+
+    struct Entry {
+        Address pc = 0;
+        Address last_addr = 0;
+        int32_t stride = 0;
+        int confidence = 0;
+        bool valid = false;
+    };
+
+    int degree;
+    int distance;
+    std::array<Entry, TABLE_SIZE> table;
+};
+
+// Ascending/descending miss streams, tracked per region of nearby lines
+class StreamPrefetcher : public Prefetcher {
+public:
+    StreamPrefetcher(int degree, int distance, uint32_t line_size);
+    void observe(Address pc, Address addr, bool trigger, std::vector<Address>& prefetches) override;
+    void reset() override;
+
+private:
+    static constexpr int NUM_STREAMS = 16;
+    static constexpr int WINDOW = 4;        // Lines a stream may skip
+
+    struct Stream {
+        int64_t last_line = 0;
+        int direction = 0;
+        int confidence = 0;
+        uint64_t last_use = 0;
+        bool valid = false;
+    };
+
+    int degree;
+    int distance;
+    uint32_t line_size;
+    std::array<Stream, NUM_STREAMS> streams;
+    uint64_t clock;
+};
+
+#endif // PREFETCHER_HPP
@@ -3,6 +3,11 @@
  * 
  * 32 general-purpose registers (x0-x31).
  * x0 is hardwired to zero.
+ *
+ * read()/write() check the index and are meant for the REPL and other
+ * external callers. The engines use read_fast()/write_fast(), which take
+ * the 5-bit register field as is: writes to x0 go to a sink slot past
+ * x31 that is never read, so x0 stays zero without a branch.
  */
 
 #ifndef REGISTER_FILE_HPP
@@ -21,15 +26,24 @@ public:
     // Write register value (writes to x0 are ignored)
     void write(int reg, Word value);
 
+    // Unchecked engine access by 5-bit register field
+    Word read_fast(unsigned reg) const { return regs[reg & 31]; }
+    void write_fast(unsigned reg, Word value) {
+        reg &= 31;
+        regs[reg | (static_cast<unsigned>(reg == 0) << 5)] = value;
+    }
+
     // Display
     void dump() const;
     void dump_reg(int reg) const;
 
-    // Direct access for debugging
-    const std::array<Word, NUM_REGISTERS>& get_all() const;
+    // Copy of x0-x31 for debugging
+    std::array<Word, NUM_REGISTERS> get_all() const;
 
 private:
-    std::array<Word, NUM_REGISTERS> regs;
+    static constexpr int SINK = NUM_REGISTERS;     // Target of writes to x0
+
+    std::array<Word, NUM_REGISTERS + 1> regs;
 };
 
 #endif // REGISTER_FILE_HPP
@@ -0,0 +1,82 @@
+/**
+ * sampler.hpp
+ *
+ * Periodic statistics snapshots for phase analysis.
+ *
+ * The engines' watchdogs call sample() every N instructions or cycles,
+ * using the countdown they already keep for run limits. Each call reads
+ * a fixed set of registry counters, subtracts the values from the previous
+ * boundary and writes one CSV row for the interval: IPC, stall and flush
+ * rates, branch misprediction and cache miss rates, and instruction mix.
+ * Nothing is recorded between boundaries.
+ */
+
+#ifndef SAMPLER_HPP
+#define SAMPLER_HPP
+
+#include "common.hpp"
+#include "stats.hpp"
+
+class Sampler {
+public:
+    enum class Unit { INSTRUCTIONS, CYCLES };
+
+    struct Config {
+        uint64_t period = 100000;
+        Unit unit = Unit::INSTRUCTIONS;
+    };
+
+    Sampler(const StatsRegistry& stats, const Config& cfg);
+
+    const Config& get_config() const;
+
+    // Rows go to filename, or to stdout when it is empty
+    bool open(const std::string& filename, std::string& error);
+    const std::string& get_filename() const;
+
+    // Choose the columns for an engine ("cpu" or "pipeline"), taking cycles
+    // from a timing model prefix when not empty, and write the header
+    void start(const std::string& engine, const std::string& timing, bool caches);
+
+    // The engine's counters went back to zero (load, reset)
+    void restart();
+
+    // One row for the interval since the last boundary
+    void sample();
+
+    // Row for a partial last interval, then flush
+    void finish();
+
+    uint64_t get_rows() const;
+
+private:
+    // Delta of the num counters, divided by the delta of the den counters
+    // when there are any
+    struct Column {
+        std::string name;
+        std::vector<int> num;
+        std::vector<int> den;
+    };
+
+    const StatsRegistry& stats;
+    Config config;
+
+    std::string filename;
+    std::ofstream file;
+    std::ostream* out;
+
+    std::vector<std::string> counters;      // Registry names read per sample
+    std::vector<uint64_t> prev;             // Values at the last boundary
+    std::vector<uint64_t> now;
+    std::vector<Column> columns;
+    int insns;                              // Counter indices of the totals
+    int cycles;
+    uint64_t rows;
+
+    int counter(const std::string& name);
+    void add_rate(const std::string& name, const std::vector<std::string>& num,
+                  const std::vector<std::string>& den);
+    void read(std::vector<uint64_t>& values) const;
+};
+
+#endif // SAMPLER_HPP
@@ -0,0 +1,82 @@
+/**
+ * smp.hpp
+ *
+ * Multi-hart execution over one shared Memory.
+ * Each hart is a single-cycle CPU with its own register file. Harts are
+ * interleaved one instruction at a time, always advancing the hart with
+ * the lowest cycle count, so a hart stalled on coherence traffic falls
+ * behind the others. Loads and stores go through the coherence model.
+ *
+ * At start every hart has its id in a0 and tp and its own stack.
+ */
+
+#ifndef SMP_HPP
+#define SMP_HPP
+
+#include "common.hpp"
+#include "memory.hpp"
+#include "register_file.hpp"
+#include "cpu.hpp"
+#include "timing_model.hpp"
+#include "coherence.hpp"
+#include <memory>
+
+class Smp {
+public:
+    static constexpr Address STACK_SIZE = 0x10000;     // Per hart
+
+    explicit Smp(Memory& mem);
+
+    void set_config(const CoherenceModel::Config& cfg);
+    const CoherenceModel& get_coherence() const;
+
+    // Reset coherence state and start every hart at entry
+    void start(Address entry);
+
+    // Run until every hart halts, a hart traps or a limit is reached
+    StopReason run(const RunLimits& limits);
+
+    // Hart that stopped the run (trap), or -1
+    int get_stop_hart() const;
+    Address get_pc(int hart) const;
+
+    void print_stats() const;
+
+private:
+    // Per-hart cycle accounting: one cycle per instruction plus the
+    // coherence latency beyond an L1 hit
+    class HartTiming : public TimingModel {
+    public:
+        HartTiming(CoherenceModel& coherence, int hart);
+        const char* name() const override;
+        void reset() override;
+        void retire(const RetiredInsn& r) override;
+        uint64_t get_cycle_count() const override;
+        uint64_t get_instruction_count() const override;
+        void print_config() const override;
+        void print_stats() const override;
+
+    private:
+        CoherenceModel& coherence;
+        int hart;
+        uint64_t cycles;
+        uint64_t instructions;
+        uint64_t stall_cycles;
+    };
+
+    struct Hart {
+        RegisterFile regs;
+        CPU cpu;
+        HartTiming timing;
+        bool done;
+        Hart(Memory& mem, CoherenceModel& coherence, int id);
+    };
+
+    Memory& mem;
+    CoherenceModel coherence;
+    std::vector<std::unique_ptr<Hart>> harts;
+    int stop_hart;
+    Watchdog watchdog;
+};
+
+#endif // SMP_HPP
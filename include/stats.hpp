@@ -0,0 +1,88 @@
+/**
+ * stats.hpp
+ *
+ * Registry of named statistics for structured dumps.
+ *
+ * Components keep their counters as plain uint64_t members, so counting
+ * stays an ordinary add in the engine loops (each engine object is only
+ * ever driven by one thread), and register pointers to them under dotted
+ * hierarchical names such as "pipeline.stalls" or "caches.l1d.misses".
+ * Histograms are arrays of such counters with bucket labels. Computed
+ * totals (a model's cycle count) are read through a function, and
+ * formulas (CPI, miss rates) are evaluated from other statistics when
+ * dumped.
+ *
+ * reset() leaves the components alone: it records the current values as
+ * a baseline and later reads report the change since, which is how the
+ * region of interest is measured without disturbing the models.
+ */
+
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include "common.hpp"
+#include <functional>
+
+class StatsRegistry {
+public:
+    enum class Format { TEXT, JSON, CSV };
+
+    using Reader = std::function<uint64_t()>;
+    using Formula = std::function<double(const StatsRegistry&)>;
+
+    // Registration; a name registered again replaces the old entry
+    void add_counter(const std::string& name, const uint64_t* counter, const std::string& desc);
+    void add_computed(const std::string& name, Reader read, const std::string& desc);
+    void add_histogram(const std::string& name, const uint64_t* buckets,
+                       const std::vector<std::string>& labels, const std::string& desc);
+    void add_formula(const std::string& name, Formula formula, const std::string& desc);
+
+    // Drop name and everything below it (components going away)
+    void remove(const std::string& prefix);
+
+    bool has(const std::string& name) const;
+
+    // Counter value since the last reset (0 for unknown names)
+    uint64_t value(const std::string& name) const;
+
+    // Counter value ignoring reset, for readers that keep their own baseline
+    uint64_t total(const std::string& name) const;
+
+    // value(num) / value(den), 0 when the denominator is 0
+    double ratio(const std::string& num, const std::string& den) const;
+
+    // Start counting from the current values
+    void reset();
+
+    // Write statistics at or below prefix ("" = all)
+    void dump(std::ostream& out, Format format, const std::string& prefix = "") const;
+
+    static bool parse_format(const std::string& text, Format& format);
+
+private:
+    enum class Kind { COUNTER, HISTOGRAM, FORMULA };
+
+    struct Entry {
+        Kind kind = Kind::COUNTER;
+        const uint64_t* data = nullptr;     // Counter or histogram buckets
+        Reader read;                        // Computed counter
+        std::vector<std::string> labels;    // Histogram buckets
+        std::vector<uint64_t> base;         // Values at the last reset
+        Formula formula;
+        std::string desc;
+    };
+
+    using EntryMap = std::map<std::string, Entry>;
+    EntryMap entries;                       // Sorted, so siblings are adjacent
+
+    static uint64_t raw(const Entry& e, size_t i);
+    static uint64_t since_reset(const Entry& e, size_t i);
+    static bool below(const std::string& name, const std::string& prefix);
+    std::vector<EntryMap::const_iterator> select(const std::string& prefix) const;
+
+    void dump_text(std::ostream& out, const std::string& prefix) const;
+    void dump_json(std::ostream& out, const std::string& prefix) const;
+    void dump_csv(std::ostream& out, const std::string& prefix) const;
+};
+
+#endif // STATS_HPP
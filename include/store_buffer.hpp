@@ -0,0 +1,91 @@
+/**
+ * store_buffer.hpp
+ *
+ * Store buffer between the MEM stage and data memory.
+ * Stores retire into the buffer and drain to memory in the background;
+ * loads that hit a buffered store get its data forwarded. Memory itself
+ * is updated when the store executes, so the buffer only tracks timing.
+ */
+
+#ifndef STORE_BUFFER_HPP
+#define STORE_BUFFER_HPP
+
+#include "common.hpp"
+#include "stats.hpp"
+
+class StoreBuffer {
+public:
+    static constexpr int MAX_DEPTH = 64;
+
+    enum class Policy {
+        EAGER,      // Drain whenever the write port is free
+        IDLE,       // Drain only in cycles without a load in MEM
+        LAZY        // Drain only when more than half full
+    };
+
+    enum class Match {
+        NONE,       // No buffered store overlaps the load
+        FORWARD,    // Youngest overlapping store covers the load
+        CONFLICT    // Partial overlap: load waits for the store to drain
+    };
+
+    // depth 0 disables the buffer
+    void configure(int depth, int drain_latency, Policy policy);
+    void reset();
+
+    bool enabled() const { return depth > 0; }
+    bool full() const { return count >= depth; }
+    int size() const { return count; }
+
+    void push(Address addr, int bytes, Address pc);
+    Match lookup(Address addr, int bytes) const;
+
+    // Once per cycle: true if the oldest store may drain now. A load that
+    // waits for a buffered store to drain overrides the policy.
+    bool tick(uint64_t cycle, bool load_in_mem, bool load_waiting);
+
+    // Cycles from 'cycle' on in which tick() would not drain, with the
+    // pipeline state unchanged; n such cycles are accounted by skip(n)
+    uint64_t quiet_cycles(uint64_t cycle, bool load_in_mem, bool load_waiting) const;
+    void skip(uint64_t n);
+
+    // Drain the oldest store; the write port stays busy for the drain
+    // interval or the memory write latency, whichever is longer
+    Address front() const { return entries[head].addr; }
+    Address front_pc() const { return entries[head].pc; }
+    void drain(uint64_t cycle, int write_latency);
+
+    int get_depth() const { return depth; }
+    int get_drain_latency() const { return drain_latency; }
+    Policy get_policy() const { return policy; }
+    uint64_t get_drained() const { return drained; }
+    double get_avg_occupancy() const;
+    void register_stats(StatsRegistry& stats, const std::string& prefix) const;
+
+    static const char* policy_name(Policy p);
+
+private:
+    struct Entry {
+        Address addr;
+        int bytes;
+        Address pc;         // Store that wrote it, for miss attribution
+    };
+
+    bool held(bool load_in_mem, bool load_waiting) const;
+
+    std::array<Entry, MAX_DEPTH> entries;
+    int head = 0;
+    int count = 0;
+
+    int depth = 0;
+    int drain_latency = 1;
+    Policy policy = Policy::EAGER;
+    uint64_t next_drain = 0;
+
+    // Statistics
+    uint64_t drained = 0;
+    uint64_t occupancy_sum = 0;
+    uint64_t ticks = 0;
+};
+
+#endif // STORE_BUFFER_HPP
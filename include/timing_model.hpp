@@ -0,0 +1,61 @@
+/**
+ * timing_model.hpp
+ *
+ * Interface for trace-driven timing models.
+ * The single-cycle CPU does the functional work and hands every retired
+ * instruction to an attached model, which only accounts for cycles.
+ */
+
+#ifndef TIMING_MODEL_HPP
+#define TIMING_MODEL_HPP
+
+#include "common.hpp"
+#include "memory_hierarchy.hpp"
+#include "stats.hpp"
+
+// One retired instruction, as seen by a timing model
+struct RetiredInsn {
+    const Instruction& ins;
+    Address mem_addr;       // Effective address (loads/stores)
+    Address next_pc;        // Actual next PC
+    bool taken;             // Control flow left the fall-through path
+};
+
+class TimingModel {
+public:
+    virtual ~TimingModel() = default;
+
+    virtual const char* name() const = 0;
+    virtual void reset() = 0;
+
+    // Account one retired instruction (in program order)
+    virtual void retire(const RetiredInsn& r) = 0;
+
+    // Totals, including instructions still in flight
+    virtual uint64_t get_cycle_count() const = 0;
+    virtual uint64_t get_instruction_count() const = 0;
+
+    // Display configuration and statistics
+    virtual void print_config() const = 0;
+    virtual void print_stats() const = 0;
+
+    // Register statistics under prefix; models extend the common totals
+    virtual void register_stats(StatsRegistry& stats, const std::string& prefix) const {
+        stats.add_computed(prefix + ".cycles", [this] { return get_cycle_count(); }, "Cycles");
+        stats.add_computed(prefix + ".instructions", [this] { return get_instruction_count(); },
+                           "Instructions");
+        stats.add_formula(prefix + ".cpi", [prefix](const StatsRegistry& s) {
+            return s.ratio(prefix + ".cycles", prefix + ".instructions");
+        }, "Cycles per instruction");
+    }
+
+    // Cache hierarchy for fetch and data latencies (nullptr = fixed latencies)
+    void set_memory_hierarchy(MemoryHierarchy* hierarchy) { memory = hierarchy; }
+
+protected:
+    MemoryHierarchy* memory = nullptr;
+
+    bool caches_enabled() const { return memory && memory->is_enabled(); }
+};
+
+#endif // TIMING_MODEL_HPP
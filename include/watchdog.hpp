@@ -0,0 +1,77 @@
+/**
+ * watchdog.hpp
+ *
+ * Instruction, cycle and wall-time limits for engine runs, plus Ctrl-C.
+ * The engines call tick() once per step; it only decrements a counter.
+ * The limits, the clock and the interrupt flag are looked at when the
+ * counter runs out, at most every CHECK_INTERVAL steps. Periodic statistics
+ * samples ride on the same counter, so they cost nothing per step either.
+ */
+
+#ifndef WATCHDOG_HPP
+#define WATCHDOG_HPP
+
+#include "common.hpp"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <functional>
+
+class Watchdog {
+public:
+    static constexpr uint64_t CHECK_INTERVAL = 4096;
+
+    // Begin a run with the given budgets, counted from the current totals
+    void start(const RunLimits& limits, uint64_t instructions, uint64_t cycles);
+
+    // Per-step check: NONE unless a limit ran out or Ctrl-C was pressed
+    StopReason tick(uint64_t instructions, uint64_t cycles) {
+        if (--budget != 0) return StopReason::NONE;
+        return check(instructions, cycles);
+    }
+
+    // Full check now, for callers whose steps are whole commands
+    StopReason poll(uint64_t instructions, uint64_t cycles) { return check(instructions, cycles); }
+
+    // Call sample whenever the instruction (or cycle) total reaches a
+    // multiple of period; 0 = off. Boundaries hold across runs.
+    void set_sampling(uint64_t period, bool by_cycles, std::function<void()> sample);
+
+    // Cycles that may still run before the cycle limit or the next cycle
+    // sample (max if none)
+    uint64_t cycles_left(uint64_t cycles) const {
+        uint64_t left = std::numeric_limits<uint64_t>::max();
+        if (limits.max_cycles) left = cycles < cycle_end ? cycle_end - cycles : 0;
+        if (sample_period && sample_cycles) {
+            left = std::min(left, cycles < sample_end ? sample_end - cycles : 0);
+        }
+        return left;
+    }
+
+    // The engine jumped ahead several cycles: check limits on the next tick
+    void resync() { budget = 1; }
+
+    // Ctrl-C handling: SIGINT sets a flag instead of killing the process
+    static void install_interrupt_handler();
+    static bool interrupted() { return interrupt_flag != 0; }
+    static void request_interrupt() { interrupt_flag = 1; }
+    static void clear_interrupt() { interrupt_flag = 0; }
+
+private:
+    RunLimits limits;
+    uint64_t insn_end = 0;
+    uint64_t cycle_end = 0;
+    std::chrono::steady_clock::time_point deadline;
+    uint64_t budget = 0;
+
+    uint64_t sample_period = 0;
+    bool sample_cycles = false;
+    uint64_t sample_end = 0;
+    std::function<void()> sample;
+
+    static volatile std::sig_atomic_t interrupt_flag;
+
+    StopReason check(uint64_t instructions, uint64_t cycles);
+};
+
+#endif // WATCHDOG_HPP
@@ -0,0 +1,466 @@
+/**
+ * batch_engine.cpp
+ *
+ * Lane-batched execution: grouping by PC, masked lane loops and
+ * per-lane memory arenas.
+ */
+
+#include "batch_engine.hpp"
+#include "decoder.hpp"
+#include "alu.hpp"
+#include "memory.hpp"
+#include <algorithm>
+#include <chrono>
+
+// =============================================================================
+// Setup
+// =============================================================================
+
+BatchEngine::BatchEngine() : lanes(0), arena_size(0), text_base(0), data_base(0),
+                             data_bytes(0), stack_base(0), group_pc(0), waiting_pc(0),
+                             running(0), steps(0), regroups(0), seconds(0) {}
+
+bool BatchEngine::validate(const Config& cfg, std::string& error) {
+    if (cfg.lanes < 1 || cfg.lanes > MAX_LANES) {
+        error = "lanes must be 1.." + std::to_string(MAX_LANES);
+        return false;
+    }
+    if (cfg.data_size % 4 != 0 || cfg.stack_size == 0 || cfg.stack_size % 16 != 0 ||
+        cfg.stack_size > 0x10000000) {
+        error = "data size must be a multiple of 4, stack size a multiple of 16 up to 256 MB";
+        return false;
+    }
+    uint64_t total = static_cast<uint64_t>(cfg.lanes) * (cfg.data_size + cfg.stack_size);
+    if (total > (1ULL << 30)) {
+        error = "lanes x (data + stack) exceeds 1 GB";
+        return false;
+    }
+    if (cfg.show < 0) {
+        error = "show must not be negative";
+        return false;
+    }
+    return true;
+}
+
+void BatchEngine::configure(const Config& cfg) {
+    config = cfg;
+}
+
+const BatchEngine::Config& BatchEngine::get_config() const { return config; }
+
+void BatchEngine::start(const std::vector<Word>& text, Address text_addr,
+                        const std::vector<Byte>& data, Address data_addr) {
+    lanes = (config.lanes + LANE_ALIGN - 1) / LANE_ALIGN * LANE_ALIGN;
+
+    program.clear();
+    for (size_t i = 0; i < text.size(); i++) {
+        program.push_back(Decoder::decode(text[i], text_addr + 4 * static_cast<Address>(i)));
+    }
+    text_base = text_addr;
+
+    // Data from the image base, stack ending at the 16-byte aligned top
+    data_base = data_addr;
+    data_bytes = std::max<uint32_t>(config.data_size, (data.size() + 3) & ~size_t(3));
+    stack_base = Memory::STACK_TOP + 16 - config.stack_size;
+    arena_size = static_cast<size_t>(data_bytes) + config.stack_size;
+
+    arena.assign(lanes * arena_size, 0);
+    for (size_t l = 0; l < lanes; l++) {
+        std::copy(data.begin(), data.end(), arena.begin() + l * arena_size);
+    }
+
+    regs.assign(32 * lanes, 0);
+    pcs.assign(lanes, text_addr);
+    mask.assign(lanes, 0);
+    targets.assign(lanes, 0);
+    exit_codes.assign(lanes, 0);
+    retired.assign(lanes, 0);
+
+    // Padding lanes start stopped and are never grouped
+    state.assign(lanes, LaneState::HALTED);
+    std::fill(state.begin(), state.begin() + config.lanes, LaneState::RUNNING);
+    running = config.lanes;
+
+    for (size_t l = 0; l < lanes; l++) {
+        reg(2)[l] = Memory::STACK_TOP;
+        reg(4)[l] = static_cast<Word>(l);
+        reg(10)[l] = static_cast<Word>(config.first + static_cast<SignedWord>(l) * config.step);
+    }
+
+    group_pc = text_addr;
+    waiting_pc = text_addr;
+    steps = 0;
+    regroups = 0;
+    seconds = 0;
+}
+
+// =============================================================================
+// Run
+// =============================================================================
+
+bool BatchEngine::regroup() {
+    if (running == 0) return false;
+    regroups++;
+
+    group_pc = std::numeric_limits<Address>::max();
+    for (size_t l = 0; l < lanes; l++) {
+        if (state[l] == LaneState::RUNNING) group_pc = std::min(group_pc, pcs[l]);
+    }
+
+    waiting_pc = std::numeric_limits<Address>::max();
+    for (size_t l = 0; l < lanes; l++) {
+        bool live = state[l] == LaneState::RUNNING;
+        mask[l] = live && pcs[l] == group_pc ? ~Word(0) : 0;
+        if (live && pcs[l] != group_pc) waiting_pc = std::min(waiting_pc, pcs[l]);
+    }
+    return true;
+}
+
+StopReason BatchEngine::run(const RunLimits& limits) {
+    auto begin = std::chrono::steady_clock::now();
+    watchdog.start(limits, steps, steps);
+
+    StopReason reason = StopReason::HALTED;
+    bool diverged = true;
+    while (true) {
+        // Lanes that skipped ahead rejoin when the group reaches them
+        if (diverged || group_pc >= waiting_pc) {
+            if (!regroup()) break;
+        }
+
+        Address offset = group_pc - text_base;
+        if ((offset & 3) != 0 || offset / 4 >= program.size()) {
+            stop_lanes(LaneState::TRAPPED);
+            diverged = true;
+            continue;
+        }
+
+        steps++;
+        diverged = execute(program[offset / 4]);
+
+        reason = watchdog.tick(steps, steps);
+        if (reason != StopReason::NONE) break;
+        reason = StopReason::HALTED;
+    }
+
+    seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return reason;
+}
+
+// =============================================================================
+// Lane Operations
+// =============================================================================
+
+// Every lane computes; the mask keeps the result only in the group's lanes
+template <typename F>
+inline void BatchEngine::write_lanes(int rd, F value) {
+    if (rd == 0) return;
+    Word* d = reg(rd);
+    const Word* m = mask.data();
+    for (size_t l = 0; l < lanes; l++) {
+        d[l] = (value(l) & m[l]) | (d[l] & ~m[l]);
+    }
+}
+
+template <typename B>
+inline void BatchEngine::alu_lanes(const Instruction& ins, B b) {
+    const Word* a = reg(ins.rs1);
+    switch (ins.alu_op) {
+        case AluOp::ADD:
+            write_lanes(ins.rd, [&](size_t l) { return a[l] + b(l); });
+            break;
+        case AluOp::SUB:
+            write_lanes(ins.rd, [&](size_t l) { return a[l] - b(l); });
+            break;
+        case AluOp::SLL:
+            write_lanes(ins.rd, [&](size_t l) { return a[l] << (b(l) & 0x1F); });
+            break;
+        case AluOp::SRL:
+            write_lanes(ins.rd, [&](size_t l) { return a[l] >> (b(l) & 0x1F); });
+            break;
+        case AluOp::SRA:
+            write_lanes(ins.rd, [&](size_t l) {
+                return static_cast<Word>(static_cast<SignedWord>(a[l]) >> (b(l) & 0x1F));
+            });
+            break;
+        case AluOp::SLT:
+            write_lanes(ins.rd, [&](size_t l) {
+                return Word(static_cast<SignedWord>(a[l]) < static_cast<SignedWord>(b(l)));
+            });
+            break;
+        case AluOp::SLTU:
+            write_lanes(ins.rd, [&](size_t l) { return Word(a[l] < b(l)); });
+            break;
+        case AluOp::XOR:
+            write_lanes(ins.rd, [&](size_t l) { return a[l] ^ b(l); });
+            break;
+        case AluOp::OR:
+            write_lanes(ins.rd, [&](size_t l) { return a[l] | b(l); });
+            break;
+        case AluOp::AND:
+            write_lanes(ins.rd, [&](size_t l) { return a[l] & b(l); });
+            break;
+        case AluOp::MUL:
+            write_lanes(ins.rd, [&](size_t l) { return a[l] * b(l); });
+            break;
+        case AluOp::PASS_B:
+            write_lanes(ins.rd, [&](size_t l) { return b(l); });
+            break;
+        default:
+            // High multiplies and divides: the scalar ALU per lane
+            write_lanes(ins.rd, [&](size_t l) { return ALU::execute(ins.alu_op, a[l], b(l)); });
+            break;
+    }
+}
+
+void BatchEngine::advance(Address next) {
+    const Word* m = mask.data();
+    for (size_t l = 0; l < lanes; l++) {
+        pcs[l] = (next & m[l]) | (pcs[l] & ~m[l]);
+        retired[l] += m[l] & 1;
+    }
+    group_pc = next;
+}
+
+bool BatchEngine::jump_lanes() {
+    const Word* m = mask.data();
+    Address low = std::numeric_limits<Address>::max();
+    Address high = 0;
+    for (size_t l = 0; l < lanes; l++) {
+        pcs[l] = (targets[l] & m[l]) | (pcs[l] & ~m[l]);
+        retired[l] += m[l] & 1;
+        if (m[l]) {
+            low = std::min(low, targets[l]);
+            high = std::max(high, targets[l]);
+        }
+    }
+    // The group stays together if every lane went the same way
+    group_pc = low;
+    return low != high;
+}
+
+void BatchEngine::branch_lanes(const Instruction& ins) {
+    const Word* a = reg(ins.rs1);
+    const Word* b = reg(ins.rs2);
+    const Address taken_pc = group_pc + ins.imm;
+    const Address next_pc = group_pc + 4;
+    Address* t = targets.data();
+
+    auto select = [&](auto taken) {
+        for (size_t l = 0; l < lanes; l++) t[l] = taken(l) ? taken_pc : next_pc;
+    };
+    auto sa = [&](size_t l) { return static_cast<SignedWord>(a[l]); };
+    auto sb = [&](size_t l) { return static_cast<SignedWord>(b[l]); };
+
+    switch (ins.type) {
+        case InsType::BEQ:  select([&](size_t l) { return a[l] == b[l]; }); break;
+        case InsType::BNE:  select([&](size_t l) { return a[l] != b[l]; }); break;
+        case InsType::BLT:  select([&](size_t l) { return sa(l) < sb(l); }); break;
+        case InsType::BGE:  select([&](size_t l) { return sa(l) >= sb(l); }); break;
+        case InsType::BLTU: select([&](size_t l) { return a[l] < b[l]; }); break;
+        case InsType::BGEU: select([&](size_t l) { return a[l] >= b[l]; }); break;
+        default:            select([](size_t) { return false; }); break;
+    }
+}
+
+bool BatchEngine::memory_lanes(const Instruction& ins) {
+    const Word* a = reg(ins.rs1);
+    const Word* data = reg(ins.rs2);
+    Word* d = ins.rd != 0 ? reg(ins.rd) : nullptr;
+    const int bytes = access_bytes(ins.type);
+    bool faulted = false;
+
+    for (size_t l = 0; l < lanes; l++) {
+        if (!mask[l]) continue;
+        Byte* p = translate(l, a[l] + ins.imm, bytes);
+        if (!p) {
+            // Stop the lane at the faulting access
+            state[l] = LaneState::TRAPPED;
+            mask[l] = 0;
+            running--;
+            faulted = true;
+            continue;
+        }
+
+        if (ins.mem_write) {
+            for (int i = 0; i < bytes; i++) p[i] = static_cast<Byte>(data[l] >> (8 * i));
+            continue;
+        }
+
+        Word value = 0;
+        for (int i = 0; i < bytes; i++) value |= static_cast<Word>(p[i]) << (8 * i);
+        if (ins.type == InsType::LB) value = sign_extend(value, 8);
+        else if (ins.type == InsType::LH) value = sign_extend(value, 16);
+        if (d) d[l] = value;
+    }
+    return faulted;
+}
+
+void BatchEngine::stop_lanes(LaneState s) {
+    for (size_t l = 0; l < lanes; l++) {
+        if (!mask[l]) continue;
+        state[l] = s;
+        mask[l] = 0;
+        running--;
+    }
+}
+
+Byte* BatchEngine::translate(size_t lane, Address addr, int bytes) {
+    Byte* base = &arena[lane * arena_size];
+    Address offset = addr - data_base;
+    if (offset < data_bytes && static_cast<Address>(bytes) <= data_bytes - offset) {
+        return base + offset;
+    }
+    offset = addr - stack_base;
+    if (offset < config.stack_size && static_cast<Address>(bytes) <= config.stack_size - offset) {
+        return base + data_bytes + offset;
+    }
+    return nullptr;
+}
+
+// =============================================================================
+// Execute
+// =============================================================================
+
+bool BatchEngine::execute(const Instruction& ins) {
+    switch (ins.type) {
+        case InsType::UNKNOWN:
+        case InsType::EBREAK:
+            stop_lanes(LaneState::TRAPPED);
+            return true;
+
+        case InsType::ECALL: {
+            const Word* a0 = reg(10);
+            const Word* a7 = reg(17);
+            for (size_t l = 0; l < lanes; l++) {
+                if (!mask[l]) continue;
+                retired[l]++;
+                exit_codes[l] = a0[l];
+                state[l] = a7[l] == SYS_EXIT ? LaneState::EXITED : LaneState::HALTED;
+                mask[l] = 0;
+                running--;
+            }
+            return true;
+        }
+
+        case InsType::LUI: {
+            const Word imm = ins.imm;
+            write_lanes(ins.rd, [imm](size_t) { return imm; });
+            break;
+        }
+        case InsType::AUIPC: {
+            const Word value = group_pc + ins.imm;
+            write_lanes(ins.rd, [value](size_t) { return value; });
+            break;
+        }
+
+        case InsType::JAL: {
+            const Word link = group_pc + 4;
+            write_lanes(ins.rd, [link](size_t) { return link; });
+            advance(group_pc + ins.imm);
+            return false;
+        }
+        case InsType::JALR: {
+            // Targets first: rd may be rs1
+            const Word* a = reg(ins.rs1);
+            for (size_t l = 0; l < lanes; l++) targets[l] = (a[l] + ins.imm) & ~Address(1);
+            const Word link = group_pc + 4;
+            write_lanes(ins.rd, [link](size_t) { return link; });
+            return jump_lanes();
+        }
+
+        default:
+            if (ins.branch) {
+                branch_lanes(ins);
+                return jump_lanes();
+            }
+            if (ins.mem_read || ins.mem_write) {
+                bool faulted = memory_lanes(ins);
+                advance(group_pc + 4);
+                return faulted;
+            }
+            if (ins.alu_src) {
+                const Word imm = ins.imm;
+                alu_lanes(ins, [imm](size_t) { return imm; });
+            } else {
+                const Word* b = reg(ins.rs2);
+                alu_lanes(ins, [b](size_t l) { return b[l]; });
+            }
+            break;
+    }
+
+    advance(group_pc + 4);
+    return false;
+}
+
+// =============================================================================
+// Display
+// =============================================================================
+
+const char* BatchEngine::state_name(LaneState s) {
+    switch (s) {
+        case LaneState::RUNNING: return "running";
+        case LaneState::HALTED:  return "halted";
+        case LaneState::EXITED:  return "exited";
+        case LaneState::TRAPPED: return "trapped";
+    }
+    return "?";
+}
+
+void BatchEngine::print_config() const {
+    uint64_t total = static_cast<uint64_t>(config.lanes) * (config.data_size + config.stack_size);
+    std::cout << "Batch: " << config.lanes << " lanes, a0 = " << config.first
+              << " + lane * " << config.step << ", " << config.data_size << " B data + "
+              << config.stack_size << " B stack per lane (" << (total + 1023) / 1024 << " KB)\n";
+}
+
+void BatchEngine::print_stats() const {
+    uint64_t lane_insns = 0;
+    size_t counts[4] = {0, 0, 0, 0};
+    SignedWord low = std::numeric_limits<SignedWord>::max();
+    SignedWord high = std::numeric_limits<SignedWord>::min();
+    for (int l = 0; l < config.lanes; l++) {
+        lane_insns += retired[l];
+        counts[static_cast<int>(state[l])]++;
+        if (state[l] == LaneState::EXITED) {
+            low = std::min(low, static_cast<SignedWord>(exit_codes[l]));
+            high = std::max(high, static_cast<SignedWord>(exit_codes[l]));
+        }
+    }
+
+    std::cout << "  Batch run: " << config.lanes << " lanes, " << steps << " steps, "
+              << lane_insns << " lane instructions\n";
+    std::cout << "    Lanes: " << counts[static_cast<int>(LaneState::EXITED)] << " exited, "
+              << counts[static_cast<int>(LaneState::HALTED)] << " halted, "
+              << counts[static_cast<int>(LaneState::TRAPPED)] << " trapped, "
+              << counts[static_cast<int>(LaneState::RUNNING)] << " running\n";
+    if (counts[static_cast<int>(LaneState::EXITED)] > 0) {
+        std::cout << "    Exit codes: " << low << " .. " << high << "\n";
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+    if (steps > 0) {
+        double active = static_cast<double>(lane_insns) / steps;
+        std::cout << "    Active lanes per step: " << active << " ("
+                  << 100.0 * active / config.lanes << "%), regroups: " << regroups << "\n";
+    }
+    if (seconds > 0) {
+        std::cout << "    Time: " << std::setprecision(3) << seconds << " s, "
+                  << std::setprecision(1) << lane_insns / seconds / 1e6
+                  << " M lane instructions/s\n";
+    }
+
+    int show = std::min(config.show, config.lanes);
+    if (show == 0) return;
+    std::cout << "    " << std::left << std::setw(7) << "Lane" << std::setw(12) << "a0 (start)"
+              << std::setw(9) << "State" << std::right << std::setw(12) << "Exit code"
+              << std::setw(14) << "Instructions" << "  PC\n";
+    for (int l = 0; l < show; l++) {
+        SignedWord a0 = config.first + static_cast<SignedWord>(l) * config.step;
+        std::string code = state[l] == LaneState::EXITED || state[l] == LaneState::HALTED
+                               ? std::to_string(static_cast<SignedWord>(exit_codes[l])) : "-";
+        std::cout << "    " << std::left << std::setw(7) << l << std::setw(12) << a0
+                  << std::setw(9) << state_name(state[l]) << std::right << std::setw(12) << code
+                  << std::setw(14) << retired[l] << "  " << to_hex(pcs[l]) << "\n";
+    }
+}
@@ -0,0 +1,237 @@
+/**
+ * block_analyzer.cpp
+ *
+ * Block replication, control-flow pinning, pipeline sampling and the
+ * throughput/timeline report.
+ */
+
+#include "block_analyzer.hpp"
+#include "decoder.hpp"
+#include "memory.hpp"
+#include "register_file.hpp"
+#include "pipeline.hpp"
+#include <algorithm>
+
+// =============================================================================
+// Control-Flow Pinning
+// =============================================================================
+
+static constexpr Word OP_JAL = 0b1101111;
+static constexpr Word OP_BRANCH = 0b1100011;
+static constexpr Word FUNCT3_BLTU = 0b110;     // rs < x0: never taken
+static constexpr Word FUNCT3_BGEU = 0b111;     // rs >= x0: always taken
+
+// bltu/bgeu rs, x0 to the next instruction (B-type immediate 4)
+static Word branch_next(Word funct3, int rs) {
+    return (static_cast<Word>(rs) << 15) | (funct3 << 12) | (1u << 9) | OP_BRANCH;
+}
+
+// jal rd, +4 (J-type immediate 4)
+static Word jal_next(int rd) {
+    return (1u << 22) | (static_cast<Word>(rd) << 7) | OP_JAL;
+}
+
+Word BlockAnalyzer::pin(const Instruction& ins, size_t index, std::string& note) const {
+    if (ins.branch) {
+        // Keep the dependency on the register the comparison waits for
+        int rs = ins.reads_rs1 && ins.rs1 != 0 ? ins.rs1 : ins.rs2;
+        bool closes = index + 1 == original.size() &&
+                      ins.pc + static_cast<Address>(ins.imm) == block_start;
+        note = closes ? "taken, to the next iteration" : "pinned not taken";
+        return branch_next(closes ? FUNCT3_BGEU : FUNCT3_BLTU, rs);
+    }
+    if (ins.jump) {
+        note = index + 1 == original.size() ? "taken, to the next iteration"
+                                            : "taken, to the next instruction";
+        return jal_next(ins.rd);
+    }
+    if (ins.type == InsType::ECALL || ins.type == InsType::EBREAK) {
+        note = "replaced by a nop";
+        return 0x00000013;
+    }
+    return ins.raw;
+}
+
+// =============================================================================
+// Analysis
+// =============================================================================
+
+bool BlockAnalyzer::analyze(const std::vector<Word>& block, Address start, const Config& cfg,
+                            std::string& error) {
+    if (block.empty() || block.size() > MAX_BLOCK) {
+        error = "block must be 1.." + std::to_string(MAX_BLOCK) + " instructions";
+        return false;
+    }
+    if (cfg.iterations < 2 || cfg.iterations > MAX_ITERATIONS) {
+        error = "iterations must be 2.." + std::to_string(MAX_ITERATIONS);
+        return false;
+    }
+
+    config = cfg;
+    config.timeline = std::clamp(config.timeline, 0, config.iterations);
+    block_start = start;
+
+    original.clear();
+    for (size_t i = 0; i < block.size(); i++) {
+        original.push_back(Decoder::decode(block[i], start + 4 * static_cast<Address>(i)));
+        if (original.back().type == InsType::UNKNOWN) {
+            error = "illegal instruction at " + to_hex(original.back().pc);
+            return false;
+        }
+    }
+
+    const size_t n = original.size();
+    notes.assign(n, "");
+    std::vector<Word> body;
+    for (size_t i = 0; i < n; i++) body.push_back(pin(original[i], i, notes[i]));
+
+    // Copies back to back, then an ecall to stop
+    std::vector<Word> text;
+    for (int k = 0; k < config.iterations; k++) text.insert(text.end(), body.begin(), body.end());
+    text.push_back(0x00000073);
+
+    Memory mem;
+    RegisterFile regs;
+    mem.write_block(Memory::TEXT_BASE, text);
+
+    // Synthetic operands: distinct, word aligned, inside the data segment
+    for (int r = 1; r < NUM_REGISTERS; r++) regs.write(r, Memory::DATA_BASE + r * 0x100);
+    regs.write(2, Memory::STACK_TOP);
+
+    Pipeline pipe(mem, regs);
+    pipe.set_hazard_detection(config.hazard_detection);
+    pipe.set_forwarding(config.forwarding);
+    pipe.set_branch_stage(config.branch_stage);
+
+    const size_t total = n * config.iterations;
+    Slot empty;
+    std::fill(std::begin(empty.first), std::end(empty.first), -1);
+    std::fill(std::begin(empty.last), std::end(empty.last), -1);
+    slots.assign(total, empty);
+
+    auto index_of = [total](Address pc) {
+        size_t i = (pc - Memory::TEXT_BASE) / 4;
+        return i < total ? i : total;
+    };
+    auto seen = [&](Stage s, Address pc, int64_t c) {
+        size_t i = index_of(pc);
+        if (i == total) return;
+        Slot& slot = slots[i];
+        if (s == IF && slot.last[IF] != c - 1) {
+            // Fetched again after a squash: forget the wrong-path stages
+            std::fill(std::begin(slot.first), std::end(slot.first), -1);
+            std::fill(std::begin(slot.last), std::end(slot.last), -1);
+        }
+        if (slot.first[s] < 0) slot.first[s] = c;
+        slot.last[s] = c;
+    };
+
+    const uint64_t limit = 64 * total + 64;
+    for (int64_t c = 0;; c++) {
+        StopReason reason = pipe.cycle();
+
+        if (pipe.get_if_id().valid) seen(IF, pipe.get_if_id().pc, c);
+        if (pipe.get_id_ex().valid) seen(ID, pipe.get_id_ex().pc, c);
+        if (pipe.get_ex_mem().valid) seen(EX, pipe.get_ex_mem().ins.pc, c);
+        if (pipe.get_mem_wb().valid) seen(MEM, pipe.get_mem_wb().ins.pc, c);
+
+        if (reason != StopReason::NONE) break;
+        if (static_cast<uint64_t>(c) >= limit) {
+            error = "block did not finish within " + std::to_string(limit) + " cycles";
+            return false;
+        }
+    }
+
+    cycles = pipe.get_cycle_count();
+    instructions = total;
+    stalls = pipe.get_stall_count();
+    flushes = pipe.get_flush_count();
+    forwards = pipe.get_forward_count();
+    return true;
+}
+
+int64_t BlockAnalyzer::retire_cycle(size_t dyn) const {
+    return slots[dyn].last[MEM] + 1;
+}
+
+// =============================================================================
+// Report
+// =============================================================================
+
+void BlockAnalyzer::print_report() const {
+    const size_t n = original.size();
+    const int iterations = config.iterations;
+    const int half = iterations / 2;
+
+    std::cout << "Block " << to_hex(block_start) << "-" << to_hex(block_start + 4 * n)
+              << ": " << n << " instructions x " << iterations << " iterations (hazards "
+              << (config.hazard_detection ? "on" : "off") << ", forwarding "
+              << (config.forwarding ? "on" : "off") << ", branches resolve in "
+              << branch_stage_name(config.branch_stage) << ", perfect memory)\n";
+
+    // Steady state: the second half of the iterations
+    int64_t from = retire_cycle(half * n - 1);
+    int64_t to = retire_cycle(iterations * n - 1);
+    double per_iteration = static_cast<double>(to - from) / (iterations - half);
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  Cycles per iteration: " << per_iteration
+              << "  (IPC " << n / per_iteration << ")\n";
+    std::cout << "  Total: " << cycles << " cycles, " << instructions << " instructions, "
+              << stalls << " stall cycles (" << static_cast<double>(stalls) / instructions
+              << " per instruction), " << flushes << " squashed slots, " << forwards
+              << " forwards\n";
+
+    // Cycles each instruction spent beyond the ideal IF..WB of 5 cycles
+    std::cout << "  Extra cycles per instruction (steady state):\n";
+    for (size_t j = 0; j < n; j++) {
+        double wait = 0;
+        for (int k = half; k < iterations; k++) {
+            const Slot& slot = slots[k * n + j];
+            wait += retire_cycle(k * n + j) - slot.first[IF] - 4;
+        }
+        wait /= iterations - half;
+        std::cout << "    " << std::setw(3) << j << "  " << to_hex(original[j].pc) << "  "
+                  << std::left << std::setw(26) << original[j].text << std::right
+                  << std::setw(6) << wait;
+        if (!notes[j].empty()) std::cout << "  (" << notes[j] << ")";
+        std::cout << "\n";
+    }
+
+    print_timeline();
+}
+
+void BlockAnalyzer::print_timeline() const {
+    const size_t rows = original.size() * config.timeline;
+    if (rows == 0) return;
+
+    const int64_t origin = slots[0].first[IF];
+    int64_t width = std::min<int64_t>(TIMELINE_WIDTH, retire_cycle(rows - 1) - origin + 1);
+
+    std::cout << "  Timeline (F D E M W: stage entered, =: held):\n";
+    std::string header(width, ' ');
+    for (int64_t c = 0; c < width; c++) header[c] = static_cast<char>('0' + c % 10);
+    std::cout << "    " << std::string(8 + 26, ' ') << header << "\n";
+
+    static const char letters[STAGES] = {'F', 'D', 'E', 'M'};
+    for (size_t dyn = 0; dyn < rows; dyn++) {
+        const Slot& slot = slots[dyn];
+        std::string line(width, ' ');
+        auto mark = [&](int64_t c, char ch) {
+            if (c >= origin && c - origin < width) line[c - origin] = ch;
+        };
+        for (int s = 0; s < STAGES; s++) {
+            if (slot.first[s] < 0) continue;
+            for (int64_t c = slot.first[s]; c <= slot.last[s]; c++) {
+                mark(c, c == slot.first[s] ? letters[s] : '=');
+            }
+        }
+        mark(retire_cycle(dyn), 'W');
+
+        size_t k = dyn / original.size();
+        size_t j = dyn % original.size();
+        std::string label = "[" + std::to_string(k) + "," + std::to_string(j) + "]";
+        std::cout << "    " << std::left << std::setw(8) << label << std::setw(26)
+                  << original[j].text << std::right << line << "\n";
+    }
+}
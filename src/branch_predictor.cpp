@@ -0,0 +1,287 @@
+/**
+ * branch_predictor.cpp
+ *
+ * Static, bimodal, gshare, tournament and TAGE-lite predictors.
+ */
+
+#include "branch_predictor.hpp"
+#include <algorithm>
+#include <cmath>
+
+// =============================================================================
+// Helpers
+// =============================================================================
+
+static inline Address record_pc(BranchRecord r) { return r & ~3u; }
+static inline bool record_taken(BranchRecord r) { return r & 1; }
+static inline bool record_backward(BranchRecord r) { return r & 2; }
+
+// Saturating 2-bit counter, taken if >= 2
+static inline void train(uint8_t& counter, bool taken) {
+    if (taken) {
+        if (counter < 3) counter++;
+    } else if (counter > 0) {
+        counter--;
+    }
+}
+
+static inline uint64_t history_mask(int bits) {
+    return bits >= 64 ? ~0ULL : (1ULL << bits) - 1;
+}
+
+// XOR the history down to 'bits' bits
+static inline uint32_t fold(uint64_t history, int length, int bits) {
+    uint32_t folded = 0;
+    for (int i = 0; i < length; i += bits) {
+        folded ^= static_cast<uint32_t>(history >> i);
+    }
+    return folded & ((1u << bits) - 1);
+}
+
+static std::string entries_name(int index_bits) {
+    uint32_t entries = 1u << index_bits;
+    if (entries >= 1024) return std::to_string(entries / 1024) + "K";
+    return std::to_string(entries);
+}
+
+// =============================================================================
+// Static (BTFN)
+// =============================================================================
+
+std::string StaticPredictor::name() const { return "static btfn"; }
+uint64_t StaticPredictor::storage_bits() const { return 0; }
+void StaticPredictor::reset() {}
+
+uint64_t StaticPredictor::run(const BranchRecord* records, size_t count) {
+    uint64_t misses = 0;
+    for (size_t i = 0; i < count; i++) {
+        misses += record_backward(records[i]) != record_taken(records[i]);
+    }
+    return misses;
+}
+
+// =============================================================================
+// Bimodal
+// =============================================================================
+
+BimodalPredictor::BimodalPredictor(int index_bits) : index_bits(index_bits) {
+    reset();
+}
+
+std::string BimodalPredictor::name() const { return "bimodal " + entries_name(index_bits); }
+uint64_t BimodalPredictor::storage_bits() const { return 2ULL << index_bits; }
+
+void BimodalPredictor::reset() {
+    counters.assign(1u << index_bits, 1);
+}
+
+uint64_t BimodalPredictor::run(const BranchRecord* records, size_t count) {
+    const uint32_t mask = (1u << index_bits) - 1;
+    uint8_t* table = counters.data();
+    uint64_t misses = 0;
+    for (size_t i = 0; i < count; i++) {
+        bool taken = record_taken(records[i]);
+        uint8_t& c = table[(record_pc(records[i]) >> 2) & mask];
+        misses += (c >= 2) != taken;
+        train(c, taken);
+    }
+    return misses;
+}
+
+// =============================================================================
+// Gshare
+// =============================================================================
+
+GsharePredictor::GsharePredictor(int index_bits, int history_bits)
+    : index_bits(index_bits), history_bits(history_bits) {
+    reset();
+}
+
+std::string GsharePredictor::name() const {
+    return "gshare " + entries_name(index_bits) + " h" + std::to_string(history_bits);
+}
+
+uint64_t GsharePredictor::storage_bits() const { return (2ULL << index_bits) + history_bits; }
+
+void GsharePredictor::reset() {
+    counters.assign(1u << index_bits, 1);
+    history = 0;
+}
+
+uint64_t GsharePredictor::run(const BranchRecord* records, size_t count) {
+    const uint32_t mask = (1u << index_bits) - 1;
+    const uint64_t hmask = history_mask(history_bits);
+    uint8_t* table = counters.data();
+    uint64_t h = history;
+    uint64_t misses = 0;
+    for (size_t i = 0; i < count; i++) {
+        bool taken = record_taken(records[i]);
+        uint32_t index = (record_pc(records[i]) >> 2) ^ fold(h, history_bits, index_bits);
+        uint8_t& c = table[index & mask];
+        misses += (c >= 2) != taken;
+        train(c, taken);
+        h = ((h << 1) | taken) & hmask;
+    }
+    history = h;
+    return misses;
+}
+
+// =============================================================================
+// Tournament
+// =============================================================================
+
+TournamentPredictor::TournamentPredictor(int index_bits, int history_bits)
+    : index_bits(index_bits), history_bits(history_bits) {
+    reset();
+}
+
+std::string TournamentPredictor::name() const {
+    return "tournament " + entries_name(index_bits) + " h" + std::to_string(history_bits);
+}
+
+uint64_t TournamentPredictor::storage_bits() const {
+    return 3 * (2ULL << index_bits) + history_bits;
+}
+
+void TournamentPredictor::reset() {
+    local.assign(1u << index_bits, 1);
+    global.assign(1u << index_bits, 1);
+    chooser.assign(1u << index_bits, 2);
+    history = 0;
+}
+
+uint64_t TournamentPredictor::run(const BranchRecord* records, size_t count) {
+    const uint32_t mask = (1u << index_bits) - 1;
+    const uint64_t hmask = history_mask(history_bits);
+    uint64_t h = history;
+    uint64_t misses = 0;
+    for (size_t i = 0; i < count; i++) {
+        bool taken = record_taken(records[i]);
+        uint32_t pc_index = (record_pc(records[i]) >> 2) & mask;
+        uint8_t& l = local[pc_index];
+        uint8_t& g = global[(pc_index ^ fold(h, history_bits, index_bits)) & mask];
+        uint8_t& c = chooser[pc_index];
+
+        bool local_pred = l >= 2;
+        bool global_pred = g >= 2;
+        misses += (c >= 2 ? global_pred : local_pred) != taken;
+
+        // Chooser moves toward whichever component was right
+        if (local_pred != global_pred) train(c, global_pred == taken);
+        train(l, taken);
+        train(g, taken);
+        h = ((h << 1) | taken) & hmask;
+    }
+    history = h;
+    return misses;
+}
+
+// =============================================================================
+// TAGE-lite
+// =============================================================================
+
+TagePredictor::TagePredictor(int base_bits, int table_bits, int num_tables,
+                             int min_history, int max_history)
+    : base_bits(base_bits), table_bits(table_bits),
+      num_tables(std::clamp(num_tables, 1, MAX_TABLES)) {
+    max_history = std::clamp(max_history, 1, 64);
+    min_history = std::clamp(min_history, 1, max_history);
+
+    // Geometric series from min_history to max_history
+    history_len.fill(0);
+    for (int t = 0; t < this->num_tables; t++) {
+        double ratio = this->num_tables > 1 ? static_cast<double>(t) / (this->num_tables - 1) : 1.0;
+        history_len[t] = static_cast<int>(
+            std::lround(min_history * std::pow(static_cast<double>(max_history) / min_history, ratio)));
+    }
+    reset();
+}
+
+std::string TagePredictor::name() const {
+    return "tage-lite " + std::to_string(num_tables) + "x" + entries_name(table_bits) +
+           " h" + std::to_string(history_len[0]) + "-" + std::to_string(history_len[num_tables - 1]);
+}
+
+uint64_t TagePredictor::storage_bits() const {
+    return (2ULL << base_bits) + static_cast<uint64_t>(num_tables) * (TAG_BITS + 3 + 2) * (1ULL << table_bits) +
+           history_len[num_tables - 1];
+}
+
+void TagePredictor::reset() {
+    base.assign(1u << base_bits, 1);
+    tables.assign(static_cast<size_t>(num_tables) << table_bits, Entry());
+    history = 0;
+    branches = 0;
+}
+
+uint64_t TagePredictor::run(const BranchRecord* records, size_t count) {
+    const uint32_t base_mask = (1u << base_bits) - 1;
+    const uint32_t table_mask = (1u << table_bits) - 1;
+    const uint16_t tag_mask = (1u << TAG_BITS) - 1;
+    const uint16_t tag_valid = 0x8000;
+
+    std::array<Entry*, MAX_TABLES> entry;
+    std::array<uint16_t, MAX_TABLES> tag;
+    uint64_t misses = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        bool taken = record_taken(records[i]);
+        uint32_t pc = record_pc(records[i]) >> 2;
+
+        // Look up every tagged table; the longest hit provides
+        int provider = -1;
+        int alt = -1;
+        for (int t = 0; t < num_tables; t++) {
+            uint64_t h = history & history_mask(history_len[t]);
+            uint32_t index = (pc ^ (pc >> table_bits) ^ fold(h, history_len[t], table_bits)) & table_mask;
+            entry[t] = &tables[(static_cast<size_t>(t) << table_bits) + index];
+            tag[t] = tag_valid | ((pc ^ (fold(h, history_len[t], TAG_BITS - 1) << 1)) & tag_mask);
+            if (entry[t]->tag == tag[t]) {
+                alt = provider;
+                provider = t;
+            }
+        }
+
+        uint8_t& b = base[pc & base_mask];
+        bool base_pred = b >= 2;
+        bool alt_pred = alt >= 0 ? entry[alt]->ctr >= 0 : base_pred;
+        bool pred = provider >= 0 ? entry[provider]->ctr >= 0 : base_pred;
+        misses += pred != taken;
+
+        // Allocate in a longer table on a misprediction
+        if (pred != taken && provider < num_tables - 1) {
+            bool allocated = false;
+            for (int t = provider + 1; t < num_tables; t++) {
+                if (entry[t]->useful == 0) {
+                    entry[t]->tag = tag[t];
+                    entry[t]->ctr = taken ? 0 : -1;
+                    allocated = true;
+                    break;
+                }
+            }
+            if (!allocated) {
+                for (int t = provider + 1; t < num_tables; t++) entry[t]->useful--;
+            }
+        }
+
+        if (provider >= 0) {
+            Entry& e = *entry[provider];
+            if (taken && e.ctr < 3) e.ctr++;
+            else if (!taken && e.ctr > -4) e.ctr--;
+            if (pred != alt_pred) {
+                if (pred == taken && e.useful < 3) e.useful++;
+                else if (pred != taken && e.useful > 0) e.useful--;
+            }
+        } else {
+            train(b, taken);
+        }
+
+        history = (history << 1) | taken;
+
+        // Let stale entries be replaced eventually
+        if (++branches % AGING_PERIOD == 0) {
+            for (Entry& e : tables) e.useful >>= 1;
+        }
+    }
+    return misses;
+}
@@ -0,0 +1,78 @@
+/**
+ * branch_sweep.cpp
+ *
+ * Batched multi-predictor evaluation and report.
+ */
+
+#include "branch_sweep.hpp"
+
+BranchSweep::BranchSweep() {
+    predictors.push_back(std::make_unique<StaticPredictor>());
+    for (int bits : {9, 11, 13}) {
+        predictors.push_back(std::make_unique<BimodalPredictor>(bits));
+    }
+    const std::pair<int, int> gshare[] = {{11, 8}, {11, 11}, {13, 13}, {15, 15}};
+    for (const auto& [bits, hist] : gshare) {
+        predictors.push_back(std::make_unique<GsharePredictor>(bits, hist));
+    }
+    predictors.push_back(std::make_unique<TournamentPredictor>(12, 12));
+    predictors.push_back(std::make_unique<TagePredictor>(12, 10, 4, 4, 64));
+    predictors.push_back(std::make_unique<TagePredictor>(12, 11, 6, 4, 64));
+    reset();
+}
+
+void BranchSweep::reset() {
+    for (auto& p : predictors) p->reset();
+    mispredicts.assign(predictors.size(), 0);
+    batch_size = 0;
+    instructions = 0;
+    branches = 0;
+    taken_count = 0;
+}
+
+void BranchSweep::flush() {
+    if (batch_size == 0) return;
+
+    for (size_t i = 0; i < batch_size; i++) taken_count += batch[i] & 1;
+    branches += batch_size;
+
+    // Predictor-major: one predictor walks the whole batch before the next
+    for (size_t p = 0; p < predictors.size(); p++) {
+        mispredicts[p] += predictors[p]->run(batch.data(), batch_size);
+    }
+    batch_size = 0;
+}
+
+// =============================================================================
+// Display
+// =============================================================================
+
+void BranchSweep::print_config() const {
+    std::cout << "Branch predictor sweep: " << predictors.size() << " predictors\n";
+    for (const auto& p : predictors) {
+        std::cout << "  " << p->name() << " (" << (p->storage_bits() + 7) / 8 << " B)\n";
+    }
+}
+
+void BranchSweep::print_stats() {
+    flush();
+
+    std::cout << "  Branch predictor sweep: " << branches << " conditional branches ("
+              << taken_count << " taken), " << instructions << " instructions\n";
+    std::cout << "    " << std::left << std::setw(24) << "Predictor" << std::right
+              << std::setw(10) << "Storage" << std::setw(14) << "Mispredicts"
+              << std::setw(10) << "Accuracy" << std::setw(9) << "MPKI" << "\n";
+
+    std::cout << std::fixed << std::setprecision(2);
+    for (size_t p = 0; p < predictors.size(); p++) {
+        uint64_t bytes = (predictors[p]->storage_bits() + 7) / 8;
+        std::string storage = bytes >= 1024 ? std::to_string(bytes / 1024) + " KB"
+                                            : std::to_string(bytes) + " B";
+        double accuracy = branches ? 100.0 * (branches - mispredicts[p]) / branches : 0.0;
+        double mpki = instructions ? 1000.0 * mispredicts[p] / instructions : 0.0;
+
+        std::cout << "    " << std::left << std::setw(24) << predictors[p]->name() << std::right
+                  << std::setw(10) << storage << std::setw(14) << mispredicts[p]
+                  << std::setw(9) << accuracy << "%" << std::setw(9) << mpki << "\n";
+    }
+}
@@ -0,0 +1,261 @@
+/**
+ * cache.cpp
+ *
+ * Set-associative cache implementation.
+ */
+
+#include "cache.hpp"
+
+static bool is_power_of_two(uint32_t v) {
+    return v != 0 && (v & (v - 1)) == 0;
+}
+
+Cache::Cache(const std::string& name, const Config& config, MemoryLevel* next)
+    : name(name), next(next) {
+    configure(config);
+}
+
+bool Cache::validate(const Config& cfg, std::string& error) {
+    if (!is_power_of_two(cfg.line_size) || cfg.line_size < 4) {
+        error = "line size must be a power of two >= 4";
+        return false;
+    }
+    if (cfg.assoc < 1) {
+        error = "associativity must be at least 1";
+        return false;
+    }
+    uint32_t set_bytes = cfg.line_size * cfg.assoc;
+    if (cfg.size < set_bytes || cfg.size % set_bytes != 0 ||
+        !is_power_of_two(cfg.size / set_bytes)) {
+        error = "size must be a power-of-two multiple of line size x associativity";
+        return false;
+    }
+    if (cfg.latency < 1) {
+        error = "latency must be at least 1";
+        return false;
+    }
+    return true;
+}
+
+void Cache::configure(const Config& cfg) {
+    config = cfg;
+    num_sets = config.size / (config.line_size * config.assoc);
+    line_shift = 0;
+    while ((1u << line_shift) < config.line_size) line_shift++;
+    set_prefetcher(pf_config);
+}
+
+const Cache::Config& Cache::get_config() const { return config; }
+
+void Cache::set_next(MemoryLevel* level) { next = level; }
+
+void Cache::set_prefetcher(const Prefetcher::Config& cfg) {
+    pf_config = cfg;
+    prefetcher = Prefetcher::create(pf_config, config.line_size);
+    reset();
+}
+
+const Prefetcher::Config& Cache::get_prefetcher_config() const { return pf_config; }
+
+void Cache::reset() {
+    lines.assign(static_cast<size_t>(num_sets) * config.assoc, Line());
+    use_clock = 0;
+    last_trigger = false;
+    if (prefetcher) prefetcher->reset();
+
+    accesses = 0;
+    hits = 0;
+    misses = 0;
+    writebacks = 0;
+    total_latency = 0;
+    pf_issued = 0;
+    pf_useful = 0;
+    pf_late = 0;
+    pf_unused = 0;
+}
+
+// =============================================================================
+// Lookup and Allocation
+// =============================================================================
+
+Cache::Line* Cache::find(Address addr, uint32_t& set, uint32_t& tag) {
+    uint32_t line_addr = addr >> line_shift;
+    set = line_addr & (num_sets - 1);
+    tag = line_addr / num_sets;
+
+    Line* ways = &lines[static_cast<size_t>(set) * config.assoc];
+    for (int w = 0; w < config.assoc; w++) {
+        if (ways[w].valid && ways[w].tag == tag) return &ways[w];
+    }
+    return nullptr;
+}
+
+Cache::Line* Cache::allocate(uint32_t set, uint64_t now) {
+    // Pick an invalid way, else the least recently used one
+    Line* ways = &lines[static_cast<size_t>(set) * config.assoc];
+    Line* victim = &ways[0];
+    for (int w = 0; w < config.assoc; w++) {
+        if (!ways[w].valid) {
+            victim = &ways[w];
+            break;
+        }
+        if (ways[w].last_use < victim->last_use) victim = &ways[w];
+    }
+
+    if (victim->valid && victim->prefetched) pf_unused++;
+
+    // Dirty victims are written back off the critical path
+    if (victim->valid && victim->dirty) {
+        writebacks++;
+        if (next) {
+            Address victim_addr = (victim->tag * num_sets + set) << line_shift;
+            next->access(victim_addr, true, now);
+        }
+    }
+    return victim;
+}
+
+// =============================================================================
+// Access
+// =============================================================================
+
+int Cache::access(Address addr, bool write, uint64_t now) {
+    uint32_t set, tag;
+    Line* line = find(addr, set, tag);
+
+    accesses++;
+    use_clock++;
+
+    if (line) {
+        hits++;
+        last_trigger = line->prefetched;
+        if (line->prefetched) {
+            pf_useful++;
+            if (line->ready_at > now) pf_late++;
+            line->prefetched = false;
+        }
+        line->last_use = use_clock;
+        line->dirty |= write;
+
+        // Fill still in flight: wait for it
+        int latency = config.latency;
+        if (line->ready_at > now + latency) latency = static_cast<int>(line->ready_at - now);
+        total_latency += latency;
+        return latency;
+    }
+
+    misses++;
+    last_trigger = true;
+    line = allocate(set, now);
+
+    int latency = config.latency;
+    if (next) latency += next->access(addr, false, now + config.latency);
+
+    line->tag = tag;
+    line->valid = true;
+    line->dirty = write;
+    line->prefetched = false;
+    line->last_use = use_clock;
+    line->ready_at = now + latency;
+
+    total_latency += latency;
+    return latency;
+}
+
+int Cache::demand_access(Address addr, bool write, uint64_t now, Address pc) {
+    int latency = access(addr, write, now);
+
+    if (prefetcher) {
+        pf_candidates.clear();
+        prefetcher->observe(pc, addr, last_trigger, pf_candidates);
+        for (Address target : pf_candidates) prefetch(target, now);
+    }
+    return latency;
+}
+
+void Cache::prefetch(Address addr, uint64_t now) {
+    uint32_t set, tag;
+    if (find(addr, set, tag)) return;
+
+    Line* line = allocate(set, now);
+    int latency = config.latency;
+    if (next) latency += next->access(addr, false, now + config.latency);
+
+    pf_issued++;
+    use_clock++;
+    line->tag = tag;
+    line->valid = true;
+    line->dirty = false;
+    line->prefetched = true;
+    line->last_use = use_clock;
+    line->ready_at = now + latency;
+}
+
+// =============================================================================
+// Display
+// =============================================================================
+
+uint64_t Cache::get_accesses() const { return accesses; }
+uint64_t Cache::get_misses() const { return misses; }
+
+void Cache::register_stats(StatsRegistry& stats, const std::string& prefix) const {
+    stats.add_counter(prefix + ".accesses", &accesses, "Demand and lower-level accesses");
+    stats.add_counter(prefix + ".hits", &hits, "Hits");
+    stats.add_counter(prefix + ".misses", &misses, "Misses");
+    stats.add_counter(prefix + ".writebacks", &writebacks, "Dirty lines written back");
+    stats.add_counter(prefix + ".total_latency", &total_latency, "Cycles over all accesses");
+    stats.add_formula(prefix + ".miss_rate", [prefix](const StatsRegistry& s) {
+        return s.ratio(prefix + ".misses", prefix + ".accesses");
+    }, "Misses per access");
+    stats.add_formula(prefix + ".avg_latency", [prefix](const StatsRegistry& s) {
+        return s.ratio(prefix + ".total_latency", prefix + ".accesses");
+    }, "Cycles per access");
+    if (prefetcher) {
+        stats.add_counter(prefix + ".prefetch.issued", &pf_issued, "Prefetches issued");
+        stats.add_counter(prefix + ".prefetch.useful", &pf_useful, "Prefetched lines used by a demand access");
+        stats.add_counter(prefix + ".prefetch.late", &pf_late, "Useful prefetches that arrived late");
+        stats.add_counter(prefix + ".prefetch.unused", &pf_unused, "Prefetched lines evicted unused");
+        stats.add_formula(prefix + ".prefetch.accuracy", [prefix](const StatsRegistry& s) {
+            return s.ratio(prefix + ".prefetch.useful", prefix + ".prefetch.issued");
+        }, "Useful per issued");
+    }
+}
+
+void Cache::print_config() const {
+    std::cout << "  " << name << ": " << config.size / 1024 << " KB, "
+              << config.assoc << "-way, " << config.line_size << " B lines, "
+              << config.latency << " cycle(s)";
+    if (prefetcher) {
+        std::cout << ", " << Prefetcher::type_name(pf_config.type) << " prefetch (degree "
+                  << pf_config.degree << ", distance " << pf_config.distance << ")";
+    }
+    std::cout << "\n";
+}
+
+void Cache::print_stats() const {
+    std::cout << "    " << name << ": " << accesses << " accesses, "
+              << hits << " hits, " << misses << " misses";
+    if (accesses > 0) {
+        std::cout << std::fixed << std::setprecision(2)
+                  << " (" << 100.0 * misses / accesses << "% miss), avg latency "
+                  << static_cast<double>(total_latency) / accesses;
+    }
+    std::cout << ", " << writebacks << " writebacks\n";
+
+    if (prefetcher) {
+        // Accuracy: useful / issued. Coverage: misses removed / misses
+        // without prefetching. Timely: useful prefetches that arrived in time.
+        std::cout << "      " << Prefetcher::type_name(pf_config.type) << " prefetch: "
+                  << pf_issued << " issued, " << pf_useful << " useful, "
+                  << pf_late << " late, " << pf_unused << " evicted unused";
+        std::cout << std::fixed << std::setprecision(2);
+        if (pf_issued > 0) std::cout << "; accuracy " << 100.0 * pf_useful / pf_issued << "%";
+        if (pf_useful + misses > 0) {
+            std::cout << ", coverage " << 100.0 * pf_useful / (pf_useful + misses) << "%";
+        }
+        if (pf_useful > 0) {
+            std::cout << ", timely " << 100.0 * (pf_useful - pf_late) / pf_useful << "%";
+        }
+        std::cout << "\n";
+    }
+}
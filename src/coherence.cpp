@@ -0,0 +1,302 @@
+/**
+ * coherence.cpp
+ *
+ * MESI directory coherence model and false-sharing report.
+ */
+
+#include "coherence.hpp"
+#include <algorithm>
+
+static bool is_power_of_two(uint32_t v) {
+    return v != 0 && (v & (v - 1)) == 0;
+}
+
+CoherenceModel::CoherenceModel() : CoherenceModel(Config()) {}
+
+CoherenceModel::CoherenceModel(const Config& cfg) {
+    configure(cfg);
+}
+
+bool CoherenceModel::validate(const Config& cfg, std::string& error) {
+    if (cfg.harts < 1 || cfg.harts > MAX_HARTS) {
+        error = "harts must be 1-" + std::to_string(MAX_HARTS);
+        return false;
+    }
+    if (!is_power_of_two(cfg.line_size) || cfg.line_size < 4 || cfg.line_size > 64) {
+        error = "line size must be a power of two from 4 to 64";
+        return false;
+    }
+    if (cfg.assoc < 1) {
+        error = "associativity must be at least 1";
+        return false;
+    }
+    uint32_t set_bytes = cfg.line_size * cfg.assoc;
+    if (cfg.size < set_bytes || cfg.size % set_bytes != 0 ||
+        !is_power_of_two(cfg.size / set_bytes)) {
+        error = "size must be a power-of-two multiple of line size x associativity";
+        return false;
+    }
+    if (cfg.hit_latency < 1 || cfg.upgrade_latency < 0 || cfg.transfer_latency < 0 ||
+        cfg.memory_latency < 0) {
+        error = "hit latency must be at least 1, other latencies at least 0";
+        return false;
+    }
+    return true;
+}
+
+void CoherenceModel::configure(const Config& cfg) {
+    config = cfg;
+    num_sets = config.size / (config.line_size * config.assoc);
+    line_shift = 0;
+    while ((1u << line_shift) < config.line_size) line_shift++;
+    reset();
+}
+
+const CoherenceModel::Config& CoherenceModel::get_config() const { return config; }
+
+void CoherenceModel::reset() {
+    lines.assign(static_cast<size_t>(config.harts) * num_sets * config.assoc, Line());
+    stats.assign(config.harts, HartStats());
+    use_clock = 0;
+    holders.clear();
+    hotspots.clear();
+
+    invalidations = 0;
+    false_sharing = 0;
+    transfers = 0;
+    writebacks = 0;
+    memory_fetches = 0;
+}
+
+// =============================================================================
+// Lookup and Allocation
+// =============================================================================
+
+CoherenceModel::Line* CoherenceModel::find(int hart, uint32_t line_addr) {
+    uint32_t set = line_addr & (num_sets - 1);
+    Line* ways = &lines[(static_cast<size_t>(hart) * num_sets + set) * config.assoc];
+    for (int w = 0; w < config.assoc; w++) {
+        if (ways[w].state != State::I && ways[w].line_addr == line_addr) return &ways[w];
+    }
+    return nullptr;
+}
+
+CoherenceModel::Line* CoherenceModel::allocate(int hart, uint32_t line_addr) {
+    // Pick an invalid way, else the least recently used one
+    uint32_t set = line_addr & (num_sets - 1);
+    Line* ways = &lines[(static_cast<size_t>(hart) * num_sets + set) * config.assoc];
+    Line* victim = &ways[0];
+    for (int w = 0; w < config.assoc; w++) {
+        if (ways[w].state == State::I) {
+            victim = &ways[w];
+            break;
+        }
+        if (ways[w].last_use < victim->last_use) victim = &ways[w];
+    }
+
+    if (victim->state != State::I) {
+        if (victim->state == State::M) writebacks++;
+        auto it = holders.find(victim->line_addr);
+        if (it != holders.end()) {
+            it->second &= ~(1u << hart);
+            if (it->second == 0) holders.erase(it);
+        }
+    }
+    return victim;
+}
+
+void CoherenceModel::invalidate_others(int hart, uint32_t line_addr, uint32_t mask,
+                                       uint64_t write_bytes) {
+    for (int o = 0; o < config.harts; o++) {
+        if (o == hart || !(mask & (1u << o))) continue;
+        Line* line = find(o, line_addr);
+        if (!line) continue;
+
+        // The copy was only needed for bytes this write does not touch
+        bool false_share = (line->touched & write_bytes) == 0;
+
+        line->state = State::I;
+        stats[o].invalidated++;
+        invalidations++;
+
+        Hotspot& spot = hotspots[line_addr];
+        spot.invalidations++;
+        spot.writers |= 1u << hart;
+        spot.victims |= 1u << o;
+        if (false_share) {
+            false_sharing++;
+            spot.false_sharing++;
+        }
+    }
+}
+
+// =============================================================================
+// Access
+// =============================================================================
+
+int CoherenceModel::access(int hart, Address addr, int bytes, bool write) {
+    HartStats& hs = stats[hart];
+    hs.accesses++;
+    use_clock++;
+
+    uint32_t line_addr = addr >> line_shift;
+    uint32_t offset = addr & (config.line_size - 1);
+    uint64_t byte_mask = ((1ULL << bytes) - 1) << offset;
+    uint32_t self = 1u << hart;
+
+    Line* line = find(hart, line_addr);
+    if (line) {
+        line->last_use = use_clock;
+        line->touched |= byte_mask;
+        if (!write || line->state == State::M) return config.hit_latency;
+        if (line->state == State::E) {
+            line->state = State::M;     // Silent upgrade: no other copies
+            return config.hit_latency;
+        }
+
+        // Shared: invalidate the other copies before writing
+        hs.upgrades++;
+        uint32_t& mask = holders[line_addr];
+        invalidate_others(hart, line_addr, mask, byte_mask);
+        mask = self;
+        line->state = State::M;
+        return config.hit_latency + config.upgrade_latency;
+    }
+
+    // Miss: evict first, then ask the directory who holds the line
+    hs.misses++;
+    line = allocate(hart, line_addr);
+    uint32_t& mask = holders[line_addr];
+    uint32_t others = mask & ~self;
+
+    int latency = config.hit_latency;
+    if (others) {
+        latency += config.transfer_latency;
+        hs.transfers_in++;
+        transfers++;
+        hotspots[line_addr].transfers++;
+    } else {
+        latency += config.memory_latency;
+        memory_fetches++;
+    }
+
+    State state;
+    if (write) {
+        invalidate_others(hart, line_addr, others, byte_mask);
+        mask = self;
+        state = State::M;
+    } else if (others) {
+        // Owners keep a shared copy; a modified one is written back
+        for (int o = 0; o < config.harts; o++) {
+            if (!(others & (1u << o))) continue;
+            Line* copy = find(o, line_addr);
+            if (!copy) continue;
+            if (copy->state == State::M) writebacks++;
+            copy->state = State::S;
+        }
+        mask |= self;
+        state = State::S;
+    } else {
+        mask = self;
+        state = State::E;
+    }
+
+    line->line_addr = line_addr;
+    line->state = state;
+    line->touched = byte_mask;
+    line->last_use = use_clock;
+    return latency;
+}
+
+// =============================================================================
+// Display
+// =============================================================================
+
+std::string CoherenceModel::hart_list(uint32_t mask) {
+    std::string list;
+    for (int h = 0; h < MAX_HARTS; h++) {
+        if (!(mask & (1u << h))) continue;
+        if (!list.empty()) list += ',';
+        list += std::to_string(h);
+    }
+    return list;
+}
+
+void CoherenceModel::print_config() const {
+    std::cout << "Coherence: MESI directory, " << config.harts << " harts, L1D "
+              << config.size / 1024 << " KB, " << config.assoc << "-way, "
+              << config.line_size << " B lines\n";
+    std::cout << "  Latencies: hit " << config.hit_latency << ", upgrade +" << config.upgrade_latency
+              << ", cache-to-cache +" << config.transfer_latency
+              << ", memory +" << config.memory_latency << "\n";
+}
+
+void CoherenceModel::print_stats() const {
+    std::cout << "  Coherence (MESI, " << config.harts << " harts, "
+              << config.line_size << " B lines):\n";
+    std::cout << std::fixed << std::setprecision(2);
+    for (int h = 0; h < config.harts; h++) {
+        const HartStats& hs = stats[h];
+        std::cout << "    Hart " << h << ": " << hs.accesses << " accesses, " << hs.misses
+                  << " misses";
+        if (hs.accesses > 0) std::cout << " (" << 100.0 * hs.misses / hs.accesses << "%)";
+        std::cout << ", " << hs.upgrades << " upgrades, " << hs.transfers_in
+                  << " from other caches, " << hs.invalidated << " copies invalidated\n";
+    }
+    std::cout << "    Invalidations: " << invalidations << " (false sharing: " << false_sharing << ")\n";
+    std::cout << "    Cache-to-cache transfers: " << transfers
+              << ", memory fetches: " << memory_fetches << ", writebacks: " << writebacks << "\n";
+}
+
+void CoherenceModel::print_hotspots(const std::map<std::string, Address>& symbols,
+                                    size_t count) const {
+    std::vector<std::pair<uint32_t, Hotspot>> spots;
+    for (const auto& entry : hotspots) {
+        if (entry.second.invalidations > 0) spots.push_back(entry);
+    }
+    if (spots.empty()) {
+        std::cout << "  No lines were invalidated\n";
+        return;
+    }
+    std::sort(spots.begin(), spots.end(), [](const auto& a, const auto& b) {
+        if (a.second.false_sharing != b.second.false_sharing) {
+            return a.second.false_sharing > b.second.false_sharing;
+        }
+        if (a.second.invalidations != b.second.invalidations) {
+            return a.second.invalidations > b.second.invalidations;
+        }
+        return a.first < b.first;
+    });
+    if (spots.size() > count) spots.resize(count);
+
+    std::map<Address, std::string> by_addr;
+    for (const auto& [name, addr] : symbols) by_addr.emplace(addr, name);
+
+    std::cout << "  Coherence hotspots (by false-sharing invalidations):\n";
+    std::cout << "    " << std::left << std::setw(12) << "Line" << std::setw(28) << "Symbols"
+              << std::right << std::setw(10) << "Inval" << std::setw(10) << "False"
+              << std::setw(10) << "C2C" << "  Writers -> victims\n";
+    for (const auto& [line_addr, spot] : spots) {
+        Address base = static_cast<Address>(line_addr) << line_shift;
+        Address end = base + config.line_size;
+
+        // Symbol covering the line start, plus any that start inside the line
+        std::string names;
+        auto it = by_addr.upper_bound(base);
+        if (it != by_addr.begin()) {
+            auto prev = std::prev(it);
+            names = prev->second;
+            if (prev->first != base) names += "+" + std::to_string(base - prev->first);
+        }
+        for (; it != by_addr.end() && it->first < end; ++it) {
+            if (!names.empty()) names += ", ";
+            names += it->second;
+        }
+        if (names.empty()) names = "-";
+
+        std::cout << "    " << std::left << std::setw(12) << to_hex(base) << std::setw(28) << names
+                  << std::right << std::setw(10) << spot.invalidations
+                  << std::setw(10) << spot.false_sharing << std::setw(10) << spot.transfers
+                  << "  " << hart_list(spot.writers) << " -> " << hart_list(spot.victims) << "\n";
+    }
+}
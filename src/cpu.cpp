@@ -10,13 +10,24 @@
 
 CPU::CPU(Memory& mem, RegisterFile& regs)
     : mem(mem), regs(regs), pc(Memory::TEXT_BASE),
-      cycles(0), instructions(0), halted(false) {}
+      cycles(0), instructions(0), type_counts{}, halted(false), halt_reason(StopReason::HALTED),
+      exit_code(0), last_mem_addr(0), watch_hit(false), roi_enabled(false), roi_end(0),
+      roi_start_enabled(false), roi_start_armed(false), roi_start(0),
+      timing(nullptr), branch_sweep(nullptr), loops(nullptr) {}
 
 void CPU::reset() {
     pc = Memory::TEXT_BASE;
     cycles = 0;
     instructions = 0;
+    type_counts.fill(0);
     halted = false;
+    halt_reason = StopReason::HALTED;
+    exit_code = 0;
+    watch_hit = false;
+    roi_start_armed = roi_start_enabled;
+    if (timing) timing->reset();
+    if (branch_sweep) branch_sweep->reset();
+    if (loops) loops->reset();
     regs.reset();
 }
 
@@ -77,6 +88,11 @@ Word CPU::memory_access(const Instruction& ins, Word alu_result, Word rs2_val) {
             case InsType::SW: mem.write_word(addr, rs2_val); break;
             default: break;
         }
+        if (!watchpoints.empty()) {
+            for (Address w : watchpoints) {
+                if (addr < w + 4 && addr + access_bytes(ins.type) > w) watch_hit = true;
+            }
+        }
     }
 
     return alu_result;
@@ -87,8 +103,9 @@ Word CPU::memory_access(const Instruction& ins, Word alu_result, Word rs2_val) {
 // =============================================================================
 
 void CPU::writeback(const Instruction& ins, Word result) {
-    if (ins.reg_write && ins.rd != 0) {
-        regs.write(ins.rd, result);
+    // x0 writes land in the register file's sink slot
+    if (ins.reg_write) {
+        regs.write_fast(ins.rd, result);
     }
 }
 
@@ -96,8 +113,8 @@ void CPU::writeback(const Instruction& ins, Word result) {
 // Step (execute one instruction)
 // =============================================================================
 
-bool CPU::step() {
-    if (halted) return false;
+StopReason CPU::step() {
+    if (halted) return halt_reason;
 
     // Fetch
     Word raw = fetch();
@@ -109,14 +126,37 @@ bool CPU::step() {
     // Check for halt (ecall)
     if (ins.type == InsType::ECALL) {
         halted = true;
+        if (regs.read_fast(17) == SYS_EXIT) {
+            halt_reason = StopReason::EXITED;
+            exit_code = regs.read_fast(10);
+        }
+        if (timing) timing->retire({ins, 0, pc + 4, false});
+        if (branch_sweep) branch_sweep->retire(ins, false);
         cycles++;
         instructions++;
-        return false;
+        type_counts[static_cast<int>(ins.type)]++;
+        return halt_reason;
+    }
+
+    // Illegal instruction: stop without executing it
+    if (ins.type == InsType::UNKNOWN) {
+        return StopReason::TRAP;
+    }
+
+    // Breakpoint instruction: stop after it
+    if (ins.type == InsType::EBREAK) {
+        if (timing) timing->retire({ins, 0, pc + 4, false});
+        if (branch_sweep) branch_sweep->retire(ins, false);
+        pc += 4;
+        cycles++;
+        instructions++;
+        type_counts[static_cast<int>(ins.type)]++;
+        return StopReason::TRAP;
     }
 
     // Read registers
-    Word rs1_val = regs.read(ins.rs1);
-    Word rs2_val = regs.read(ins.rs2);
+    Word rs1_val = regs.read_fast(ins.rs1);
+    Word rs2_val = regs.read_fast(ins.rs2);
 
     // Execute
     Word alu_result = execute(ins, rs1_val, rs2_val);
@@ -132,38 +172,85 @@ bool CPU::step() {
             next_pc = (rs1_val + ins.imm) & ~1;  // Clear LSB
             alu_result = pc + 4;  // Return address
         }
+        if (loops) loops->edge(ins, next_pc, {instructions, cycles});
     } else if (ins.branch) {
         if (ALU::branch_taken(ins.type, rs1_val, rs2_val)) {
             next_pc = pc + ins.imm;
+            if (loops) loops->edge(ins, next_pc, {instructions, cycles});
         }
     }
 
     // Memory
     Word mem_result = memory_access(ins, alu_result, rs2_val);
+    last_mem_addr = alu_result;
 
     // Writeback
     Word wb_result = ins.mem_to_reg ? mem_result : alu_result;
     writeback(ins, wb_result);
 
+    if (timing) timing->retire({ins, alu_result, next_pc, next_pc != pc + 4});
+    if (branch_sweep) branch_sweep->retire(ins, next_pc != pc + 4);
+
     // Update PC
     pc = next_pc;
     cycles++;
     instructions++;
+    type_counts[static_cast<int>(ins.type)]++;
 
-    // Check breakpoint
-    if (has_breakpoint(pc)) {
-        return false;
+    // Check watchpoints, region of interest and breakpoints
+    if (watch_hit) {
+        watch_hit = false;
+        return StopReason::WATCHPOINT;
+    }
+    if (roi_start_armed && pc == roi_start) {
+        roi_start_armed = false;
+        return StopReason::ROI_START;
+    }
+    if (roi_enabled && pc == roi_end) {
+        return StopReason::ROI_END;
+    }
+    if (!breakpoints.empty() && has_breakpoint(pc)) {
+        return StopReason::BREAKPOINT;
     }
 
-    return true;
+    return StopReason::NONE;
 }
 
 // =============================================================================
 // Run
 // =============================================================================
 
-void CPU::run() {
-    while (step()) {}
+StopReason CPU::run(uint64_t max_steps) {
+    watchdog.start(limits, instructions, cycles);
+    for (uint64_t i = 0; i < max_steps; i++) {
+        StopReason reason = step();
+        if (reason == StopReason::NONE) reason = watchdog.tick(instructions, cycles);
+        if (reason != StopReason::NONE) return reason;
+    }
+    return StopReason::NONE;
+}
+
+StopReason CPU::run_until(Predicate& pred) {
+    watchdog.start(limits, instructions, cycles);
+    pred.invalidate();
+    while (true) {
+        StopReason reason = step();
+        pred.observe(last_ins.reg_write ? last_ins.rd : 0, last_ins.mem_write, last_mem_addr);
+        if (pred.test(predicate_state())) return StopReason::CONDITION;
+        if (reason == StopReason::NONE) reason = watchdog.tick(instructions, cycles);
+        if (reason != StopReason::NONE) return reason;
+    }
+}
+
+void CPU::set_limits(const RunLimits& run_limits) { limits = run_limits; }
+const RunLimits& CPU::get_limits() const { return limits; }
+
+void CPU::set_sampling(uint64_t period, bool by_cycles, std::function<void()> sample) {
+    watchdog.set_sampling(period, by_cycles, std::move(sample));
+}
+
+Predicate::State CPU::predicate_state() const {
+    return {pc, cycles, instructions, regs, mem};
 }
 
 // =============================================================================
@@ -174,7 +261,19 @@ Address CPU::get_pc() const { return pc; }
 void CPU::set_pc(Address addr) { pc = addr; }
 uint64_t CPU::get_cycle_count() const { return cycles; }
 uint64_t CPU::get_instruction_count() const { return instructions; }
+
+void CPU::register_stats(StatsRegistry& stats, const std::string& prefix) const {
+    stats.add_counter(prefix + ".cycles", &cycles, "Cycles (one per instruction)");
+    stats.add_counter(prefix + ".instructions", &instructions, "Instructions retired");
+    for (int c = 0; c < NUM_INS_CLASSES; c++) {
+        InsClass cls = static_cast<InsClass>(c);
+        stats.add_computed(prefix + ".mix." + ins_class_name(cls),
+                           [this, cls] { return class_count(type_counts, cls); },
+                           std::string("Retired ") + ins_class_name(cls) + " instructions");
+    }
+}
 bool CPU::is_halted() const { return halted; }
+Word CPU::get_exit_code() const { return exit_code; }
 const Instruction& CPU::get_last_instruction() const { return last_ins; }
 
 // =============================================================================
@@ -201,3 +300,60 @@ void CPU::clear_breakpoints() {
 bool CPU::has_breakpoint(Address addr) const {
     return std::find(breakpoints.begin(), breakpoints.end(), addr) != breakpoints.end();
 }
+
+// =============================================================================
+// Watchpoints and Region of Interest
+// =============================================================================
+
+void CPU::add_watchpoint(Address addr) {
+    if (std::find(watchpoints.begin(), watchpoints.end(), addr) == watchpoints.end()) {
+        watchpoints.push_back(addr);
+    }
+}
+
+void CPU::clear_watchpoints() {
+    watchpoints.clear();
+    watch_hit = false;
+}
+
+void CPU::set_roi_end(Address addr) {
+    roi_enabled = true;
+    roi_end = addr;
+}
+
+void CPU::clear_roi_end() {
+    roi_enabled = false;
+}
+
+void CPU::set_roi_start(Address addr) {
+    roi_start_enabled = true;
+    roi_start_armed = true;
+    roi_start = addr;
+}
+
+void CPU::clear_roi_start() {
+    roi_start_enabled = false;
+    roi_start_armed = false;
+}
+
+// =============================================================================
+// Timing Model
+// =============================================================================
+
+void CPU::set_timing_model(TimingModel* model) {
+    timing = model;
+    if (timing) timing->reset();
+}
+
+void CPU::set_loop_profiler(LoopProfiler* profiler) {
+    loops = profiler;
+    if (loops) {
+        loops->reset();
+        loops->set_timed(false);
+    }
+}
+
+void CPU::set_branch_sweep(BranchSweep* sweep) {
+    branch_sweep = sweep;
+    if (branch_sweep) branch_sweep->reset();
+}
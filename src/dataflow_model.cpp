@@ -0,0 +1,268 @@
+/**
+ * dataflow_model.cpp
+ *
+ * Dataflow-limit (ideal IPC) and dependency distance analysis.
+ */
+
+#include "dataflow_model.hpp"
+#include <algorithm>
+
+DataflowModel::DataflowModel() : DataflowModel(Config()) {}
+
+DataflowModel::DataflowModel(const Config& cfg) {
+    set_config(cfg);
+}
+
+void DataflowModel::set_config(const Config& cfg) {
+    config = cfg;
+    config.alu_latency = std::max(config.alu_latency, 1);
+    config.mul_latency = std::max(config.mul_latency, 1);
+    config.div_latency = std::max(config.div_latency, 1);
+    config.load_latency = std::max(config.load_latency, 1);
+    config.store_latency = std::max(config.store_latency, 1);
+
+    // Finite windows ascending, then the unbounded one
+    std::vector<int>& sizes = config.windows;
+    for (int& size : sizes) size = std::clamp(size, 0, MAX_WINDOW);
+    if (sizes.empty()) sizes = Config().windows;
+    std::sort(sizes.begin(), sizes.end(), [](int a, int b) {
+        return a != 0 && (b == 0 || a < b);
+    });
+    sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+    if (sizes.size() > MAX_WINDOWS) sizes.erase(sizes.begin(), sizes.end() - MAX_WINDOWS);
+
+    reset();
+}
+
+const DataflowModel::Config& DataflowModel::get_config() const { return config; }
+
+const char* DataflowModel::name() const { return "dataflow"; }
+
+void DataflowModel::reset() {
+    windows.clear();
+    for (int size : config.windows) {
+        Window w;
+        w.size = size;
+        w.reg_ready.fill(0);
+        w.retired.assign(size, 0);
+        w.critical_path = 0;
+        windows.push_back(std::move(w));
+    }
+
+    instructions = 0;
+    reg_writer.fill(0);
+    reg_loaded.fill(false);
+    reg_distance.fill(0);
+    mem_distance.fill(0);
+    reg_operands = 0;
+    mem_operands = 0;
+    stalls_forwarding = 0;
+    stalls_no_forwarding = 0;
+}
+
+// =============================================================================
+// Helpers
+// =============================================================================
+
+int DataflowModel::latency(const Instruction& ins) const {
+    switch (ins.type) {
+        case InsType::MUL: case InsType::MULH: case InsType::MULHSU: case InsType::MULHU:
+            return config.mul_latency;
+        case InsType::DIV: case InsType::DIVU: case InsType::REM: case InsType::REMU:
+            return config.div_latency;
+        default:
+            break;
+    }
+    if (ins.mem_read) return config.load_latency;
+    if (ins.mem_write) return config.store_latency;
+    return config.alu_latency;
+}
+
+void DataflowModel::expire_stores(Window& w, uint64_t seq) const {
+    // A store W or more instructions back has retired before this one
+    // can enter the window, so it can no longer delay a load
+    while (!w.store_order.empty()) {
+        auto [word, store_seq] = w.store_order.front();
+        bool old = w.size > 0 ? store_seq + w.size <= seq
+                              : w.store_order.size() > STORE_HISTORY;
+        if (!old) break;
+        auto it = w.stores.find(word);
+        if (it != w.stores.end() && it->second.seq == store_seq) w.stores.erase(it);
+        w.store_order.pop_front();
+    }
+}
+
+int DataflowModel::distance_bucket(uint64_t distance) {
+    if (distance <= 4) return static_cast<int>(distance) - 1;
+    int bucket = 4;
+    for (uint64_t limit = 8; distance > limit && bucket < DISTANCE_BUCKETS - 1; limit *= 2) bucket++;
+    return bucket;
+}
+
+std::string DataflowModel::window_name(int size) {
+    return size == 0 ? "unbounded" : std::to_string(size);
+}
+
+// =============================================================================
+// Retire
+// =============================================================================
+
+void DataflowModel::retire(const RetiredInsn& r) {
+    const Instruction& ins = r.ins;
+    const uint64_t seq = instructions++;
+    const uint64_t lat = latency(ins);
+
+    // Aligned words touched by the access (two if it straddles)
+    Address words[2];
+    int word_count = 0;
+    if (ins.mem_read || ins.mem_write) {
+        words[word_count++] = r.mem_addr & ~3u;
+        Address last = (r.mem_addr + access_bytes(ins.type) - 1) & ~3u;
+        if (last != words[0]) words[word_count++] = last;
+    }
+
+    // Register RAW distances and the 5-stage interlock estimate: without
+    // forwarding a consumer 1 or 2 behind waits for WB; with it only a
+    // load right before its consumer costs a cycle
+    uint64_t nearest = 0;
+    bool nearest_load = false;
+    auto note_operand = [&](bool reads, int rs) {
+        if (!reads || rs == 0 || reg_writer[rs] == 0) return;
+        uint64_t distance = seq + 1 - reg_writer[rs];
+        reg_distance[distance_bucket(distance)]++;
+        reg_operands++;
+        if (nearest == 0 || distance < nearest) {
+            nearest = distance;
+            nearest_load = reg_loaded[rs];
+        } else if (distance == nearest) {
+            nearest_load = nearest_load || reg_loaded[rs];
+        }
+    };
+    note_operand(ins.reads_rs1, ins.rs1);
+    note_operand(ins.reads_rs2, ins.rs2);
+    if (nearest == 1 || nearest == 2) stalls_no_forwarding += 3 - nearest;
+    if (nearest == 1 && nearest_load) stalls_forwarding++;
+
+    // Memory RAW distance, from the longest store history
+    if (ins.mem_read) {
+        Window& longest = windows.back();
+        expire_stores(longest, seq);
+        uint64_t producer = 0;
+        for (int i = 0; i < word_count; i++) {
+            auto it = longest.stores.find(words[i]);
+            if (it != longest.stores.end()) producer = std::max(producer, it->second.seq + 1);
+        }
+        if (producer > 0) {
+            mem_distance[distance_bucket(seq + 1 - producer)]++;
+            mem_operands++;
+        }
+    }
+
+    for (Window& w : windows) {
+        uint64_t start = 0;
+        if (ins.reads_rs1) start = std::max(start, w.reg_ready[ins.rs1]);
+        if (ins.reads_rs2) start = std::max(start, w.reg_ready[ins.rs2]);
+        if (w.size > 0 && seq >= static_cast<uint64_t>(w.size)) {
+            start = std::max(start, w.retired[seq % w.size]);
+        }
+        if (word_count > 0) {
+            expire_stores(w, seq);
+            if (ins.mem_read) {
+                for (int i = 0; i < word_count; i++) {
+                    auto it = w.stores.find(words[i]);
+                    if (it != w.stores.end()) start = std::max(start, it->second.ready);
+                }
+            }
+        }
+
+        uint64_t done = start + lat;
+        if (ins.writes_rd) w.reg_ready[ins.rd] = done;
+        if (ins.mem_write) {
+            for (int i = 0; i < word_count; i++) {
+                w.stores[words[i]] = {seq, done};
+                w.store_order.emplace_back(words[i], seq);
+            }
+        }
+
+        // In-order retirement: the latest completion so far
+        w.critical_path = std::max(w.critical_path, done);
+        if (w.size > 0) w.retired[seq % w.size] = w.critical_path;
+    }
+
+    if (ins.writes_rd) {
+        reg_writer[ins.rd] = seq + 1;
+        reg_loaded[ins.rd] = ins.mem_read;
+    }
+}
+
+uint64_t DataflowModel::get_cycle_count() const { return windows.back().critical_path; }
+uint64_t DataflowModel::get_instruction_count() const { return instructions; }
+
+// =============================================================================
+// Display
+// =============================================================================
+
+void DataflowModel::print_config() const {
+    std::cout << "Dataflow limit: windows";
+    for (const Window& w : windows) std::cout << " " << window_name(w.size);
+    std::cout << "\n  Latencies: ALU " << config.alu_latency << ", mul " << config.mul_latency
+              << ", div " << config.div_latency << ", load " << config.load_latency
+              << ", store " << config.store_latency
+              << " (perfect branch prediction, unlimited units)\n";
+}
+
+void DataflowModel::register_stats(StatsRegistry& stats, const std::string& prefix) const {
+    TimingModel::register_stats(stats, prefix);
+    const std::vector<std::string> labels = {
+        "1", "2", "3", "4", "5-8", "9-16", "17-32", "33-64", "65+"
+    };
+    stats.add_histogram(prefix + ".reg_distance", reg_distance.data(), labels,
+                        "Register operands by RAW distance");
+    stats.add_histogram(prefix + ".mem_distance", mem_distance.data(), labels,
+                        "Loads by distance from the store they read");
+    stats.add_counter(prefix + ".stalls_forwarding", &stalls_forwarding,
+                      "Estimated 5-stage stalls with forwarding");
+    stats.add_counter(prefix + ".stalls_no_forwarding", &stalls_no_forwarding,
+                      "Estimated 5-stage stalls without forwarding");
+}
+
+void DataflowModel::print_stats() const {
+    std::cout << "  Dataflow limit (" << instructions << " instructions):\n";
+    std::cout << "    " << std::left << std::setw(12) << "Window" << std::right
+              << std::setw(14) << "Cycles" << std::setw(10) << "IPC" << "\n";
+    std::cout << std::fixed << std::setprecision(2);
+    for (const Window& w : windows) {
+        double ipc = w.critical_path ? static_cast<double>(instructions) / w.critical_path : 0.0;
+        std::cout << "    " << std::left << std::setw(12) << window_name(w.size) << std::right
+                  << std::setw(14) << w.critical_path << std::setw(10) << ipc << "\n";
+    }
+
+    if (reg_operands == 0 && mem_operands == 0) return;
+
+    static const char* bucket_names[DISTANCE_BUCKETS] = {
+        "1", "2", "3", "4", "5-8", "9-16", "17-32", "33-64", "65+"
+    };
+    auto percent = [](uint64_t n, uint64_t total) {
+        return total ? 100.0 * n / total : 0.0;
+    };
+
+    std::cout << "    RAW dependency distance (instructions from producer):\n";
+    std::cout << "      " << std::left << std::setw(10) << "Distance" << std::right
+              << std::setw(20) << "Register operands" << std::setw(20) << "Memory (loads)" << "\n";
+    std::cout << std::setprecision(1);
+    for (int b = 0; b < DISTANCE_BUCKETS; b++) {
+        std::ostringstream reg_cell, mem_cell;
+        reg_cell << std::fixed << std::setprecision(1) << reg_distance[b]
+                 << " (" << percent(reg_distance[b], reg_operands) << "%)";
+        mem_cell << std::fixed << std::setprecision(1) << mem_distance[b]
+                 << " (" << percent(mem_distance[b], mem_operands) << "%)";
+        std::cout << "      " << std::left << std::setw(10) << bucket_names[b] << std::right
+                  << std::setw(20) << reg_cell.str() << std::setw(20) << mem_cell.str() << "\n";
+    }
+
+    uint64_t close = reg_distance[0] + reg_distance[1];
+    std::cout << "    Register operands at distance 1-2 (need forwarding in a 5-stage pipe): "
+              << close << " (" << percent(close, reg_operands) << "%)\n";
+    std::cout << "    5-stage interlock estimate: " << stalls_no_forwarding
+              << " stall cycles without forwarding, " << stalls_forwarding << " with\n";
+}
@@ -63,56 +63,49 @@ SignedWord Decoder::imm_j(Word raw) {
 // =============================================================================
 
 std::string Decoder::disassemble(const Instruction& ins) {
-    std::ostringstream oss;
-    std::string name = ins_name(ins.type);
+    // Built with string appends rather than a stringstream: this runs
+    // on every decode, so it is on the hot path of stepping and tracing
+    std::string out = ins_name(ins.type);
+    std::string imm = std::to_string(ins.imm);
 
     switch (ins.format) {
         case Format::R:
-            oss << name << " " << reg_name(ins.rd) << ", "
-                << reg_name(ins.rs1) << ", " << reg_name(ins.rs2);
+            out += " " + reg_name(ins.rd) + ", " + reg_name(ins.rs1) + ", " + reg_name(ins.rs2);
             break;
 
         case Format::I:
             if (ins.mem_read) {
                 // Load: lw rd, offset(rs1)
-                oss << name << " " << reg_name(ins.rd) << ", "
-                    << ins.imm << "(" << reg_name(ins.rs1) << ")";
-            } else if (ins.type == InsType::JALR) {
-                oss << name << " " << reg_name(ins.rd) << ", "
-                    << reg_name(ins.rs1) << ", " << ins.imm;
+                out += " " + reg_name(ins.rd) + ", " + imm + "(" + reg_name(ins.rs1) + ")";
             } else if (ins.type == InsType::ECALL || ins.type == InsType::EBREAK) {
-                oss << name;
+                // No operands
             } else {
-                oss << name << " " << reg_name(ins.rd) << ", "
-                    << reg_name(ins.rs1) << ", " << ins.imm;
+                out += " " + reg_name(ins.rd) + ", " + reg_name(ins.rs1) + ", " + imm;
             }
             break;
 
         case Format::S:
-            oss << name << " " << reg_name(ins.rs2) << ", "
-                << ins.imm << "(" << reg_name(ins.rs1) << ")";
+            out += " " + reg_name(ins.rs2) + ", " + imm + "(" + reg_name(ins.rs1) + ")";
             break;
 
         case Format::B:
-            oss << name << " " << reg_name(ins.rs1) << ", "
-                << reg_name(ins.rs2) << ", " << ins.imm;
+            out += " " + reg_name(ins.rs1) + ", " + reg_name(ins.rs2) + ", " + imm;
             break;
 
         case Format::U:
-            oss << name << " " << reg_name(ins.rd) << ", "
-                << to_hex((static_cast<Word>(ins.imm) >> 12) & 0xFFFFF, 5);
+            out += " " + reg_name(ins.rd) + ", " + to_hex((static_cast<Word>(ins.imm) >> 12) & 0xFFFFF, 5);
             break;
 
         case Format::J:
-            oss << name << " " << reg_name(ins.rd) << ", " << ins.imm;
+            out += " " + reg_name(ins.rd) + ", " + imm;
             break;
 
         default:
-            oss << "unknown";
+            out = "unknown";
             break;
     }
 
-    return oss.str();
+    return out;
 }
 
 // =============================================================================
@@ -175,6 +168,7 @@ Instruction Decoder::decode(Word raw, Address pc) {
             ins.format = Format::I;
             ins.imm = imm_i(raw);
             ins.reg_write = true;
+            ins.reads_rs1 = true;
             ins.jump = true;
             ins.alu_src = true;
             ins.alu_op = AluOp::ADD;
@@ -187,6 +181,8 @@ Instruction Decoder::decode(Word raw, Address pc) {
             ins.format = Format::B;
             ins.imm = imm_b(raw);
             ins.branch = true;
+            ins.reads_rs1 = true;
+            ins.reads_rs2 = true;
             switch (funct3) {
                 case 0b000: ins.type = InsType::BEQ; break;
                 case 0b001: ins.type = InsType::BNE; break;
@@ -207,6 +203,7 @@ Instruction Decoder::decode(Word raw, Address pc) {
             ins.reg_write = true;
             ins.mem_read = true;
             ins.mem_to_reg = true;
+            ins.reads_rs1 = true;
             ins.alu_src = true;
             ins.alu_op = AluOp::ADD;
             switch (funct3) {
@@ -226,6 +223,8 @@ Instruction Decoder::decode(Word raw, Address pc) {
             ins.format = Format::S;
             ins.imm = imm_s(raw);
             ins.mem_write = true;
+            ins.reads_rs1 = true;
+            ins.reads_rs2 = true;
             ins.alu_src = true;
             ins.alu_op = AluOp::ADD;
             switch (funct3) {
@@ -243,6 +242,7 @@ Instruction Decoder::decode(Word raw, Address pc) {
             ins.format = Format::I;
             ins.imm = imm_i(raw);
             ins.reg_write = true;
+            ins.reads_rs1 = true;
             ins.alu_src = true;
             switch (funct3) {
                 case 0b000:
@@ -296,6 +296,8 @@ Instruction Decoder::decode(Word raw, Address pc) {
         case OP_REG:
             ins.format = Format::R;
             ins.reg_write = true;
+            ins.reads_rs1 = true;
+            ins.reads_rs2 = true;
             ins.imm = 0;
 
             if (funct7 == 0x01) {
@@ -364,6 +366,7 @@ Instruction Decoder::decode(Word raw, Address pc) {
             break;
     }
 
+    ins.writes_rd = ins.reg_write && ins.rd != 0;
     ins.text = disassemble(ins);
     return ins;
 }
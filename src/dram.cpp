@@ -0,0 +1,117 @@
+/**
+ * dram.cpp
+ *
+ * DRAM bank and row-buffer timing implementation.
+ */
+
+#include "dram.hpp"
+#include <algorithm>
+
+Dram::Dram(const Config& config) {
+    configure(config);
+}
+
+bool Dram::validate(const Config& cfg, std::string& error) {
+    if (cfg.banks < 1) {
+        error = "bank count must be at least 1";
+        return false;
+    }
+    if (cfg.row_size < 64) {
+        error = "row size must be at least 64 bytes";
+        return false;
+    }
+    if (cfg.t_rcd < 0 || cfg.t_cl < 1 || cfg.t_rp < 0 || cfg.bus_latency < 0) {
+        error = "timings must be non-negative (tCL at least 1)";
+        return false;
+    }
+    return true;
+}
+
+void Dram::configure(const Config& cfg) {
+    config = cfg;
+    reset();
+}
+
+const Dram::Config& Dram::get_config() const { return config; }
+
+void Dram::reset() {
+    banks.assign(config.banks, Bank());
+    accesses = 0;
+    row_hits = 0;
+    row_empty = 0;
+    row_conflicts = 0;
+    queue_cycles = 0;
+    total_latency = 0;
+}
+
+// =============================================================================
+// Access
+// =============================================================================
+
+int Dram::access(Address addr, bool write, uint64_t now) {
+    (void)write;
+
+    // Consecutive rows interleave across banks
+    uint32_t row_index = addr / config.row_size;
+    Bank& bank = banks[row_index % config.banks];
+    uint32_t row = row_index / config.banks;
+
+    accesses++;
+
+    int latency;
+    if (bank.open && bank.row == row) {
+        row_hits++;
+        latency = config.t_cl;
+    } else if (!bank.open) {
+        row_empty++;
+        latency = config.t_rcd + config.t_cl;
+    } else {
+        row_conflicts++;
+        latency = config.t_rp + config.t_rcd + config.t_cl;
+    }
+
+    // Open-page policy: the row stays open for the next access
+    bank.open = true;
+    bank.row = row;
+
+    uint64_t start = std::max(now, bank.ready);
+    queue_cycles += start - now;
+    bank.ready = start + latency;
+
+    int total = static_cast<int>(start - now) + latency + config.bus_latency;
+    total_latency += total;
+    return total;
+}
+
+// =============================================================================
+// Display
+// =============================================================================
+
+void Dram::print_config() const {
+    std::cout << "  DRAM: " << config.banks << " banks, " << config.row_size
+              << " B rows, tRCD " << config.t_rcd << ", tCL " << config.t_cl
+              << ", tRP " << config.t_rp << ", bus " << config.bus_latency << "\n";
+}
+
+void Dram::register_stats(StatsRegistry& stats, const std::string& prefix) const {
+    stats.add_counter(prefix + ".accesses", &accesses, "Accesses");
+    stats.add_counter(prefix + ".row_hits", &row_hits, "Open-row hits");
+    stats.add_counter(prefix + ".row_empty", &row_empty, "Accesses to a closed bank");
+    stats.add_counter(prefix + ".row_conflicts", &row_conflicts, "Accesses that closed another row");
+    stats.add_counter(prefix + ".queue_cycles", &queue_cycles, "Cycles waiting for a busy bank");
+    stats.add_counter(prefix + ".total_latency", &total_latency, "Cycles over all accesses");
+    stats.add_formula(prefix + ".avg_latency", [prefix](const StatsRegistry& s) {
+        return s.ratio(prefix + ".total_latency", prefix + ".accesses");
+    }, "Cycles per access");
+}
+
+void Dram::print_stats() const {
+    std::cout << "    DRAM: " << accesses << " accesses, row hits " << row_hits
+              << ", row empty " << row_empty << ", row conflicts " << row_conflicts;
+    if (accesses > 0) {
+        std::cout << std::fixed << std::setprecision(2)
+                  << ", avg latency " << static_cast<double>(total_latency) / accesses
+                  << ", queued " << queue_cycles << " cycles";
+    }
+    std::cout << "\n";
+}
@@ -6,12 +6,25 @@
 
 #include "emulator.hpp"
 #include "decoder.hpp"
+#include "inorder_model.hpp"
+#include "ooo_model.hpp"
+#include "dataflow_model.hpp"
+#include "block_analyzer.hpp"
 #include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <sstream>
 
 Emulator::Emulator()
-    : cpu(mem, regs), pipeline(mem, regs),
-      mode(Mode::SINGLE_CYCLE), running(true), program_loaded(false) {}
+    : cpu(mem, regs), pipeline(mem, regs), smp(mem),
+      mode(Mode::SINGLE_CYCLE), running(true), program_loaded(false), script_depth(0) {
+    pipeline.set_memory_hierarchy(&caches);
+
+    cpu.register_stats(stats, "cpu");
+    pipeline.register_stats(stats, "pipeline");
+    mem.register_stats(stats, "memory");
+    caches.register_stats(stats, "caches");
+}
 
 // =============================================================================
 // Program Loading
@@ -29,10 +42,14 @@ bool Emulator::load(const std::string& filename) {
     }
 
     // Reset state
+    if (miss_profiler) miss_profiler->configure(asm_result);
     mem.reset();
     regs.reset();
+    caches.reset();
     cpu.reset();
     pipeline.reset();
+    stats.reset();
+    if (sampler) sampler->restart();
 
     // Load text segment
     mem.write_block(asm_result.text_addr, asm_result.text);
@@ -62,10 +79,14 @@ bool Emulator::load_source(const std::string& source) {
         return false;
     }
 
+    if (miss_profiler) miss_profiler->configure(asm_result);
     mem.reset();
     regs.reset();
+    caches.reset();
     cpu.reset();
     pipeline.reset();
+    stats.reset();
+    if (sampler) sampler->restart();
 
     mem.write_block(asm_result.text_addr, asm_result.text);
     mem.write_bytes(asm_result.data_addr, asm_result.data);
@@ -82,6 +103,9 @@ bool Emulator::load_source(const std::string& source) {
 void Emulator::run() {
     print_welcome();
 
+    // Ctrl-C stops a running program instead of the emulator
+    Watchdog::install_interrupt_handler();
+
     std::string input;
     while (running) {
         print_prompt();
@@ -92,6 +116,33 @@ void Emulator::run() {
     std::cout << "Goodbye!\n";
 }
 
+bool Emulator::run_script(const std::string& filename) {
+    static constexpr int MAX_SCRIPT_DEPTH = 16;
+    if (script_depth >= MAX_SCRIPT_DEPTH) {
+        std::cout << "Scripts nested too deeply: " << filename << "\n";
+        return true;
+    }
+
+    std::ifstream file(filename);
+    if (!file) {
+        std::cout << "Cannot open script: " << filename << "\n";
+        return true;
+    }
+
+    script_depth++;
+    bool cont = true;
+    std::string line;
+    while (cont && std::getline(file, line)) {
+        // Strip comments
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        cont = execute_command(line);
+    }
+    script_depth--;
+
+    return cont;
+}
+
 bool Emulator::execute_command(const std::string& input) {
     auto tokens = tokenize(input);
     if (tokens.empty()) return true;
@@ -113,15 +164,56 @@ bool Emulator::execute_command(const std::string& input) {
             cmd_load(tokens[1]);
         }
     }
-    else if (cmd == "run" || cmd == "r") {
-        cmd_run();
+    else if (cmd == "source") {
+        if (tokens.size() < 2) {
+            std::cout << "Usage: source <file>\n";
+        } else {
+            return run_script(tokens[1]);
+        }
+    }
+    else if (cmd == "repeat") {
+        return cmd_repeat(tokens);
+    }
+    else if (cmd == "if") {
+        return cmd_if(tokens);
+    }
+    else if (cmd == "run" || cmd == "r" || cmd == "until") {
+        size_t expr_start = (cmd == "until") ? 1 : 2;
+        if (cmd == "until" || (tokens.size() > 1 && tokens[1] == "until")) {
+            Predicate pred;
+            if (tokens.size() <= expr_start) {
+                std::cout << "Usage: run until <expr>\n";
+            } else if (compile_predicate(join(tokens, expr_start, tokens.size()), pred)) {
+                cmd_run(&pred);
+            }
+        } else {
+            cmd_run();
+        }
     }
     else if (cmd == "step" || cmd == "s") {
         int count = 1;
-        if (tokens.size() > 1) {
-            try { count = std::stoi(tokens[1]); } catch (...) {}
+        bool has_count = false;
+        bool quiet = false;
+        std::string filename;
+        Predicate pred;
+        bool has_until = false;
+        for (size_t i = 1; i < tokens.size(); i++) {
+            if (tokens[i] == "until") {
+                if (!compile_predicate(join(tokens, i + 1, tokens.size()), pred)) return true;
+                has_until = true;
+                break;
+            } else if (tokens[i] == "quiet" || tokens[i] == "q") {
+                quiet = true;
+            } else if (tokens[i] == ">" && i + 1 < tokens.size()) {
+                filename = tokens[++i];
+            } else if (tokens[i][0] == '>') {
+                filename = tokens[i].substr(1);
+            } else {
+                try { count = std::stoi(tokens[i]); has_count = true; } catch (...) {}
+            }
         }
-        cmd_step(count);
+        if (has_until && !has_count) count = std::numeric_limits<int>::max();
+        cmd_step(count, quiet, filename, has_until ? &pred : nullptr);
     }
     else if (cmd == "reset") {
         cmd_reset();
@@ -177,6 +269,19 @@ bool Emulator::execute_command(const std::string& input) {
             cmd_forward(tokens[1]);
         }
     }
+    else if (cmd == "cache" || cmd == "caches") {
+        cmd_cache(tokens);
+    }
+    else if (cmd == "storebuf" || cmd == "sb") {
+        cmd_storebuf(tokens);
+    }
+    else if (cmd == "resolve") {
+        if (tokens.size() < 2) {
+            std::cout << "Branch resolution: " << branch_stage_name(pipeline.get_branch_stage()) << "\n";
+        } else {
+            cmd_resolve(tokens[1]);
+        }
+    }
     else if (cmd == "break" || cmd == "b") {
         if (tokens.size() < 2) {
             cmd_breakpoints();
@@ -184,6 +289,20 @@ bool Emulator::execute_command(const std::string& input) {
             cmd_break(tokens[1]);
         }
     }
+    else if (cmd == "watch" || cmd == "w") {
+        if (tokens.size() < 2) {
+            std::cout << "Usage: watch <addr>\n";
+        } else {
+            cmd_watch(tokens[1]);
+        }
+    }
+    else if (cmd == "roi") {
+        if (tokens.size() < 2) {
+            std::cout << "Usage: roi [start|end] <addr> | roi off\n";
+        } else {
+            cmd_roi(tokens);
+        }
+    }
     else if (cmd == "clear") {
         cmd_clear();
     }
@@ -203,7 +322,37 @@ bool Emulator::execute_command(const std::string& input) {
         cmd_pipeline();
     }
     else if (cmd == "stats") {
-        cmd_stats();
+        cmd_stats(tokens);
+    }
+    else if (cmd == "sample") {
+        cmd_sample(tokens);
+    }
+    else if (cmd == "loops") {
+        cmd_loops(tokens);
+    }
+    else if (cmd == "misses") {
+        cmd_misses(tokens);
+    }
+    else if (cmd == "limit" || cmd == "limits") {
+        cmd_limit(tokens);
+    }
+    else if (cmd == "timing") {
+        cmd_timing(tokens);
+    }
+    else if (cmd == "bpsweep") {
+        cmd_bpsweep(tokens);
+    }
+    else if (cmd == "smp") {
+        cmd_smp(tokens);
+    }
+    else if (cmd == "batch") {
+        cmd_batch(tokens);
+    }
+    else if (cmd == "analyze") {
+        cmd_analyze(tokens);
+    }
+    else if (cmd == "validate") {
+        cmd_validate(tokens);
     }
     else {
         std::cout << "Unknown command: " << cmd << ". Type 'help' for commands.\n";
@@ -219,8 +368,13 @@ bool Emulator::execute_command(const std::string& input) {
 void Emulator::cmd_help() {
     std::cout << "Commands:\n"
               << "  load <file>       Load assembly file\n"
-              << "  run               Run until halt or breakpoint\n"
+              << "  run               Run until halt, breakpoint, limit or Ctrl-C\n"
               << "  step [n]          Execute n instructions (default 1)\n"
+              << "  step n quiet      Execute n instructions, print summary only\n"
+              << "  step n > <file>   Execute n instructions, write trace to file\n"
+              << "  run until <expr>  Run until expression is true (e.g. 'a0 < 0')\n"
+              << "  until <expr>      Same as 'run until'\n"
+              << "  step until <expr> Step (with trace) until expression is true\n"
               << "  reset             Reset CPU state\n"
               << "  regs              Show all registers\n"
               << "  reg <name>        Show single register\n"
@@ -229,62 +383,162 @@ void Emulator::cmd_help() {
               << "  mode <s|p>        Set single-cycle or pipeline mode\n"
               << "  hazards <on|off>  Toggle hazard detection\n"
               << "  forward <on|off>  Toggle forwarding\n"
+              << "  resolve <id|ex|mem>  Pipeline stage that resolves branches\n"
+              << "  cache [on|off|load <file>]  Show or configure L1I/L1D/L2/DRAM timing\n"
+              << "  cache prefetch <l1i|l1d> <none|nextline|stride|stream> [degree n] [distance n]\n"
+              << "                    Attach a hardware prefetcher to an L1 cache\n"
+              << "  storebuf <n|off> [drain <cycles>] [policy eager|idle|lazy]\n"
+              << "                    Configure the pipeline store buffer\n"
               << "  break <addr>      Set breakpoint\n"
-              << "  clear             Clear all breakpoints\n"
+              << "  watch <addr>      Stop after a store to the word at addr\n"
+              << "  roi <end|off>     Stop when execution reaches end of region of interest\n"
+              << "  roi start <addr>  Reset statistics when execution first reaches addr\n"
+              << "  clear             Clear all breakpoints and watchpoints\n"
               << "  symbols           Show symbol table\n"
               << "  disasm [addr] [n] Disassemble instructions\n"
               << "  pipeline          Show pipeline state\n"
               << "  stats             Show statistics\n"
-              << "  quit              Exit emulator\n";
+              << "  stats <text|json|csv> [prefix] [> file]\n"
+              << "                    Dump named statistics (since load or 'stats reset')\n"
+              << "  stats reset       Count statistics from here\n"
+              << "  sample <n> [insns|cycles] [> file]\n"
+              << "                    Write IPC, stall, miss rates and mix every n as CSV rows\n"
+              << "  sample off        Write the last partial interval and stop sampling\n"
+              << "  loops [on|off]    Profile loops: trip counts, insns and (pipeline) cycles per iteration\n"
+              << "  misses [on|off]   Attribute L1D misses to loads/stores and data symbols\n"
+              << "  misses [top <n>] [sort misses|stalls]  Show the delinquent loads and data objects\n"
+              << "  limit [insns|cycles|time <n>|off]  Show or set per-run limits\n"
+              << "  timing inorder [width <n>] [forward on|off] [resolve id|ex|mem]\n"
+              << "         [fetch|decode|mem <stages>] [alu|mul|div <latency>]\n"
+              << "                    Attach in-order superscalar timing model (single-cycle;\n"
+              << "                    stages and latencies only in 'mode s', Pipeline stays 5-stage)\n"
+              << "  timing ooo [width|rob|iq|regs|lq|sq|alu|branch|mul|mem|frontend <n>]...\n"
+              << "                    Attach out-of-order timing model (single-cycle)\n"
+              << "  timing dataflow [window <n|inf>]... [alu|mul|div|load|store <latency>]\n"
+              << "                    Ideal-IPC dataflow limit and RAW distances (single-cycle)\n"
+              << "  timing interval [hazards|forward on|off] [resolve id|ex|mem]\n"
+              << "                    Approximate Pipeline timing from cached basic blocks (single-cycle)\n"
+              << "  validate <file>...  Compare the interval model with Pipeline on programs\n"
+              << "  timing off        Detach timing model\n"
+              << "  bpsweep [on|off]  Evaluate a set of branch predictors in one run (single-cycle)\n"
+              << "  smp <harts> [size|line|assoc|hit|upgrade|transfer|mem <n>]...\n"
+              << "                    Reload and run on several harts with MESI coherence timing\n"
+              << "  batch <lanes> [first|step|data|stack|show <n>]...\n"
+              << "                    Run many instances at once, a0 = first + lane * step\n"
+              << "  analyze <start> <end> [iterations|timeline <n>]...\n"
+              << "                    Steady-state pipeline throughput of the block [start, end)\n"
+              << "  source <file>     Run commands from a file\n"
+              << "  repeat <n> <cmd>  Run a command n times\n"
+              << "  repeat <cmd> until <expr>  Run a command until expression is true\n"
+              << "  if <expr> <cmd>   Run a command if expression is true\n"
+              << "  quit              Exit emulator\n"
+              << "\nExpressions:\n"
+              << "  registers, pc, cycles, instructions, [addr] or mem[addr],\n"
+              << "  symbols, numbers and C operators (== != < <= > >= && || + - * & | ...)\n";
 }
 
 void Emulator::cmd_load(const std::string& filename) {
     load(filename);
 }
 
-void Emulator::cmd_run() {
+void Emulator::cmd_run(Predicate* until) {
     if (!program_loaded) {
         std::cout << "No program loaded\n";
         return;
     }
 
+    StopReason reason;
     if (mode == Mode::SINGLE_CYCLE) {
-        cpu.run();
-        std::cout << "Halted at PC=" << to_hex(cpu.get_pc()) << "\n";
+        do {
+            reason = until ? cpu.run_until(*until) : cpu.run();
+        } while (roi_started(reason));
+        std::cout << describe_stop(reason) << " at PC=" << to_hex(cpu.get_pc()) << "\n";
         print_instruction(cpu.get_pc());
     } else {
-        pipeline.run();
-        std::cout << "Halted at PC=" << to_hex(pipeline.get_pc()) << "\n";
+        do {
+            reason = until ? pipeline.run_until(*until) : pipeline.run();
+        } while (roi_started(reason));
+        std::cout << describe_stop(reason) << " at PC=" << to_hex(pipeline.get_pc()) << "\n";
     }
 }
 
-void Emulator::cmd_step(int count) {
+void Emulator::cmd_step(int count, bool quiet, const std::string& filename,
+                        Predicate* until) {
     if (!program_loaded) {
         std::cout << "No program loaded\n";
         return;
     }
+    if (count < 1) {
+        std::cout << "Step count must be at least 1\n";
+        return;
+    }
 
-    for (int i = 0; i < count; i++) {
-        bool cont;
+    std::ofstream file;
+    if (!filename.empty()) {
+        file.open(filename);
+        if (!file) {
+            std::cout << "Cannot open file: " << filename << "\n";
+            return;
+        }
+        out.set_stream(file);
+    }
+
+    uint64_t stepped = 0;
+    StopReason reason = StopReason::NONE;
+
+    if (quiet && filename.empty() && !until) {
+        // Nothing to print per step: let the engine run the whole batch
         if (mode == Mode::SINGLE_CYCLE) {
-            cont = cpu.step();
-            print_instruction(cpu.get_last_instruction().pc);
+            uint64_t start = cpu.get_instruction_count();
+            do {
+                stepped = cpu.get_instruction_count() - start;
+                reason = cpu.run(count - stepped);
+            } while (roi_started(reason));
+            stepped = cpu.get_instruction_count() - start;
         } else {
-            cont = pipeline.cycle();
-            pipeline.print_state();
+            uint64_t start = pipeline.get_cycle_count();
+            do {
+                stepped = pipeline.get_cycle_count() - start;
+                reason = pipeline.run(count - stepped);
+            } while (roi_started(reason));
+            stepped = pipeline.get_cycle_count() - start;
         }
-
-        if (!cont) {
-            if (mode == Mode::SINGLE_CYCLE && cpu.is_halted()) {
-                std::cout << "Program halted\n";
-            } else if (mode == Mode::PIPELINE && pipeline.is_halted()) {
-                std::cout << "Program halted\n";
+    } else {
+        // Stepped here rather than in the engine, so the limits are checked here
+        Watchdog watchdog;
+        watchdog.start(cpu.get_limits(), instruction_count(), cycle_count());
+        while (stepped < static_cast<uint64_t>(count) && reason == StopReason::NONE) {
+            if (mode == Mode::SINGLE_CYCLE) {
+                reason = cpu.step();
+                if (!quiet) print_instruction(out, cpu.get_last_instruction());
             } else {
-                std::cout << "Breakpoint hit\n";
+                reason = pipeline.cycle();
+                if (!quiet) pipeline.print_state(out);
+            }
+            if (roi_started(reason)) reason = StopReason::NONE;
+            stepped++;
+
+            if (until && test_predicate(*until)) {
+                reason = StopReason::CONDITION;
+            } else if (reason == StopReason::NONE && Watchdog::interrupted()) {
+                reason = StopReason::INTERRUPTED;
+            } else if (reason == StopReason::NONE) {
+                reason = watchdog.tick(instruction_count(), cycle_count());
             }
-            break;
         }
     }
+
+    out.set_stream(std::cout);
+
+    if (quiet || !filename.empty()) {
+        Address pc = (mode == Mode::SINGLE_CYCLE) ? cpu.get_pc() : pipeline.get_pc();
+        std::cout << "Stepped " << stepped << (mode == Mode::SINGLE_CYCLE ? " instructions" : " cycles")
+                  << ", PC=" << to_hex(pc) << "\n";
+    }
+
+    if (reason != StopReason::NONE) {
+        std::cout << describe_stop(reason) << "\n";
+    }
 }
 
 void Emulator::cmd_reset() {
@@ -296,8 +550,11 @@ void Emulator::cmd_reset() {
     // Reload the program
     mem.reset();
     regs.reset();
+    caches.reset();
     cpu.reset();
     pipeline.reset();
+    stats.reset();
+    if (sampler) sampler->restart();
 
     mem.write_block(asm_result.text_addr, asm_result.text);
     mem.write_bytes(asm_result.data_addr, asm_result.data);
@@ -311,26 +568,8 @@ void Emulator::cmd_regs() {
 }
 
 void Emulator::cmd_reg(const std::string& name) {
-    std::string r = name;
-    std::transform(r.begin(), r.end(), r.begin(), ::tolower);
-
-    int reg = -1;
-    if (r[0] == 'x') {
-        try { reg = std::stoi(r.substr(1)); } catch (...) {}
-    } else {
-        static const std::map<std::string, int> abi = {
-            {"zero",0},{"ra",1},{"sp",2},{"gp",3},{"tp",4},
-            {"t0",5},{"t1",6},{"t2",7},{"s0",8},{"fp",8},{"s1",9},
-            {"a0",10},{"a1",11},{"a2",12},{"a3",13},{"a4",14},{"a5",15},
-            {"a6",16},{"a7",17},{"s2",18},{"s3",19},{"s4",20},{"s5",21},
-            {"s6",22},{"s7",23},{"s8",24},{"s9",25},{"s10",26},{"s11",27},
-            {"t3",28},{"t4",29},{"t5",30},{"t6",31}
-        };
-        auto it = abi.find(r);
-        if (it != abi.end()) reg = it->second;
-    }
-
-    if (reg >= 0 && reg < 32) {
+    int reg = parse_register(name);
+    if (reg >= 0) {
         regs.dump_reg(reg);
     } else {
         std::cout << "Unknown register: " << name << "\n";
@@ -361,10 +600,14 @@ void Emulator::cmd_mode(const std::string& mode_str) {
     std::transform(m.begin(), m.end(), m.begin(), ::tolower);
 
     if (m == "single" || m == "s") {
+        if (sampler && mode != Mode::SINGLE_CYCLE) stop_sampling("mode changed");
         mode = Mode::SINGLE_CYCLE;
+        if (loop_profiler) attach_loop_profiler();
         std::cout << "Mode: single-cycle\n";
     } else if (m == "pipeline" || m == "pipe" || m == "p") {
+        if (sampler && mode != Mode::PIPELINE) stop_sampling("mode changed");
         mode = Mode::PIPELINE;
+        if (loop_profiler) attach_loop_profiler();
         std::cout << "Mode: pipeline\n";
     } else {
         std::cout << "Unknown mode. Use 'single' or 'pipeline'\n";
@@ -401,6 +644,142 @@ void Emulator::cmd_forward(const std::string& state) {
     }
 }
 
+void Emulator::cmd_resolve(const std::string& stage) {
+    std::string s = stage;
+    std::transform(s.begin(), s.end(), s.begin(), ::tolower);
+
+    if (s == "id") {
+        pipeline.set_branch_stage(BranchStage::ID);
+    } else if (s == "ex") {
+        pipeline.set_branch_stage(BranchStage::EX);
+    } else if (s == "mem") {
+        pipeline.set_branch_stage(BranchStage::MEM);
+    } else {
+        std::cout << "Use 'id', 'ex' or 'mem'\n";
+        return;
+    }
+    std::cout << "Branch resolution: " << branch_stage_name(pipeline.get_branch_stage()) << "\n";
+}
+
+void Emulator::cmd_cache(const std::vector<std::string>& tokens) {
+    if (tokens.size() >= 2) {
+        std::string action = tokens[1];
+        std::transform(action.begin(), action.end(), action.begin(), ::tolower);
+
+        if (action == "on") {
+            caches.set_enabled(true);
+        } else if (action == "off") {
+            caches.set_enabled(false);
+        } else if (action == "load" && tokens.size() >= 3) {
+            std::string error;
+            if (!caches.load_config(tokens[2], error)) {
+                std::cout << "Cache config error: " << error << "\n";
+                return;
+            }
+        } else if (action == "prefetch" && tokens.size() >= 4) {
+            Prefetcher::Config pf;
+            if (!Prefetcher::parse_type(tokens[3], pf.type)) {
+                std::cout << "Use 'none', 'nextline', 'stride' or 'stream' for the prefetcher\n";
+                return;
+            }
+            for (size_t i = 4; i + 1 < tokens.size(); i += 2) {
+                const std::string& key = tokens[i];
+                int value;
+                try {
+                    value = std::stoi(tokens[i + 1]);
+                } catch (...) {
+                    std::cout << "Invalid " << key << ": " << tokens[i + 1] << "\n";
+                    return;
+                }
+                if (value < 1) {
+                    std::cout << key << " must be at least 1\n";
+                    return;
+                }
+                if (key == "degree") pf.degree = value;
+                else if (key == "distance") pf.distance = value;
+                else {
+                    std::cout << "Unknown option: " << key << " (use degree or distance)\n";
+                    return;
+                }
+            }
+            if (tokens.size() % 2 != 0) {
+                std::cout << "Missing value for " << tokens.back() << "\n";
+                return;
+            }
+            if (!caches.set_prefetcher(tokens[2], pf)) {
+                std::cout << "Prefetchers attach to l1i or l1d\n";
+                return;
+            }
+            caches.register_stats(stats, "caches");
+        } else {
+            std::cout << "Usage: cache [on|off|load <file>]\n"
+                      << "       cache prefetch <l1i|l1d> <none|nextline|stride|stream>"
+                         " [degree n] [distance n]\n";
+            return;
+        }
+    }
+    caches.print_config();
+}
+
+void Emulator::cmd_storebuf(const std::vector<std::string>& tokens) {
+    StoreBuffer& sb = pipeline.get_store_buffer();
+    int depth = sb.get_depth();
+    int drain = sb.get_drain_latency();
+    StoreBuffer::Policy policy = sb.get_policy();
+
+    if (tokens.size() == 2 && (tokens[1] == "off" || tokens[1] == "0")) {
+        depth = 0;
+    } else if (tokens.size() >= 2) {
+        try {
+            depth = std::stoi(tokens[1]);
+        } catch (...) {
+            std::cout << "Invalid depth: " << tokens[1] << "\n";
+            return;
+        }
+        if (depth < 0 || depth > StoreBuffer::MAX_DEPTH) {
+            std::cout << "Depth must be 0-" << StoreBuffer::MAX_DEPTH << "\n";
+            return;
+        }
+        for (size_t i = 2; i + 1 < tokens.size(); i += 2) {
+            const std::string& key = tokens[i];
+            const std::string& value = tokens[i + 1];
+            if (key == "drain") {
+                try {
+                    drain = std::stoi(value);
+                } catch (...) {
+                    std::cout << "Invalid drain latency: " << value << "\n";
+                    return;
+                }
+            } else if (key == "policy") {
+                if (value == "eager") policy = StoreBuffer::Policy::EAGER;
+                else if (value == "idle") policy = StoreBuffer::Policy::IDLE;
+                else if (value == "lazy") policy = StoreBuffer::Policy::LAZY;
+                else {
+                    std::cout << "Use 'eager', 'idle' or 'lazy' for policy\n";
+                    return;
+                }
+            } else {
+                std::cout << "Unknown option: " << key << " (use drain or policy)\n";
+                return;
+            }
+        }
+        if (tokens.size() % 2 != 0) {
+            std::cout << "Missing value for " << tokens.back() << "\n";
+            return;
+        }
+    }
+
+    if (tokens.size() >= 2) sb.configure(depth, drain, policy);
+
+    if (!sb.enabled()) {
+        std::cout << "Store buffer: off\n";
+    } else {
+        std::cout << "Store buffer: " << sb.get_depth() << " entries, drain every "
+                  << sb.get_drain_latency() << " cycle(s), "
+                  << StoreBuffer::policy_name(sb.get_policy()) << " policy\n";
+    }
+}
+
 void Emulator::cmd_break(const std::string& target) {
     Address addr = resolve_address(target);
 
@@ -417,10 +796,55 @@ void Emulator::cmd_breakpoints() {
     // Note: Would need to expose breakpoint list from CPU/Pipeline for full implementation
 }
 
+void Emulator::cmd_watch(const std::string& target) {
+    Address addr = resolve_address(target);
+    cpu.add_watchpoint(addr);
+    pipeline.add_watchpoint(addr);
+    std::cout << "Watchpoint set at " << to_hex(addr) << "\n";
+}
+
+void Emulator::cmd_roi(const std::vector<std::string>& tokens) {
+    const std::string& target = tokens[1];
+    if (target == "off") {
+        cpu.clear_roi_end();
+        pipeline.clear_roi_end();
+        cpu.clear_roi_start();
+        pipeline.clear_roi_start();
+        std::cout << "Region of interest cleared\n";
+        return;
+    }
+
+    if (target == "start" || target == "end") {
+        if (tokens.size() < 3) {
+            std::cout << "Usage: roi " << target << " <addr>\n";
+            return;
+        }
+        Address addr = resolve_address(tokens[2]);
+        if (target == "start") {
+            cpu.set_roi_start(addr);
+            pipeline.set_roi_start(addr);
+            std::cout << "Region of interest starts at " << to_hex(addr)
+                      << " (statistics reset when first reached)\n";
+            return;
+        }
+        cpu.set_roi_end(addr);
+        pipeline.set_roi_end(addr);
+        std::cout << "Region of interest ends at " << to_hex(addr) << "\n";
+        return;
+    }
+
+    Address addr = resolve_address(target);
+    cpu.set_roi_end(addr);
+    pipeline.set_roi_end(addr);
+    std::cout << "Region of interest ends at " << to_hex(addr) << "\n";
+}
+
 void Emulator::cmd_clear() {
     cpu.clear_breakpoints();
     pipeline.clear_breakpoints();
-    std::cout << "All breakpoints cleared\n";
+    cpu.clear_watchpoints();
+    pipeline.clear_watchpoints();
+    std::cout << "All breakpoints and watchpoints cleared\n";
 }
 
 void Emulator::cmd_symbols() {
@@ -465,7 +889,40 @@ void Emulator::cmd_pipeline() {
     pipeline.print_state();
 }
 
-void Emulator::cmd_stats() {
+void Emulator::cmd_stats(const std::vector<std::string>& tokens) {
+    if (tokens.size() >= 2) {
+        if (tokens[1] == "reset") {
+            stats.reset();
+            std::cout << "Statistics reset\n";
+            return;
+        }
+
+        StatsRegistry::Format format;
+        if (!StatsRegistry::parse_format(tokens[1], format)) {
+            std::cout << "Usage: stats [text|json|csv] [prefix] [> file] | stats reset\n";
+            return;
+        }
+        std::string prefix, filename;
+        for (size_t i = 2; i < tokens.size(); i++) {
+            if (tokens[i] == ">" && i + 1 < tokens.size()) filename = tokens[++i];
+            else if (tokens[i][0] == '>') filename = tokens[i].substr(1);
+            else prefix = tokens[i];
+        }
+
+        if (filename.empty()) {
+            stats.dump(std::cout, format, prefix);
+            return;
+        }
+        std::ofstream file(filename);
+        if (!file) {
+            std::cout << "Cannot open file: " << filename << "\n";
+            return;
+        }
+        stats.dump(file, format, prefix);
+        std::cout << "Statistics written to " << filename << "\n";
+        return;
+    }
+
     std::cout << "Statistics:\n";
 
     if (mode == Mode::SINGLE_CYCLE) {
@@ -473,6 +930,8 @@ void Emulator::cmd_stats() {
         std::cout << "  Cycles: " << cpu.get_cycle_count() << "\n";
         std::cout << "  Instructions: " << cpu.get_instruction_count() << "\n";
         std::cout << "  CPI: 1.0\n";
+        if (timing) timing->print_stats();
+        if (branch_sweep) branch_sweep->print_stats();
     } else {
         std::cout << "  Mode: pipeline\n";
         std::cout << "  Cycles: " << pipeline.get_cycle_count() << "\n";
@@ -484,17 +943,843 @@ void Emulator::cmd_stats() {
             std::cout << "  CPI: " << std::fixed << std::setprecision(2) << cpi << "\n";
         }
 
-        std::cout << "  Stalls: " << pipeline.get_stall_count() << "\n";
+        std::cout << "  Stalls: " << pipeline.get_stall_count()
+                  << " (branch operands: " << pipeline.get_branch_stall_count() << ")\n";
         std::cout << "  Flushes: " << pipeline.get_flush_count() << "\n";
-        std::cout << "  Forwards: " << pipeline.get_forward_count() << "\n";
+        std::cout << "  Forwards: " << pipeline.get_forward_count()
+                  << " (phantom, skipped: " << pipeline.get_phantom_forward_count() << ")\n";
+        std::cout << "  Load-use stalls avoided (operand metadata): "
+                  << pipeline.get_stalls_avoided() << "\n";
         std::cout << "  Hazard detection: " << (pipeline.get_hazard_detection() ? "on" : "off") << "\n";
         std::cout << "  Forwarding: " << (pipeline.get_forwarding() ? "on" : "off") << "\n";
+        std::cout << "  Branch resolution: " << branch_stage_name(pipeline.get_branch_stage()) << "\n";
+
+        if (caches.is_enabled()) {
+            std::cout << "  I-cache stall cycles: " << pipeline.get_icache_stall_count() << "\n";
+            std::cout << "  D-cache stall cycles: " << pipeline.get_dcache_stall_count() << "\n";
+            std::cout << "  Stall cycles skipped (event-driven): "
+                      << pipeline.get_skipped_cycle_count() << "\n";
+        }
+
+        const StoreBuffer& sb = pipeline.get_store_buffer();
+        if (sb.enabled()) {
+            std::cout << "  Store buffer (" << sb.get_depth() << " entries, "
+                      << StoreBuffer::policy_name(sb.get_policy()) << "):\n";
+            std::cout << "    Drained: " << sb.get_drained()
+                      << ", avg occupancy: " << sb.get_avg_occupancy() << "\n";
+            std::cout << "    Load forwards: " << pipeline.get_sb_forward_count() << "\n";
+            std::cout << "    Full stalls: " << pipeline.get_sb_full_stall_count()
+                      << ", partial-overlap stalls: " << pipeline.get_sb_conflict_stall_count() << "\n";
+        }
     }
 
+    caches.print_stats();
+
     std::cout << "  Memory reads: " << mem.get_read_count() << "\n";
     std::cout << "  Memory writes: " << mem.get_write_count() << "\n";
 }
 
+void Emulator::cmd_sample(const std::vector<std::string>& tokens) {
+    if (tokens.size() == 1) {
+        if (!sampler) {
+            std::cout << "Sampling: off\n";
+            return;
+        }
+        const Sampler::Config& cfg = sampler->get_config();
+        std::cout << "Sampling every " << cfg.period
+                  << (cfg.unit == Sampler::Unit::CYCLES ? " cycles" : " instructions") << " to "
+                  << (sampler->get_filename().empty() ? "stdout" : sampler->get_filename())
+                  << ", " << sampler->get_rows() << " interval(s) so far\n";
+        return;
+    }
+
+    if (tokens[1] == "off") {
+        if (sampler) stop_sampling(nullptr);
+        else std::cout << "Sampling: off\n";
+        return;
+    }
+
+    Sampler::Config cfg;
+    std::string filename;
+    try {
+        cfg.period = std::stoull(tokens[1]);
+    } catch (...) {
+        std::cout << "Usage: sample <n> [insns|cycles] [> file] | sample off\n";
+        return;
+    }
+    if (cfg.period == 0) {
+        std::cout << "Interval must be at least 1\n";
+        return;
+    }
+    for (size_t i = 2; i < tokens.size(); i++) {
+        if (tokens[i] == "insns" || tokens[i] == "instructions") {
+            cfg.unit = Sampler::Unit::INSTRUCTIONS;
+        } else if (tokens[i] == "cycles") {
+            cfg.unit = Sampler::Unit::CYCLES;
+        } else if (tokens[i] == ">" && i + 1 < tokens.size()) {
+            filename = tokens[++i];
+        } else if (tokens[i][0] == '>') {
+            filename = tokens[i].substr(1);
+        } else {
+            std::cout << "Unknown option: " << tokens[i] << " (use insns, cycles or > file)\n";
+            return;
+        }
+    }
+
+    // The single-cycle engine runs one cycle per instruction; with a timing
+    // model attached, intervals still count instructions
+    if (mode == Mode::SINGLE_CYCLE && cfg.unit == Sampler::Unit::CYCLES && timing) {
+        std::cout << "Note: single-cycle intervals count instructions; "
+                     "cycles per interval come from the timing model\n";
+    }
+
+    if (sampler) stop_sampling(nullptr);
+
+    auto next = std::make_unique<Sampler>(stats, cfg);
+    std::string error;
+    if (!next->open(filename, error)) {
+        std::cout << "Sampling: " << error << "\n";
+        return;
+    }
+    sampler = std::move(next);
+
+    bool single = mode == Mode::SINGLE_CYCLE;
+    std::string engine = single ? "cpu" : "pipeline";
+    std::string timing_prefix = single && timing ? std::string("timing.") + timing->name() : "";
+    sampler->start(engine, timing_prefix, caches.is_enabled());
+
+    bool by_cycles = cfg.unit == Sampler::Unit::CYCLES;
+    auto sample = [this] { sampler->sample(); };
+    if (single) cpu.set_sampling(cfg.period, by_cycles, sample);
+    else pipeline.set_sampling(cfg.period, by_cycles, sample);
+
+    if (!filename.empty()) {
+        std::cout << "Sampling " << engine << " every " << cfg.period
+                  << (by_cycles ? " cycles" : " instructions") << " to " << filename << "\n";
+    }
+}
+
+void Emulator::stop_sampling(const char* why) {
+    cpu.set_sampling(0, false, nullptr);
+    pipeline.set_sampling(0, false, nullptr);
+    sampler->finish();
+    if (!sampler->get_filename().empty() || why) {
+        std::cout << "Sampling stopped" << (why ? std::string(" (") + why + ")" : "") << ": "
+                  << sampler->get_rows() << " interval(s)";
+        if (!sampler->get_filename().empty()) std::cout << " written to " << sampler->get_filename();
+        std::cout << "\n";
+    }
+    sampler.reset();
+}
+
+void Emulator::cmd_loops(const std::vector<std::string>& tokens) {
+    if (tokens.size() >= 2) {
+        std::string action = tokens[1];
+        std::transform(action.begin(), action.end(), action.begin(), ::tolower);
+
+        if (action == "off") {
+            cpu.set_loop_profiler(nullptr);
+            pipeline.set_loop_profiler(nullptr);
+            loop_profiler.reset();
+            std::cout << "Loop profiler detached\n";
+            return;
+        }
+        if (action != "on") {
+            std::cout << "Usage: loops [on|off]\n";
+            return;
+        }
+        if (!loop_profiler) loop_profiler = std::make_unique<LoopProfiler>();
+        attach_loop_profiler();
+        std::cout << "Loop profiler attached to the "
+                  << (mode == Mode::SINGLE_CYCLE ? "single-cycle" : "pipeline") << " engine\n";
+        return;
+    }
+
+    if (!loop_profiler) {
+        std::cout << "No loop profiler attached ('loops on')\n";
+        return;
+    }
+    loop_profiler->print_report(asm_result.symbols);
+}
+
+void Emulator::cmd_misses(const std::vector<std::string>& tokens) {
+    if (tokens.size() == 2 && (tokens[1] == "on" || tokens[1] == "off")) {
+        if (tokens[1] == "off") {
+            caches.set_miss_profiler(nullptr);
+            miss_profiler.reset();
+            std::cout << "Miss profiler detached\n";
+            return;
+        }
+        if (!miss_profiler) {
+            miss_profiler = std::make_unique<MissProfiler>();
+            miss_profiler->configure(asm_result);
+            caches.set_miss_profiler(miss_profiler.get());
+        }
+        std::cout << "Miss profiler attached to the L1 data cache";
+        if (!caches.is_enabled()) std::cout << " (caches are off: 'cache on')";
+        std::cout << "\n";
+        return;
+    }
+
+    size_t top = 10;
+    MissProfiler::Order order = MissProfiler::Order::MISSES;
+    for (size_t i = 1; i < tokens.size(); i += 2) {
+        const std::string& key = tokens[i];
+        const std::string value = i + 1 < tokens.size() ? tokens[i + 1] : "";
+        if (key == "top" && !value.empty()) {
+            try {
+                top = std::stoul(value);
+            } catch (...) {
+                std::cout << "Invalid top: " << value << "\n";
+                return;
+            }
+        } else if (key == "sort" && (value == "misses" || value == "stalls")) {
+            order = value == "stalls" ? MissProfiler::Order::STALLS : MissProfiler::Order::MISSES;
+        } else {
+            std::cout << "Usage: misses [on|off] | misses [top <n>] [sort misses|stalls]\n";
+            return;
+        }
+    }
+
+    if (!miss_profiler) {
+        std::cout << "No miss profiler attached ('misses on')\n";
+        return;
+    }
+    miss_profiler->print_report(top, order);
+}
+
+// Profiles follow one engine; switching starts a new profile
+void Emulator::attach_loop_profiler() {
+    bool single = mode == Mode::SINGLE_CYCLE;
+    cpu.set_loop_profiler(single ? loop_profiler.get() : nullptr);
+    pipeline.set_loop_profiler(single ? nullptr : loop_profiler.get());
+}
+
+void Emulator::cmd_limit(const std::vector<std::string>& tokens) {
+    RunLimits limits = cpu.get_limits();
+
+    if (tokens.size() == 2 && (tokens[1] == "off" || tokens[1] == "none")) {
+        limits = RunLimits();
+    } else if (tokens.size() == 3) {
+        std::string kind = tokens[1];
+        std::transform(kind.begin(), kind.end(), kind.begin(), ::tolower);
+        try {
+            if (kind == "insns" || kind == "instructions") {
+                limits.max_instructions = std::stoull(tokens[2]);
+            } else if (kind == "cycles") {
+                limits.max_cycles = std::stoull(tokens[2]);
+            } else if (kind == "time") {
+                limits.max_seconds = std::stod(tokens[2]);
+            } else {
+                std::cout << "Unknown limit: " << tokens[1] << " (use insns, cycles or time)\n";
+                return;
+            }
+        } catch (...) {
+            std::cout << "Invalid value: " << tokens[2] << "\n";
+            return;
+        }
+    } else if (tokens.size() != 1) {
+        std::cout << "Usage: limit [insns|cycles|time <n>] | limit off\n";
+        return;
+    }
+
+    cpu.set_limits(limits);
+    pipeline.set_limits(limits);
+
+    auto show = [](uint64_t v) { return v ? std::to_string(v) : std::string("none"); };
+    std::cout << "Limits per run:\n";
+    std::cout << "  Instructions: " << show(limits.max_instructions) << "\n";
+    std::cout << "  Cycles: " << show(limits.max_cycles) << "\n";
+    std::cout << "  Time: ";
+    if (limits.max_seconds > 0) {
+        std::cout << limits.max_seconds << "s\n";
+    } else {
+        std::cout << "none\n";
+    }
+}
+
+void Emulator::cmd_timing(const std::vector<std::string>& tokens) {
+    if (tokens.size() == 1) {
+        if (timing) timing->print_config();
+        else std::cout << "No timing model attached\n";
+        return;
+    }
+
+    std::string kind = tokens[1];
+    std::transform(kind.begin(), kind.end(), kind.begin(), ::tolower);
+
+    if (kind == "off" || kind == "none") {
+        if (sampler) stop_sampling("timing model changed");
+        cpu.set_timing_model(nullptr);
+        timing.reset();
+        register_timing_stats();
+        std::cout << "Timing model detached\n";
+        return;
+    }
+
+    if (kind != "inorder" && kind != "ooo" && kind != "dataflow" && kind != "interval") {
+        std::cout << "Unknown timing model: " << tokens[1]
+                  << " (use inorder, ooo, dataflow, interval or off)\n";
+        return;
+    }
+
+    // Options are '<key> <value>' pairs; integers unless noted, each with
+    // its valid range
+    struct IntOption {
+        int* value;
+        int min = 1;
+        int max = std::numeric_limits<int>::max();
+    };
+    InOrderModel::Config inorder;
+    OoOModel::Config ooo;
+    DataflowModel::Config dataflow;
+    IntervalModel::Config interval = interval_config();
+    std::vector<int> windows;
+    std::map<std::string, IntOption> int_options;
+    if (kind == "inorder") {
+        int_options = {
+            {"width", {&inorder.width, 1, InOrderModel::MAX_WIDTH}},
+            {"fetch", {&inorder.fetch_stages}}, {"decode", {&inorder.decode_stages}},
+            {"mem", {&inorder.mem_stages}}, {"alu", {&inorder.alu_latency}},
+            {"mul", {&inorder.mul_latency}}, {"div", {&inorder.div_latency}}
+        };
+    } else if (kind == "dataflow") {
+        int_options = {
+            {"alu", {&dataflow.alu_latency}}, {"mul", {&dataflow.mul_latency}},
+            {"div", {&dataflow.div_latency}}, {"load", {&dataflow.load_latency}},
+            {"store", {&dataflow.store_latency}}
+        };
+    } else if (kind == "ooo") {
+        int_options = {
+            {"width", {&ooo.width, 1, OoOModel::MAX_WIDTH}}, {"rob", {&ooo.rob_size}},
+            {"iq", {&ooo.iq_size}}, {"regs", {&ooo.phys_regs, NUM_REGISTERS + 1}},
+            {"lq", {&ooo.lq_size}}, {"sq", {&ooo.sq_size}},
+            {"alu", {&ooo.alu_units, 1, OoOModel::MAX_UNITS}},
+            {"branch", {&ooo.branch_units, 1, OoOModel::MAX_UNITS}},
+            {"mul", {&ooo.mul_units, 1, OoOModel::MAX_UNITS}},
+            {"mem", {&ooo.mem_units, 1, OoOModel::MAX_UNITS}},
+            {"frontend", {&ooo.frontend_depth}}
+        };
+    }
+    // The interval model takes only the pipeline switches below
+
+    for (size_t i = 2; i < tokens.size(); i += 2) {
+        if (i + 1 >= tokens.size()) {
+            std::cout << "Missing value for " << tokens[i] << "\n";
+            return;
+        }
+        const std::string& key = tokens[i];
+        const std::string& value = tokens[i + 1];
+
+        // Pipeline switches shared by the in-order and interval models
+        bool pipelined = kind == "inorder" || kind == "interval";
+        bool& forwarding = kind == "inorder" ? inorder.forwarding : interval.forwarding;
+        BranchStage& branch_stage = kind == "inorder" ? inorder.branch_stage : interval.branch_stage;
+        bool* toggle = nullptr;
+        if (pipelined && (key == "forward" || key == "forwarding")) toggle = &forwarding;
+        if (kind == "interval" && (key == "hazards" || key == "hazard")) {
+            toggle = &interval.hazard_detection;
+        }
+        if (toggle) {
+            std::string state = value;
+            std::transform(state.begin(), state.end(), state.begin(), ::tolower);
+            if (state != "on" && state != "off") {
+                std::cout << "Use 'on' or 'off' for " << key << "\n";
+                return;
+            }
+            *toggle = state == "on";
+            continue;
+        }
+        if (pipelined && key == "resolve") {
+            std::string stage = value;
+            std::transform(stage.begin(), stage.end(), stage.begin(), ::tolower);
+            if (stage == "id") branch_stage = BranchStage::ID;
+            else if (stage == "ex") branch_stage = BranchStage::EX;
+            else if (stage == "mem") branch_stage = BranchStage::MEM;
+            else {
+                std::cout << "Use 'id', 'ex' or 'mem' for resolve\n";
+                return;
+            }
+            continue;
+        }
+
+        if (kind == "dataflow" && key == "window") {
+            if (value == "inf" || value == "unbounded") {
+                windows.push_back(0);
+                continue;
+            }
+            int size = 0;
+            try { size = std::stoi(value); } catch (...) {}
+            if (size < 1 || size > DataflowModel::MAX_WINDOW) {
+                std::cout << "window must be 1.." << DataflowModel::MAX_WINDOW << " or inf\n";
+                return;
+            }
+            windows.push_back(size);
+            continue;
+        }
+
+        auto it = int_options.find(key);
+        if (it == int_options.end()) {
+            std::cout << "Unknown option for " << kind << ": " << key << "\n";
+            return;
+        }
+        // The Pipeline's stages are fixed; only the model on the
+        // single-cycle engine takes other depths and latencies
+        if (kind == "inorder" && key != "width" && mode != Mode::SINGLE_CYCLE) {
+            std::cout << key << ": stage depths and latencies need 'mode s'; "
+                         "the Pipeline's stages are fixed\n";
+            return;
+        }
+        const IntOption& option = it->second;
+        try {
+            *option.value = std::stoi(value);
+        } catch (...) {
+            std::cout << "Invalid value for " << key << ": " << value << "\n";
+            return;
+        }
+        if (option.max != std::numeric_limits<int>::max() &&
+            (*option.value < option.min || *option.value > option.max)) {
+            std::cout << key << " must be " << option.min << ".." << option.max << "\n";
+            return;
+        }
+        if (*option.value < option.min) {
+            std::cout << key << " must be at least " << option.min << "\n";
+            return;
+        }
+    }
+
+    if (kind == "inorder") {
+        timing = std::make_unique<InOrderModel>(inorder);
+    } else if (kind == "dataflow") {
+        if (!windows.empty()) dataflow.windows = windows;
+        timing = std::make_unique<DataflowModel>(dataflow);
+    } else if (kind == "interval") {
+        timing = std::make_unique<IntervalModel>(interval);
+    } else {
+        timing = std::make_unique<OoOModel>(ooo);
+    }
+    if (sampler) stop_sampling("timing model changed");
+    timing->set_memory_hierarchy(&caches);
+    caches.reset();
+    cpu.set_timing_model(timing.get());
+    register_timing_stats();
+    timing->print_config();
+    if (mode != Mode::SINGLE_CYCLE) {
+        std::cout << "Note: timing models follow the single-cycle engine ('mode s')\n";
+    }
+}
+
+void Emulator::cmd_bpsweep(const std::vector<std::string>& tokens) {
+    if (tokens.size() >= 2) {
+        std::string action = tokens[1];
+        std::transform(action.begin(), action.end(), action.begin(), ::tolower);
+
+        if (action == "off") {
+            cpu.set_branch_sweep(nullptr);
+            branch_sweep.reset();
+            std::cout << "Branch predictor sweep detached\n";
+            return;
+        }
+        if (action != "on") {
+            std::cout << "Usage: bpsweep [on|off]\n";
+            return;
+        }
+        if (!branch_sweep) branch_sweep = std::make_unique<BranchSweep>();
+        cpu.set_branch_sweep(branch_sweep.get());
+    }
+
+    if (!branch_sweep) {
+        std::cout << "No branch predictor sweep attached\n";
+        return;
+    }
+    branch_sweep->print_config();
+    if (mode != Mode::SINGLE_CYCLE) {
+        std::cout << "Note: the sweep follows the single-cycle engine ('mode s')\n";
+    }
+}
+
+void Emulator::cmd_smp(const std::vector<std::string>& tokens) {
+    if (tokens.size() < 2) {
+        std::cout << "Usage: smp <harts> [size|line|assoc|hit|upgrade|transfer|mem <n>]...\n";
+        return;
+    }
+    if (!program_loaded) {
+        std::cout << "No program loaded\n";
+        return;
+    }
+
+    // Options are '<key> <value>' pairs of integers
+    CoherenceModel::Config cfg;
+    std::vector<std::string> args(tokens.begin() + 1, tokens.end());
+    args.insert(args.begin(), "harts");
+    if (args.size() % 2 != 0) {
+        std::cout << "Missing value for " << args.back() << "\n";
+        return;
+    }
+    for (size_t i = 0; i < args.size(); i += 2) {
+        const std::string& key = args[i];
+        long value;
+        try {
+            value = std::stol(args[i + 1], nullptr, 0);
+        } catch (...) {
+            std::cout << "Invalid value for " << key << ": " << args[i + 1] << "\n";
+            return;
+        }
+        if (key == "harts") cfg.harts = value;
+        else if (key == "size") cfg.size = value;
+        else if (key == "line") cfg.line_size = value;
+        else if (key == "assoc") cfg.assoc = value;
+        else if (key == "hit") cfg.hit_latency = value;
+        else if (key == "upgrade") cfg.upgrade_latency = value;
+        else if (key == "transfer") cfg.transfer_latency = value;
+        else if (key == "mem") cfg.memory_latency = value;
+        else {
+            std::cout << "Unknown option: " << key << "\n";
+            return;
+        }
+    }
+    std::string error;
+    if (!CoherenceModel::validate(cfg, error)) {
+        std::cout << "Coherence config error: " << error << "\n";
+        return;
+    }
+
+    // Every hart starts from a fresh image
+    mem.reset();
+    mem.write_block(asm_result.text_addr, asm_result.text);
+    mem.write_bytes(asm_result.data_addr, asm_result.data);
+
+    smp.set_config(cfg);
+    smp.get_coherence().print_config();
+    smp.start(asm_result.text_addr);
+    StopReason reason = smp.run(cpu.get_limits());
+
+    std::cout << describe_stop(reason);
+    if (smp.get_stop_hart() >= 0) {
+        std::cout << " on hart " << smp.get_stop_hart()
+                  << " at PC=" << to_hex(smp.get_pc(smp.get_stop_hart()));
+    }
+    std::cout << "\n";
+    smp.print_stats();
+    smp.get_coherence().print_hotspots(asm_result.symbols);
+}
+
+void Emulator::cmd_batch(const std::vector<std::string>& tokens) {
+    if (tokens.size() < 2) {
+        std::cout << "Usage: batch <lanes> [first|step|data|stack|show <n>]...\n";
+        return;
+    }
+    if (!program_loaded) {
+        std::cout << "No program loaded\n";
+        return;
+    }
+
+    // Options are '<key> <value>' pairs of integers
+    BatchEngine::Config cfg;
+    std::vector<std::string> args(tokens.begin() + 1, tokens.end());
+    args.insert(args.begin(), "lanes");
+    if (args.size() % 2 != 0) {
+        std::cout << "Missing value for " << args.back() << "\n";
+        return;
+    }
+    for (size_t i = 0; i < args.size(); i += 2) {
+        const std::string& key = args[i];
+        long value;
+        try {
+            value = std::stol(args[i + 1], nullptr, 0);
+        } catch (...) {
+            std::cout << "Invalid value for " << key << ": " << args[i + 1] << "\n";
+            return;
+        }
+        if (key == "lanes") cfg.lanes = value;
+        else if (key == "first") cfg.first = value;
+        else if (key == "step") cfg.step = value;
+        else if (key == "data") cfg.data_size = value;
+        else if (key == "stack") cfg.stack_size = value;
+        else if (key == "show") cfg.show = value;
+        else {
+            std::cout << "Unknown option: " << key << "\n";
+            return;
+        }
+    }
+    std::string error;
+    if (!BatchEngine::validate(cfg, error)) {
+        std::cout << "Batch config error: " << error << "\n";
+        return;
+    }
+
+    // Lanes have their own memory; the loaded image is left untouched
+    batch.configure(cfg);
+    batch.print_config();
+    batch.start(asm_result.text, asm_result.text_addr, asm_result.data, asm_result.data_addr);
+    StopReason reason = batch.run(cpu.get_limits());
+    std::cout << describe_stop(reason) << "\n";
+    batch.print_stats();
+}
+
+void Emulator::cmd_analyze(const std::vector<std::string>& tokens) {
+    if (tokens.size() < 3 || tokens.size() % 2 == 0) {
+        std::cout << "Usage: analyze <start> <end> [iterations|timeline <n>]...\n";
+        return;
+    }
+    if (!program_loaded) {
+        std::cout << "No program loaded\n";
+        return;
+    }
+
+    // Same pipeline settings as the pipelined mode
+    BlockAnalyzer::Config cfg;
+    cfg.hazard_detection = pipeline.get_hazard_detection();
+    cfg.forwarding = pipeline.get_forwarding();
+    cfg.branch_stage = pipeline.get_branch_stage();
+    for (size_t i = 3; i < tokens.size(); i += 2) {
+        const std::string& key = tokens[i];
+        int value;
+        try {
+            value = std::stoi(tokens[i + 1], nullptr, 0);
+        } catch (...) {
+            std::cout << "Invalid value for " << key << ": " << tokens[i + 1] << "\n";
+            return;
+        }
+        if (key == "iterations") cfg.iterations = value;
+        else if (key == "timeline") cfg.timeline = value;
+        else {
+            std::cout << "Unknown option: " << key << "\n";
+            return;
+        }
+    }
+
+    // The block is [start, end) of the assembled text, end being a label
+    // after the loop or the address past its last instruction
+    Address start = resolve_address(tokens[1]);
+    Address end = resolve_address(tokens[2]);
+    Address text_end = asm_result.text_addr + 4 * static_cast<Address>(asm_result.text.size());
+    if (start % 4 != 0 || end % 4 != 0 || start < asm_result.text_addr || end <= start ||
+        end > text_end) {
+        std::cout << "Block must be a word-aligned range inside the text segment ("
+                  << to_hex(asm_result.text_addr) << "-" << to_hex(text_end) << ")\n";
+        return;
+    }
+    std::vector<Word> block(asm_result.text.begin() + (start - asm_result.text_addr) / 4,
+                            asm_result.text.begin() + (end - asm_result.text_addr) / 4);
+
+    BlockAnalyzer analyzer;
+    std::string error;
+    if (!analyzer.analyze(block, start, cfg, error)) {
+        std::cout << "Analyze error: " << error << "\n";
+        return;
+    }
+    analyzer.print_report();
+}
+
+void Emulator::cmd_validate(const std::vector<std::string>& tokens) {
+    if (tokens.size() < 2) {
+        std::cout << "Usage: validate <file>...\n";
+        return;
+    }
+
+    // Each program runs twice in its own memory: on the Pipeline, and on the
+    // single-cycle engine with the interval model. Both use a private copy of
+    // the cache configuration, cold before each run; the loaded program, its
+    // caches, statistics and miss profile are untouched.
+    IntervalModel::Config cfg = interval_config();
+    const StoreBuffer& store_buffer = pipeline.get_store_buffer();
+    std::cout << "Interval model vs Pipeline (hazards " << (cfg.hazard_detection ? "on" : "off")
+              << ", forwarding " << (cfg.forwarding ? "on" : "off") << ", branches in "
+              << branch_stage_name(cfg.branch_stage) << ", caches "
+              << (caches.is_enabled() ? "on" : "off");
+    if (store_buffer.enabled()) std::cout << ", store buffer " << store_buffer.get_depth();
+    std::cout << "):\n";
+    if (store_buffer.enabled()) {
+        std::cout << "  Note: the interval model has no store buffer; stores wait for the cache\n";
+    }
+    std::cout << "  " << std::left << std::setw(28) << "Program" << std::right
+              << std::setw(14) << "Instructions" << std::setw(16) << "Pipeline"
+              << std::setw(16) << "Interval" << std::setw(10) << "Error"
+              << std::setw(10) << "Speedup" << "\n";
+
+    // With hazards or forwarding off the Pipeline can compute garbage and
+    // never halt; without a 'limit' each run is capped
+    RunLimits limits = pipeline.get_limits();
+    if (limits.max_instructions == 0 && limits.max_cycles == 0 && limits.max_seconds == 0) {
+        limits.max_instructions = 10000000;
+        limits.max_cycles = 50000000;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto seconds = [](Clock::time_point since) {
+        return std::chrono::duration<double>(Clock::now() - since).count();
+    };
+
+    MemoryHierarchy hierarchy;
+    hierarchy.copy_config(caches);
+
+    double error_sum = 0;
+    int compared = 0;
+    for (size_t i = 1; i < tokens.size(); i++) {
+        const std::string& file = tokens[i];
+        Assembler::Result program = assembler.assemble_file(file);
+        if (!program.success) {
+            std::cout << "  " << std::left << std::setw(28) << file << std::right
+                      << "  assembly failed\n";
+            continue;
+        }
+        auto load_into = [&program](Memory& m, RegisterFile& r) {
+            m.write_block(program.text_addr, program.text);
+            m.write_bytes(program.data_addr, program.data);
+            r.write(2, Memory::STACK_TOP);
+        };
+
+        Memory pipe_mem;
+        RegisterFile pipe_regs;
+        load_into(pipe_mem, pipe_regs);
+        Pipeline detailed(pipe_mem, pipe_regs);
+        detailed.set_hazard_detection(cfg.hazard_detection);
+        detailed.set_forwarding(cfg.forwarding);
+        detailed.set_branch_stage(cfg.branch_stage);
+        detailed.set_memory_hierarchy(&hierarchy);
+        detailed.get_store_buffer().configure(store_buffer.get_depth(),
+                                              store_buffer.get_drain_latency(),
+                                              store_buffer.get_policy());
+        detailed.set_limits(limits);
+        hierarchy.reset();
+        Clock::time_point begin = Clock::now();
+        StopReason pipe_stop = detailed.run();
+        double pipe_seconds = seconds(begin);
+
+        Memory fast_mem;
+        RegisterFile fast_regs;
+        load_into(fast_mem, fast_regs);
+        CPU fast(fast_mem, fast_regs);
+        IntervalModel model(cfg);
+        model.set_memory_hierarchy(&hierarchy);
+        fast.set_timing_model(&model);
+        fast.set_limits(limits);
+        hierarchy.reset();
+        begin = Clock::now();
+        StopReason fast_stop = fast.run();
+        double fast_seconds = seconds(begin);
+
+        std::cout << "  " << std::left << std::setw(28) << file << std::right
+                  << std::setw(14) << model.get_instruction_count()
+                  << std::setw(16) << detailed.get_cycle_count()
+                  << std::setw(16) << model.get_cycle_count();
+        bool finished = (pipe_stop == StopReason::HALTED || pipe_stop == StopReason::EXITED) &&
+                        (fast_stop == StopReason::HALTED || fast_stop == StopReason::EXITED);
+        if (!finished) {
+            std::cout << "  did not finish: " << describe_stop(pipe_stop) << " / "
+                      << describe_stop(fast_stop) << "\n";
+            continue;
+        }
+        if (pipe_regs.get_all() != fast_regs.get_all()) {
+            std::cout << "  results differ (Pipeline hazards unhandled)\n";
+            continue;
+        }
+        double error = 100.0 * (static_cast<double>(model.get_cycle_count()) -
+                                static_cast<double>(detailed.get_cycle_count())) /
+                       detailed.get_cycle_count();
+        std::ostringstream error_cell, speedup_cell;
+        error_cell << std::showpos << std::fixed << std::setprecision(2) << error << "%";
+        speedup_cell << std::fixed << std::setprecision(1)
+                     << (fast_seconds > 0 ? pipe_seconds / fast_seconds : 0.0) << "x";
+        std::cout << std::setw(10) << error_cell.str() << std::setw(10) << speedup_cell.str() << "\n";
+        error_sum += std::abs(error);
+        compared++;
+    }
+    if (compared > 0) {
+        std::cout << "  Mean absolute cycle error: " << std::fixed << std::setprecision(2)
+                  << error_sum / compared << "% over " << compared << " program(s)\n";
+    }
+}
+
+bool Emulator::cmd_repeat(const std::vector<std::string>& tokens) {
+    auto until = std::find(tokens.begin(), tokens.end(), "until");
+
+    // repeat <n> <command...>
+    if (until == tokens.end()) {
+        int count = 0;
+        if (tokens.size() >= 3) {
+            try { count = std::stoi(tokens[1]); } catch (...) { count = -1; }
+        }
+        if (tokens.size() < 3 || count < 0) {
+            std::cout << "Usage: repeat <n> <command> | repeat <command> until <expr>\n";
+            return true;
+        }
+        std::string command = join(tokens, 2, tokens.size());
+        for (int i = 0; i < count; i++) {
+            if (!execute_command(command)) return false;
+        }
+        return true;
+    }
+
+    // repeat <command...> until <condition>
+    size_t u = until - tokens.begin();
+    Predicate pred;
+    if (u < 2 || u + 1 >= tokens.size()) {
+        std::cout << "Usage: repeat <command> until <expr>\n";
+        return true;
+    }
+    if (!compile_predicate(join(tokens, u + 1, tokens.size()), pred)) return true;
+
+    // Bare step/run are evaluated inside the engine loop
+    std::string cmd = tokens[1];
+    std::transform(cmd.begin(), cmd.end(), cmd.begin(), ::tolower);
+    if (u == 2 && (cmd == "step" || cmd == "s")) {
+        cmd_step(std::numeric_limits<int>::max(), false, "", &pred);
+        return true;
+    }
+    if (u == 2 && (cmd == "run" || cmd == "r")) {
+        cmd_run(&pred);
+        return true;
+    }
+
+    // The limits cover the whole loop, not each command's own run. A command
+    // that leaves the machine as it was would repeat forever.
+    std::string command = join(tokens, 1, u);
+    Watchdog watchdog;
+    watchdog.start(cpu.get_limits(), instruction_count(), cycle_count());
+    while (!test_predicate(pred)) {
+        const uint64_t insns = instruction_count();
+        const uint64_t cycles = cycle_count();
+        const Address pc = (mode == Mode::SINGLE_CYCLE) ? cpu.get_pc() : pipeline.get_pc();
+        if (!execute_command(command)) return false;
+
+        bool halted = (mode == Mode::SINGLE_CYCLE) ? cpu.is_halted() : pipeline.is_halted();
+        if (halted || test_predicate(pred)) break;
+        StopReason reason = watchdog.poll(instruction_count(), cycle_count());
+        if (reason != StopReason::NONE) {
+            std::cout << "repeat: " << describe_stop(reason) << "\n";
+            break;
+        }
+        const Address now = (mode == Mode::SINGLE_CYCLE) ? cpu.get_pc() : pipeline.get_pc();
+        if (instruction_count() == insns && cycle_count() == cycles && now == pc) {
+            std::cout << "repeat: '" << command << "' does not advance the program; stopping\n";
+            break;
+        }
+    }
+    return true;
+}
+
+bool Emulator::cmd_if(const std::vector<std::string>& tokens) {
+    // The expression ends at the first token that cannot continue it
+    std::string text = join(tokens, 1, tokens.size());
+    Predicate pred;
+    size_t used = 0;
+    if (tokens.size() < 2 || !compile_predicate(text, pred, used)) {
+        if (tokens.size() < 2) std::cout << "Usage: if <expr> <command>\n";
+        return true;
+    }
+    if (used >= text.size()) {
+        std::cout << "Usage: if <expr> <command>\n";
+        return true;
+    }
+
+    if (test_predicate(pred)) {
+        return execute_command(text.substr(used));
+    }
+    return true;
+}
+
 // =============================================================================
 // Helpers
 // =============================================================================
@@ -528,12 +1813,61 @@ void Emulator::print_prompt() {
     std::cout << "[" << mode_str << " " << to_hex(pc) << "] > ";
 }
 
+// A run stopped at the start of the region of interest continues from
+// there with statistics counted anew
+bool Emulator::roi_started(StopReason reason) {
+    if (reason != StopReason::ROI_START) return false;
+    stats.reset();
+    Address pc = (mode == Mode::SINGLE_CYCLE) ? cpu.get_pc() : pipeline.get_pc();
+    std::cout << "Region of interest starts at PC=" << to_hex(pc) << ", statistics reset\n";
+    return true;
+}
+
+uint64_t Emulator::instruction_count() const {
+    return (mode == Mode::SINGLE_CYCLE) ? cpu.get_instruction_count() : pipeline.get_instruction_count();
+}
+
+uint64_t Emulator::cycle_count() const {
+    return (mode == Mode::SINGLE_CYCLE) ? cpu.get_cycle_count() : pipeline.get_cycle_count();
+}
+
+// Timing statistics live under "timing.<model>" while a model is attached
+void Emulator::register_timing_stats() {
+    stats.remove("timing");
+    if (timing) timing->register_stats(stats, std::string("timing.") + timing->name());
+    stats.reset();
+}
+
+std::string Emulator::describe_stop(StopReason reason) const {
+    switch (reason) {
+        case StopReason::HALTED:     return "Program halted";
+        case StopReason::BREAKPOINT: return "Breakpoint hit";
+        case StopReason::WATCHPOINT: return "Watchpoint hit";
+        case StopReason::EXITED: {
+            Word code = (mode == Mode::SINGLE_CYCLE) ? cpu.get_exit_code() : pipeline.get_exit_code();
+            return "Program exited with code " + std::to_string(static_cast<SignedWord>(code));
+        }
+        default: {
+            std::string what = stop_reason_name(reason);
+            what[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(what[0])));
+            return what;
+        }
+    }
+}
+
 void Emulator::print_instruction(Address pc) {
     Word raw = mem.read_word(pc);
     Instruction ins = Decoder::decode(raw, pc);
     std::cout << to_hex(pc) << ": " << ins.text << "\n";
 }
 
+void Emulator::print_instruction(OutputBuffer& buf, const Instruction& ins) {
+    buf.put_hex(ins.pc);
+    buf.put(": ");
+    buf.put(ins.text);
+    buf.put('\n');
+}
+
 Address Emulator::resolve_address(const std::string& str) {
     // Try as symbol first
     auto it = asm_result.symbols.find(str);
@@ -553,6 +1887,54 @@ Address Emulator::resolve_address(const std::string& str) {
     }
 }
 
+IntervalModel::Config Emulator::interval_config() const {
+    // The interval model follows the Pipeline's hazard, forwarding and branch settings
+    IntervalModel::Config cfg;
+    cfg.hazard_detection = pipeline.get_hazard_detection();
+    cfg.forwarding = pipeline.get_forwarding();
+    cfg.branch_stage = pipeline.get_branch_stage();
+    return cfg;
+}
+
+int Emulator::parse_register(const std::string& name) {
+    std::string r = name;
+    std::transform(r.begin(), r.end(), r.begin(), ::tolower);
+    return reg_index(r);
+}
+
+bool Emulator::compile_predicate(const std::string& text, Predicate& pred, size_t& used) {
+    std::string error;
+    if (!pred.compile(text, asm_result.symbols, used, error)) {
+        std::cout << "Bad expression: " << error << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool Emulator::compile_predicate(const std::string& text, Predicate& pred) {
+    size_t used = 0;
+    if (!compile_predicate(text, pred, used)) return false;
+    if (used != text.size()) {
+        std::cout << "Bad expression: unexpected '" << text.substr(used) << "'\n";
+        return false;
+    }
+    return true;
+}
+
+bool Emulator::test_predicate(Predicate& pred) {
+    pred.invalidate();
+    return pred.test(mode == Mode::SINGLE_CYCLE ? cpu.predicate_state() : pipeline.predicate_state());
+}
+
+std::string Emulator::join(const std::vector<std::string>& tokens, size_t start, size_t end) {
+    std::string out;
+    for (size_t i = start; i < end && i < tokens.size(); i++) {
+        if (!out.empty()) out += " ";
+        out += tokens[i];
+    }
+    return out;
+}
+
 std::vector<std::string> Emulator::tokenize(const std::string& input) {
     std::vector<std::string> tokens;
     std::istringstream ss(input);
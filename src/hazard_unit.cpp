@@ -18,17 +18,12 @@ bool HazardUnit::detect_load_use(const ID_EX& id_ex, const Instruction& next_ins
     
     if (!id_ex.valid) return false;
     if (!id_ex.ins.mem_read) return false;
-    if (id_ex.ins.rd == 0) return false;
+    if (!id_ex.ins.writes_rd) return false;
 
-    // Check if next instruction reads from load destination
-    bool uses_rs1 = (next_ins.rs1 == id_ex.ins.rd) && (next_ins.rs1 != 0);
-    bool uses_rs2 = (next_ins.rs2 == id_ex.ins.rd) && (next_ins.rs2 != 0);
-
-    // For store instructions, rs2 is the data to store
-    // We need the address (rs1) and data (rs2)
-    if (next_ins.mem_write) {
-        uses_rs2 = (next_ins.rs2 == id_ex.ins.rd) && (next_ins.rs2 != 0);
-    }
+    // Check if next instruction reads from load destination. Fields that
+    // hold immediate bits (I/U/J formats) are not reads.
+    bool uses_rs1 = next_ins.reads_rs1 && next_ins.rs1 == id_ex.ins.rd;
+    bool uses_rs2 = next_ins.reads_rs2 && next_ins.rs2 == id_ex.ins.rd;
 
     return uses_rs1 || uses_rs2;
 }
@@ -41,12 +36,12 @@ bool HazardUnit::detect_raw(int rs, const EX_MEM& ex_mem, const MEM_WB& mem_wb)
     if (rs == 0) return false;
 
     // Check EX/MEM stage
-    if (ex_mem.valid && ex_mem.ins.reg_write && ex_mem.ins.rd == rs) {
+    if (ex_mem.valid && ex_mem.ins.writes_rd && ex_mem.ins.rd == rs) {
         return true;
     }
 
     // Check MEM/WB stage
-    if (mem_wb.valid && mem_wb.ins.reg_write && mem_wb.ins.rd == rs) {
+    if (mem_wb.valid && mem_wb.ins.writes_rd && mem_wb.ins.rd == rs) {
         return true;
     }
 
@@ -59,17 +54,17 @@ bool HazardUnit::detect_raw(int rs, const EX_MEM& ex_mem, const MEM_WB& mem_wb)
 
 Forward HazardUnit::get_forward_rs1(const ID_EX& id_ex, const EX_MEM& ex_mem, const MEM_WB& mem_wb) {
     int rs1 = id_ex.ins.rs1;
-    if (rs1 == 0) return Forward::NONE;
+    if (rs1 == 0 || !id_ex.ins.reads_rs1) return Forward::NONE;
 
     // Priority: EX/MEM > MEM/WB (more recent instruction takes precedence)
     
     // Forward from EX/MEM
-    if (ex_mem.valid && ex_mem.ins.reg_write && ex_mem.ins.rd != 0 && ex_mem.ins.rd == rs1) {
+    if (ex_mem.valid && ex_mem.ins.writes_rd && ex_mem.ins.rd == rs1) {
         return Forward::EX_MEM;
     }
 
     // Forward from MEM/WB
-    if (mem_wb.valid && mem_wb.ins.reg_write && mem_wb.ins.rd != 0 && mem_wb.ins.rd == rs1) {
+    if (mem_wb.valid && mem_wb.ins.writes_rd && mem_wb.ins.rd == rs1) {
         return Forward::MEM_WB;
     }
 
@@ -78,15 +73,15 @@ Forward HazardUnit::get_forward_rs1(const ID_EX& id_ex, const EX_MEM& ex_mem, co
 
 Forward HazardUnit::get_forward_rs2(const ID_EX& id_ex, const EX_MEM& ex_mem, const MEM_WB& mem_wb) {
     int rs2 = id_ex.ins.rs2;
-    if (rs2 == 0) return Forward::NONE;
+    if (rs2 == 0 || !id_ex.ins.reads_rs2) return Forward::NONE;
 
     // Forward from EX/MEM
-    if (ex_mem.valid && ex_mem.ins.reg_write && ex_mem.ins.rd != 0 && ex_mem.ins.rd == rs2) {
+    if (ex_mem.valid && ex_mem.ins.writes_rd && ex_mem.ins.rd == rs2) {
         return Forward::EX_MEM;
     }
 
     // Forward from MEM/WB
-    if (mem_wb.valid && mem_wb.ins.reg_write && mem_wb.ins.rd != 0 && mem_wb.ins.rd == rs2) {
+    if (mem_wb.valid && mem_wb.ins.writes_rd && mem_wb.ins.rd == rs2) {
         return Forward::MEM_WB;
     }
 
@@ -0,0 +1,288 @@
+/**
+ * inorder_model.cpp
+ *
+ * In-order superscalar timing model implementation.
+ */
+
+#include "inorder_model.hpp"
+#include <algorithm>
+
+InOrderModel::InOrderModel() : InOrderModel(Config()) {}
+
+InOrderModel::InOrderModel(const Config& cfg) {
+    set_config(cfg);
+}
+
+void InOrderModel::set_config(const Config& cfg) {
+    config = cfg;
+    config.width = std::clamp(config.width, 1, MAX_WIDTH);
+    config.fetch_stages = std::max(config.fetch_stages, 1);
+    config.decode_stages = std::max(config.decode_stages, 1);
+    config.mem_stages = std::max(config.mem_stages, 1);
+    config.alu_latency = std::max(config.alu_latency, 1);
+    config.mul_latency = std::max(config.mul_latency, 1);
+    config.div_latency = std::max(config.div_latency, 1);
+
+    // Cycles are numbered from 1 with the first fetch
+    first_ex = config.fetch_stages + config.decode_stages + 1;
+
+    // A taken branch resolves at the end of its stage; the target is
+    // fetched in the next cycle and takes first_ex cycles to reach EX
+    int resolve = 0;
+    switch (config.branch_stage) {
+        case BranchStage::ID:  resolve = -1; break;
+        case BranchStage::EX:  resolve = config.alu_latency - 1; break;
+        case BranchStage::MEM: resolve = config.alu_latency + config.mem_stages - 1; break;
+    }
+    redirect_delay = first_ex + resolve;
+
+    reset();
+}
+
+const InOrderModel::Config& InOrderModel::get_config() const { return config; }
+
+const char* InOrderModel::name() const { return "inorder"; }
+
+void InOrderModel::reset() {
+    cur_cycle = first_ex;
+    group_size = 0;
+    group_mem = false;
+    group_ctrl = false;
+    reg_ready.fill(0);
+    fetch_ready = first_ex;
+    ex_free = 0;
+    last_done = 0;
+
+    instructions = 0;
+    issue_hist.fill(0);
+    split_width = 0;
+    split_mem = 0;
+    split_ctrl = 0;
+    split_dep = 0;
+    split_redirect = 0;
+    split_struct = 0;
+    data_stall_cycles = 0;
+    control_stall_cycles = 0;
+    struct_stall_cycles = 0;
+}
+
+// =============================================================================
+// Latencies
+// =============================================================================
+
+int InOrderModel::ex_latency(const Instruction& ins) const {
+    switch (ins.type) {
+        case InsType::MUL: case InsType::MULH: case InsType::MULHSU: case InsType::MULHU:
+            return config.mul_latency;
+        case InsType::DIV: case InsType::DIVU: case InsType::REM: case InsType::REMU:
+            return config.div_latency;
+        default:
+            return config.alu_latency;
+    }
+}
+
+// =============================================================================
+// Issue
+// =============================================================================
+
+void InOrderModel::close_group(uint64_t next_cycle) {
+    issue_hist[group_size]++;
+    issue_hist[0] += next_cycle - cur_cycle - 1;
+    cur_cycle = next_cycle;
+    group_size = 0;
+    group_mem = false;
+    group_ctrl = false;
+}
+
+void InOrderModel::retire(const RetiredInsn& r) {
+    const Instruction& ins = r.ins;
+
+    bool is_mem = ins.mem_read || ins.mem_write;
+    bool is_ctrl = ins.branch || ins.jump;
+
+    // A comparator in ID reads its operands a cycle before EX
+    uint64_t early = 0;
+    if (config.branch_stage == BranchStage::ID && config.forwarding &&
+        (ins.branch || ins.type == InsType::JALR)) {
+        early = 1;
+    }
+
+    // An I-cache miss delays this instruction's fetch
+    if (caches_enabled()) {
+        int fetch_latency = memory->fetch(ins.pc, cur_cycle);
+        if (fetch_latency > 1) {
+            fetch_ready = std::max(fetch_ready, cur_cycle) + fetch_latency - 1;
+        }
+    }
+
+    // Earliest EX cycle allowed by operands, fetch and blocked stages
+    uint64_t dep = 0;
+    if (ins.reads_rs1 && ins.rs1 != 0) dep = std::max(dep, reg_ready[ins.rs1] + early);
+    if (ins.reads_rs2 && ins.rs2 != 0) dep = std::max(dep, reg_ready[ins.rs2] + early);
+    uint64_t earliest = std::max({cur_cycle, fetch_ready, dep, ex_free});
+
+    if (group_size > 0) {
+        bool joins = false;
+        if (earliest > cur_cycle) {
+            if (earliest == dep) split_dep++;
+            else if (earliest == fetch_ready) split_redirect++;
+            else split_struct++;
+        } else if (group_size >= config.width) {
+            split_width++;
+        } else if (is_mem && group_mem) {
+            split_mem++;
+        } else if (is_ctrl && group_ctrl) {
+            split_ctrl++;
+        } else {
+            joins = true;
+        }
+
+        if (!joins) {
+            uint64_t next = std::max(earliest, cur_cycle + 1);
+            uint64_t bubbles = next - cur_cycle - 1;
+            if (earliest == dep) data_stall_cycles += bubbles;
+            else if (earliest == fetch_ready) control_stall_cycles += bubbles;
+            else struct_stall_cycles += bubbles;
+            close_group(next);
+        }
+    } else {
+        cur_cycle = earliest;
+    }
+
+    // Issue into the current group
+    uint64_t t = cur_cycle;
+    group_size++;
+    group_mem |= is_mem;
+    group_ctrl |= is_ctrl;
+    instructions++;
+
+    const int lat = ex_latency(ins);
+
+    // Blocking data cache: a miss holds MEM and everything behind it
+    int mem_extra = 0;
+    if (is_mem && caches_enabled()) {
+        uint64_t when = t + lat;
+        int latency = ins.mem_read ? memory->load(r.mem_addr, when, ins.pc)
+                                   : memory->store(r.mem_addr, when, ins.pc);
+        mem_extra = latency - 1;
+        if (mem_extra > 0) ex_free = std::max(ex_free, t + 1 + mem_extra);
+    }
+
+    last_done = std::max(last_done, t + lat + config.mem_stages + mem_extra);
+
+    // Result availability: forwarded from the end of EX (end of the last
+    // MEM stage for loads), otherwise read from the register file after WB
+    if (ins.writes_rd) {
+        uint64_t ready;
+        if (!config.forwarding) ready = t + lat + config.mem_stages + mem_extra + 1;
+        else if (ins.mem_read) ready = t + lat + config.mem_stages + mem_extra;
+        else ready = t + lat;
+        reg_ready[ins.rd] = ready;
+    }
+
+    if (lat > 1 && (ins.type == InsType::DIV || ins.type == InsType::DIVU ||
+                    ins.type == InsType::REM || ins.type == InsType::REMU)) {
+        ex_free = t + lat;
+    }
+
+    if (r.taken) {
+        fetch_ready = t + redirect_delay;
+    }
+}
+
+// =============================================================================
+// Statistics
+// =============================================================================
+
+uint64_t InOrderModel::get_cycle_count() const {
+    return instructions ? last_done : 0;
+}
+
+uint64_t InOrderModel::get_instruction_count() const { return instructions; }
+
+std::string InOrderModel::stage_list() const {
+    std::string list;
+    auto add = [&list](const char* name, int count) {
+        for (int i = 1; i <= count; i++) {
+            if (!list.empty()) list += ' ';
+            list += name;
+            if (count > 1) list += std::to_string(i);
+        }
+    };
+    add("IF", config.fetch_stages);
+    add("ID", config.decode_stages);
+    add("EX", 1);
+    add("MEM", config.mem_stages);
+    add("WB", 1);
+    return list;
+}
+
+void InOrderModel::print_config() const {
+    std::cout << "In-order model: width " << config.width
+              << ", forwarding " << (config.forwarding ? "on" : "off") << "\n";
+    std::cout << "  Stages: " << stage_list()
+              << " (EX: ALU " << config.alu_latency << ", mul " << config.mul_latency
+              << ", div " << config.div_latency << ")\n";
+
+    // Derived penalties for back-to-back dependent instructions
+    int alu_use = config.forwarding ? config.alu_latency - 1
+                                    : config.alu_latency + config.mem_stages;
+    int load_use = config.forwarding ? config.alu_latency + config.mem_stages - 1
+                                     : config.alu_latency + config.mem_stages;
+    std::cout << "  Branches resolve in " << branch_stage_name(config.branch_stage)
+              << "; bubbles: taken branch " << redirect_delay - 1
+              << ", ALU-use " << alu_use << ", load-use " << load_use << "\n";
+}
+
+void InOrderModel::register_stats(StatsRegistry& stats, const std::string& prefix) const {
+    TimingModel::register_stats(stats, prefix);
+    std::vector<std::string> labels;
+    for (int k = 0; k <= MAX_WIDTH; k++) labels.push_back(std::to_string(k));
+    stats.add_histogram(prefix + ".issue", issue_hist.data(), labels,
+                        "Cycles with k instructions issued (closed groups)");
+    stats.add_counter(prefix + ".split.width", &split_width, "Groups ended full");
+    stats.add_counter(prefix + ".split.mem", &split_mem, "Groups ended by a second memory op");
+    stats.add_counter(prefix + ".split.ctrl", &split_ctrl, "Groups ended by a second branch");
+    stats.add_counter(prefix + ".split.dep", &split_dep, "Groups ended by an operand not ready");
+    stats.add_counter(prefix + ".split.redirect", &split_redirect, "Groups ended by a taken branch");
+    stats.add_counter(prefix + ".split.struct", &split_struct, "Groups ended by a busy EX");
+    stats.add_counter(prefix + ".stalls.data", &data_stall_cycles, "Data stall cycles");
+    stats.add_counter(prefix + ".stalls.control", &control_stall_cycles, "Control stall cycles");
+    stats.add_counter(prefix + ".stalls.struct", &struct_stall_cycles, "Structural stall cycles");
+}
+
+void InOrderModel::print_stats() const {
+    // Include the group still being filled
+    std::array<uint64_t, MAX_WIDTH + 1> hist = issue_hist;
+    if (group_size > 0) hist[group_size]++;
+
+    uint64_t issue_cycles = 0;
+    for (uint64_t n : hist) issue_cycles += n;
+    uint64_t slots = issue_cycles * config.width;
+    uint64_t cycles = get_cycle_count();
+
+    std::cout << "  In-order model (width " << config.width
+              << ", forwarding " << (config.forwarding ? "on" : "off")
+              << ", " << stage_list() << "):\n";
+    std::cout << "    Cycles: " << cycles << "\n";
+    std::cout << "    Instructions: " << instructions << "\n";
+    if (instructions > 0 && cycles > 0) {
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "    IPC: " << static_cast<double>(instructions) / cycles
+                  << "  CPI: " << static_cast<double>(cycles) / instructions << "\n";
+        std::cout << "    Issue slots used: " << instructions << "/" << slots << " ("
+                  << 100.0 * instructions / slots << "%)\n";
+        std::cout << "    Issue-slot utilization per cycle:\n";
+        for (int k = 0; k <= config.width; k++) {
+            std::cout << "      " << k << " issued: " << hist[k] << " cycles ("
+                      << 100.0 * hist[k] / issue_cycles << "%)\n";
+        }
+    }
+    std::cout << "    Group splits: width " << split_width << ", memory " << split_mem
+              << ", branch " << split_ctrl << ", dependency " << split_dep
+              << ", fetch/redirect " << split_redirect
+              << ", blocked (div/cache) " << split_struct << "\n";
+    std::cout << "    Stall cycles: data " << data_stall_cycles
+              << ", fetch/control " << control_stall_cycles
+              << ", blocked (div/cache) " << struct_stall_cycles << "\n";
+}
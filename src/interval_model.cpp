@@ -0,0 +1,288 @@
+/**
+ * interval_model.cpp
+ *
+ * Block-cached approximate Pipeline timing.
+ */
+
+#include "interval_model.hpp"
+#include <algorithm>
+
+IntervalModel::IntervalModel() : IntervalModel(Config()) {}
+
+IntervalModel::IntervalModel(const Config& cfg) {
+    set_config(cfg);
+}
+
+void IntervalModel::set_config(const Config& cfg) {
+    config = cfg;
+
+    // Same as Pipeline::redirect: one slot per stage from IF to the resolving one
+    redirect_penalty = static_cast<int>(config.branch_stage) + 1;
+
+    reset();
+}
+
+const IntervalModel::Config& IntervalModel::get_config() const { return config; }
+
+const char* IntervalModel::name() const { return "interval"; }
+
+void IntervalModel::reset() {
+    blocks.clear();
+    block = nullptr;
+    recording = false;
+    pos = 0;
+    expect_pc = 0;
+    block_extra = 0;
+    fetch_missed = false;
+
+    last_id = 0;
+    pending_redirect = 0;
+    use_ready.fill(0);
+    branch_ready.fill(0);
+
+    instructions = 0;
+    block_runs = 0;
+    abandoned = 0;
+    data_stalls = 0;
+    boundary_stalls = 0;
+    control_stalls = 0;
+    icache_stalls = 0;
+    dcache_stalls = 0;
+}
+
+// =============================================================================
+// Static Block Schedule
+// =============================================================================
+
+void IntervalModel::build(Block& b) const {
+    // d[j]: cycle instruction j leaves ID, relative to the first one. A
+    // consumer leaves ID two cycles after a load does (load-use); an ID
+    // comparator also waits for an ALU result to reach MEM, and for a load
+    // (or any result without forwarding) to reach WB.
+    const int n = static_cast<int>(b.recorded.size());
+    std::vector<int> d(n);
+    std::array<int, NUM_REGISTERS> use_at{};
+    std::array<int, NUM_REGISTERS> branch_at{};
+    std::array<bool, NUM_REGISTERS> written{};
+
+    for (int j = 0; j < n; j++) {
+        const Instruction& ins = b.recorded[j];
+        bool id_branch = config.branch_stage == BranchStage::ID &&
+                         (ins.branch || ins.type == InsType::JALR);
+        int t = j > 0 ? d[j - 1] + 1 : 0;
+
+        auto operand = [&](bool reads, int r) {
+            if (!reads || r == 0 || !config.hazard_detection) return;
+            if (written[r]) {
+                t = std::max(t, id_branch ? branch_at[r] : use_at[r]);
+            } else if (j < HEAD) {
+                b.head_reads.push_back({static_cast<uint8_t>(r), static_cast<uint8_t>(j), id_branch});
+            }
+        };
+        operand(ins.reads_rs1, ins.rs1);
+        operand(ins.reads_rs2, ins.rs2);
+        d[j] = t;
+
+        if (ins.writes_rd) {
+            written[ins.rd] = true;
+            use_at[ins.rd] = ins.mem_read ? t + 2 : 0;
+            branch_at[ins.rd] = t + (ins.mem_read || !config.forwarding ? 3 : 2);
+        }
+    }
+
+    b.size = n;
+    b.span = d[n - 1] + 1;
+    b.waits.resize(n);
+    for (int j = 0; j < n; j++) {
+        b.waits[j] = static_cast<uint8_t>(std::min(d[j] - (j > 0 ? d[j - 1] + 1 : 0), 255));
+    }
+    for (int j = 0; j < HEAD && j < n; j++) b.head_offset[j] = d[j];
+
+    // Writers the next block may still have to wait for
+    std::array<bool, NUM_REGISTERS> seen{};
+    for (int j = n - 1; j >= 0 && d[n - 1] - d[j] < TAIL; j--) {
+        const Instruction& ins = b.recorded[j];
+        if (!ins.writes_rd || seen[ins.rd]) continue;
+        seen[ins.rd] = true;
+        b.tail_writes.push_back({static_cast<uint8_t>(ins.rd),
+                                 static_cast<uint8_t>(d[n - 1] - d[j]), ins.mem_read});
+    }
+
+    b.recorded.clear();
+    b.recorded.shrink_to_fit();
+}
+
+// =============================================================================
+// Retire
+// =============================================================================
+
+void IntervalModel::enter(Address pc) {
+    if (block && pos > 0) {
+        // Left in the middle (set pc, trap): charge what ran one cycle each
+        abandoned++;
+        last_id += pending_redirect + pos + block_extra;
+        pending_redirect = 0;
+        if (recording) blocks.erase(expect_pc - 4 * pos);
+    }
+
+    auto [it, inserted] = blocks.try_emplace(pc);
+    block = &it->second;
+    recording = inserted;
+    pos = 0;
+    expect_pc = pc;
+    block_extra = 0;
+    fetch_missed = false;
+}
+
+void IntervalModel::retire(const RetiredInsn& r) {
+    const Instruction& ins = r.ins;
+
+    if (!block || ins.pc != expect_pc) enter(ins.pc);
+    pos++;
+    expect_pc += 4;
+    instructions++;
+
+    if (caches_enabled()) {
+        uint64_t now = last_id + pos + block_extra;
+        int fetch = memory->fetch(ins.pc, now);
+        fetch_stall[pos - 1] = fetch - 1;
+        if (fetch > 1) {
+            block_extra += fetch - 1;
+            icache_stalls += fetch - 1;
+            fetch_missed = true;
+        }
+        if (ins.mem_read || ins.mem_write) {
+            int latency = ins.mem_read ? memory->load(r.mem_addr, now + 2, ins.pc)
+                                       : memory->store(r.mem_addr, now + 2, ins.pc);
+            if (latency > 1) {
+                block_extra += latency - 1;
+                dcache_stalls += latency - 1;
+            }
+        }
+    }
+
+    bool ends;
+    if (recording) {
+        block->recorded.push_back(ins);
+        ends = ins.branch || ins.jump || ins.type == InsType::ECALL ||
+               ins.type == InsType::EBREAK || pos == MAX_BLOCK;
+        if (ends) build(*block);
+    } else {
+        ends = pos == block->size;
+    }
+
+    if (ends) complete(r.taken);
+}
+
+void IntervalModel::complete(bool taken) {
+    const Block& b = *block;
+
+    // Fresh schedule from the first ID cycle, delayed as a whole if a head
+    // instruction waits on a result from the previous block
+    uint64_t first = last_id + 1 + pending_redirect;
+    uint64_t shift = 0;
+    for (const HeadRead& h : b.head_reads) {
+        uint64_t ready = h.id_branch ? branch_ready[h.reg] : use_ready[h.reg];
+        uint64_t fresh = first + b.head_offset[h.index];
+        if (ready > fresh) shift = std::max(shift, ready - fresh);
+    }
+
+    // The Pipeline counts down a fetch miss while the instruction ahead of
+    // the delayed one still waits on operands: that part of the wait is hidden
+    uint64_t hidden = 0;
+    if (fetch_missed) {
+        for (int j = 0; j < b.size; j++) {
+            hidden += static_cast<uint64_t>(std::min<int>(fetch_stall[j], b.waits[j]));
+        }
+        icache_stalls -= hidden;
+    }
+    uint64_t end = first + shift + b.span - 1 + block_extra - hidden;
+
+    data_stalls += shift + (b.span - b.size);
+    boundary_stalls += shift;
+    control_stalls += pending_redirect;
+
+    for (const TailWrite& w : b.tail_writes) {
+        uint64_t d = end - w.back;
+        use_ready[w.reg] = w.load ? d + 2 : 0;
+        branch_ready[w.reg] = d + (w.load || !config.forwarding ? 3 : 2);
+    }
+
+    // Fetch runs on behind a taken branch until it resolves. The squashed
+    // fetches still fill the I-cache, often with lines needed next; a miss
+    // holds fetch, so none follow it.
+    if (taken && caches_enabled()) {
+        const Address branch_pc = expect_pc - 4;
+        for (int k = 1; k < redirect_penalty; k++) {
+            if (memory->fetch(branch_pc + 4 * k, end + k - 1) > 1) break;
+        }
+    }
+
+    block->executions++;
+    block_runs++;
+    last_id = end;
+    pending_redirect = taken ? redirect_penalty : 0;
+
+    block = nullptr;
+    recording = false;
+    pos = 0;
+    fetch_missed = false;
+}
+
+// =============================================================================
+// Statistics
+// =============================================================================
+
+uint64_t IntervalModel::get_cycle_count() const {
+    // The last instruction leaves ID at last_id and WB three cycles later
+    if (instructions == 0) return 0;
+    uint64_t id = last_id;
+    if (block && pos > 0) id += pending_redirect + pos + block_extra;
+    return id + 4;
+}
+
+uint64_t IntervalModel::get_instruction_count() const { return instructions; }
+
+void IntervalModel::print_config() const {
+    std::cout << "Interval model: hazards " << (config.hazard_detection ? "on" : "off")
+              << ", forwarding " << (config.forwarding ? "on" : "off")
+              << ", branches resolve in " << branch_stage_name(config.branch_stage) << "\n";
+    std::cout << "  Taken branch penalty " << redirect_penalty
+              << ", blocks up to " << MAX_BLOCK << " instructions"
+              << (caches_enabled() ? ", cache latencies" : ", perfect memory") << "\n";
+}
+
+void IntervalModel::register_stats(StatsRegistry& stats, const std::string& prefix) const {
+    TimingModel::register_stats(stats, prefix);
+    stats.add_counter(prefix + ".stalls.data", &data_stalls, "Data stall cycles");
+    stats.add_counter(prefix + ".stalls.boundary", &boundary_stalls, "Data stalls across blocks");
+    stats.add_counter(prefix + ".stalls.control", &control_stalls, "Taken branch penalty cycles");
+    stats.add_counter(prefix + ".stalls.icache", &icache_stalls, "I-cache stall cycles");
+    stats.add_counter(prefix + ".stalls.dcache", &dcache_stalls, "D-cache stall cycles");
+    stats.add_counter(prefix + ".block_runs", &block_runs, "Blocks executed");
+    stats.add_counter(prefix + ".blocks_left_early", &abandoned, "Blocks left before their end");
+    stats.add_computed(prefix + ".blocks_cached", [this] { return blocks.size(); }, "Blocks first seen and cached");
+}
+
+void IntervalModel::print_stats() const {
+    uint64_t cycles = get_cycle_count();
+
+    std::cout << "  Interval model (hazards " << (config.hazard_detection ? "on" : "off")
+              << ", forwarding " << (config.forwarding ? "on" : "off")
+              << ", branches in " << branch_stage_name(config.branch_stage) << "):\n";
+    std::cout << "    Cycles: " << cycles << "\n";
+    std::cout << "    Instructions: " << instructions << "\n";
+    if (instructions > 0 && cycles > 0) {
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "    CPI: " << static_cast<double>(cycles) / instructions << "\n";
+    }
+    std::cout << "    Stall cycles: data " << data_stalls << " (across blocks "
+              << boundary_stalls << "), control " << control_stalls
+              << ", I-cache " << icache_stalls << ", D-cache " << dcache_stalls << "\n";
+    std::cout << "    Blocks: " << blocks.size() << " cached, " << block_runs << " executed";
+    if (block_runs > 0) {
+        std::cout << " (" << std::setprecision(1)
+                  << static_cast<double>(instructions) / block_runs << " instructions each)";
+    }
+    std::cout << ", " << abandoned << " left early\n";
+}
@@ -0,0 +1,187 @@
+/**
+ * loop_profiler.cpp
+ *
+ * Back-edge loop detection, instance tracking and the loop report.
+ */
+
+#include "loop_profiler.hpp"
+#include <algorithm>
+
+LoopProfiler::LoopProfiler() : depth(0), timed(false) {}
+
+void LoopProfiler::reset() {
+    loops.clear();
+    active.clear();
+    depth = 0;
+}
+
+void LoopProfiler::set_timed(bool has_cycles) { timed = has_cycles; }
+
+bool LoopProfiler::contains(const Loop& loop, Address pc) {
+    return pc >= loop.header && pc <= loop.latch;
+}
+
+void LoopProfiler::close(const Active& a) {
+    Loop& loop = *a.loop;
+    uint64_t trip = a.trip + 1;     // The pass that left the loop
+    loop.closed++;
+    loop.trips += trip;
+    loop.max_trip = std::max(loop.max_trip, trip);
+}
+
+// =============================================================================
+// Edges
+// =============================================================================
+
+void LoopProfiler::edge(const Instruction& ins, Address target, const Counters& now) {
+    // Calls and returns only change the depth; loops of a callee end with it
+    if (ins.jump && ins.rd != 0) {
+        depth++;
+        return;
+    }
+    if (ins.type == InsType::JALR && ins.rs1 == 1) {
+        while (!active.empty() && active.back().depth >= depth) {
+            close(active.back());
+            active.pop_back();
+        }
+        if (depth > 0) depth--;
+        return;
+    }
+
+    const Address from = ins.pc;
+    const bool back = (ins.branch || ins.type == InsType::JAL) && target <= from;
+
+    // A further back edge to a known header grows the body before the
+    // containment test below
+    auto known = back ? loops.find(target) : loops.end();
+    if (known != loops.end()) known->second.latch = std::max(known->second.latch, from);
+
+    // Leaving the body (or having fallen out of it) ends the instance
+    while (!active.empty() && active.back().depth >= depth) {
+        const Active& a = active.back();
+        if (a.depth == depth && contains(*a.loop, from) && contains(*a.loop, target)) break;
+        close(a);
+        active.pop_back();
+    }
+
+    if (!back) return;
+
+    Loop& loop = loops[target];
+    if (loop.entries == 0) {
+        loop.header = target;
+        loop.latch = from;
+    }
+
+    if (!active.empty() && active.back().loop == &loop) {
+        Active& a = active.back();
+        a.trip++;
+        loop.iterations++;
+        loop.cost.instructions += now.instructions - a.last.instructions;
+        loop.cost.cycles += now.cycles - a.last.cycles;
+        loop.cost.data_stalls += now.data_stalls - a.last.data_stalls;
+        loop.cost.control_stalls += now.control_stalls - a.last.control_stalls;
+        loop.cost.icache_stalls += now.icache_stalls - a.last.icache_stalls;
+        loop.cost.dcache_stalls += now.dcache_stalls - a.last.dcache_stalls;
+        a.last = now;
+    } else {
+        loop.entries++;
+        active.push_back({&loop, depth, 1, now});
+    }
+}
+
+// =============================================================================
+// Report
+// =============================================================================
+
+static std::string label_of(Address pc, const std::map<std::string, Address>& symbols) {
+    // Exact label, else the closest one before pc
+    const std::string* best = nullptr;
+    Address best_addr = 0;
+    for (const auto& [name, addr] : symbols) {
+        if (addr > pc) continue;
+        if (!best || addr > best_addr) {
+            best = &name;
+            best_addr = addr;
+        }
+    }
+    if (!best) return "?";
+    if (best_addr == pc) return *best;
+    std::ostringstream s;
+    s << *best << "+0x" << std::hex << (pc - best_addr);
+    return s.str();
+}
+
+void LoopProfiler::print_report(const std::map<std::string, Address>& symbols) const {
+    static constexpr size_t MAX_REPORT = 20;
+
+    // Open instances count with the trip they have reached
+    struct Row {
+        const Loop* loop;
+        uint64_t entries;
+        uint64_t trips;
+        uint64_t max_trip;
+    };
+    std::vector<Row> rows;
+    for (const auto& [header, loop] : loops) {
+        Row r{&loop, loop.closed, loop.trips, loop.max_trip};
+        for (const Active& a : active) {
+            if (a.loop != &loop) continue;
+            r.entries++;
+            r.trips += a.trip + 1;
+            r.max_trip = std::max(r.max_trip, a.trip + 1);
+        }
+        rows.push_back(r);
+    }
+    std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+        if (a.loop->cost.instructions != b.loop->cost.instructions) {
+            return a.loop->cost.instructions > b.loop->cost.instructions;
+        }
+        return a.loop->header < b.loop->header;
+    });
+
+    std::cout << "Loops: " << rows.size() << " found"
+              << (timed ? ", per-iteration cycles and stall cycles from the pipeline" : "")
+              << "\n";
+    if (rows.empty()) return;
+
+    std::cout << "  " << std::left << std::setw(20) << "Loop" << std::setw(24) << "Body"
+              << std::right << std::setw(9) << "Entries" << std::setw(10) << "Avg trip"
+              << std::setw(10) << "Max trip" << std::setw(11) << "Insns/it";
+    if (timed) {
+        std::cout << std::setw(11) << "Cycles/it" << std::setw(7) << "CPI"
+                  << std::setw(8) << "Data" << std::setw(8) << "Ctrl"
+                  << std::setw(8) << "I$" << std::setw(8) << "D$";
+    }
+    std::cout << "\n";
+
+    std::cout << std::fixed << std::setprecision(1);
+    for (size_t i = 0; i < rows.size() && i < MAX_REPORT; i++) {
+        const Row& r = rows[i];
+        const Loop& loop = *r.loop;
+        const Counters& c = loop.cost;
+        const double n = static_cast<double>(loop.iterations);
+
+        std::cout << "  " << std::left << std::setw(20) << label_of(loop.header, symbols)
+                  << std::setw(24) << (to_hex(loop.header) + "-" + to_hex(loop.latch))
+                  << std::right << std::setw(9) << r.entries
+                  << std::setw(10) << (r.entries ? static_cast<double>(r.trips) / r.entries : 0.0)
+                  << std::setw(10) << r.max_trip;
+        if (loop.iterations == 0) {
+            std::cout << std::setw(11) << "-" << "\n";
+            continue;
+        }
+        std::cout << std::setw(11) << c.instructions / n;
+        if (timed) {
+            std::cout << std::setw(11) << c.cycles / n << std::setw(7) << std::setprecision(2)
+                      << (c.instructions ? static_cast<double>(c.cycles) / c.instructions : 0.0)
+                      << std::setprecision(1)
+                      << std::setw(8) << c.data_stalls / n << std::setw(8) << c.control_stalls / n
+                      << std::setw(8) << c.icache_stalls / n << std::setw(8) << c.dcache_stalls / n;
+        }
+        std::cout << "\n";
+    }
+    if (rows.size() > MAX_REPORT) {
+        std::cout << "  ... " << rows.size() - MAX_REPORT << " more\n";
+    }
+    if (timed) std::cout << "  Stall columns are cycles per iteration (Ctrl: squashed slots)\n";
+}
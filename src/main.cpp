@@ -2,16 +2,45 @@
  * main.cpp
  * 
  * Entry point for the RISC-V emulator.
+ *
+ * Usage: riscv-emu [program.asm] [-x script] [-a start end]
+ *   -x script   Run commands from a script file without prompts, then exit
+ *   -a start end  Report the pipeline throughput of a block, then exit
  */
 
 #include "emulator.hpp"
+#include "watchdog.hpp"
 
 int main(int argc, char* argv[]) {
     Emulator emu;
+    std::string script;
+    std::string analyze;
 
-    // If a file is provided as argument, load it
-    if (argc > 1) {
-        emu.load(argv[1]);
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-x" && i + 1 < argc) {
+            script = argv[++i];
+        } else if (arg == "-a" && i + 2 < argc) {
+            analyze = std::string("analyze ") + argv[i + 1] + " " + argv[i + 2];
+            i += 2;
+        } else {
+            // If a file is provided as argument, load it
+            emu.load(arg);
+        }
+    }
+
+    // Static block analysis
+    if (!analyze.empty()) {
+        emu.execute_command(analyze);
+        return 0;
+    }
+
+    // Non-interactive batch mode
+    if (!script.empty()) {
+        // Ctrl-C stops a running program here too, not the whole batch
+        Watchdog::install_interrupt_handler();
+        emu.run_script(script);
+        return 0;
     }
 
     // Run the interactive command loop
@@ -99,6 +99,21 @@ void Memory::write_bytes(Address addr, const std::vector<Byte>& bytes) {
     }
 }
 
+// =============================================================================
+// Peek
+// =============================================================================
+
+Word Memory::peek_word(Address addr) const {
+    Word val = 0;
+    for (int j = 0; j < 4; j++) {
+        auto it = mem.find(addr + j);
+        if (it != mem.end()) {
+            val |= static_cast<Word>(it->second) << (j * 8);
+        }
+    }
+    return val;
+}
+
 // =============================================================================
 // Display
 // =============================================================================
@@ -135,20 +150,14 @@ void Memory::dump(Address start, size_t bytes) const {
         }
         std::cout << "|\n";
     }
-    std::cout << std::dec;
+    std::cout << std::dec << std::setfill(' ');
 }
 
 void Memory::dump_words(Address start, size_t count) const {
     std::cout << "Memory words [" << to_hex(start) << "]:\n";
     for (size_t i = 0; i < count; i++) {
         Address addr = start + i * 4;
-        Word val = 0;
-        for (int j = 0; j < 4; j++) {
-            auto it = mem.find(addr + j);
-            if (it != mem.end()) {
-                val |= static_cast<Word>(it->second) << (j * 8);
-            }
-        }
+        Word val = peek_word(addr);
         std::cout << "  " << to_hex(addr) << ": " << to_hex(val) << "\n";
     }
 }
@@ -168,3 +177,8 @@ uint64_t Memory::get_read_count() const {
 uint64_t Memory::get_write_count() const {
     return write_count;
 }
+
+void Memory::register_stats(StatsRegistry& stats, const std::string& prefix) const {
+    stats.add_counter(prefix + ".reads", &read_count, "Functional reads (all engines)");
+    stats.add_counter(prefix + ".writes", &write_count, "Functional writes (all engines)");
+}
@@ -0,0 +1,237 @@
+/**
+ * memory_hierarchy.cpp
+ *
+ * Cache hierarchy construction and configuration file parsing.
+ */
+
+#include "memory_hierarchy.hpp"
+#include "miss_profiler.hpp"
+#include <algorithm>
+
+static Cache::Config make_cache_config(uint32_t size, int assoc, int latency) {
+    Cache::Config config;
+    config.size = size;
+    config.assoc = assoc;
+    config.latency = latency;
+    return config;
+}
+
+MemoryHierarchy::MemoryHierarchy()
+    : enabled(false),
+      dram(Dram::Config()),
+      l2("L2", make_cache_config(256 * 1024, 8, 10), &dram),
+      l1i("L1I", make_cache_config(16 * 1024, 4, 1), &l2),
+      l1d("L1D", make_cache_config(32 * 1024, 8, 1), &l2),
+      profiler(nullptr) {}
+
+void MemoryHierarchy::set_enabled(bool on) {
+    enabled = on;
+    reset();
+}
+
+bool MemoryHierarchy::set_prefetcher(const std::string& level, const Prefetcher::Config& config) {
+    if (level == "l1i") l1i.set_prefetcher(config);
+    else if (level == "l1d") l1d.set_prefetcher(config);
+    else return false;
+    return true;
+}
+
+void MemoryHierarchy::copy_config(const MemoryHierarchy& other) {
+    enabled = other.enabled;
+    l1i.configure(other.l1i.get_config());
+    l1d.configure(other.l1d.get_config());
+    l2.configure(other.l2.get_config());
+    dram.configure(other.dram.get_config());
+    l1i.set_prefetcher(other.l1i.get_prefetcher_config());
+    l1d.set_prefetcher(other.l1d.get_prefetcher_config());
+    profiler = nullptr;
+    reset();
+}
+
+void MemoryHierarchy::reset() {
+    l1i.reset();
+    l1d.reset();
+    l2.reset();
+    dram.reset();
+    if (profiler) profiler->reset();
+}
+
+// A miss that takes longer than an L2 hit was served by DRAM; latency
+// beyond the L1 hit is stall time unless the access is off the critical path
+int MemoryHierarchy::profiled(Address addr, bool write, uint64_t now, Address pc, bool waits) {
+    const uint64_t misses = l1d.get_misses();
+    const int latency = l1d.demand_access(addr, write, now, pc);
+    const int hit = l1d.get_config().latency;
+    const bool miss = l1d.get_misses() != misses;
+    const bool dram_fill = miss && latency > hit + l2.get_config().latency;
+    profiler->record(pc, addr, miss, dram_fill, waits ? std::max(latency - hit, 0) : 0);
+    return latency;
+}
+
+// =============================================================================
+// Configuration File
+// =============================================================================
+
+bool MemoryHierarchy::load_config(const std::string& filename, std::string& error) {
+    std::ifstream file(filename);
+    if (!file) {
+        error = "cannot open " + filename;
+        return false;
+    }
+
+    Cache::Config l1i_cfg = l1i.get_config();
+    Cache::Config l1d_cfg = l1d.get_config();
+    Cache::Config l2_cfg = l2.get_config();
+    Dram::Config dram_cfg = dram.get_config();
+    Prefetcher::Config l1i_pf = l1i.get_prefetcher_config();
+    Prefetcher::Config l1d_pf = l1d.get_prefetcher_config();
+
+    std::string line;
+    int line_num = 0;
+    while (std::getline(file, line)) {
+        line_num++;
+        std::string where = filename + ":" + std::to_string(line_num) + ": ";
+
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line = line.substr(0, hash);
+
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            if (line.find_first_not_of(" \t\r") != std::string::npos) {
+                error = where + "expected 'level.key = value'";
+                return false;
+            }
+            continue;
+        }
+
+        auto trim = [](std::string s) {
+            size_t b = s.find_first_not_of(" \t\r");
+            size_t e = s.find_last_not_of(" \t\r");
+            return b == std::string::npos ? std::string() : s.substr(b, e - b + 1);
+        };
+        std::string key = trim(line.substr(0, eq));
+        std::string value_str = trim(line.substr(eq + 1));
+        std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+
+        size_t dot = key.find('.');
+        std::string level = key.substr(0, dot);
+        std::string param = dot == std::string::npos ? "" : key.substr(dot + 1);
+
+        Prefetcher::Config* pf_cfg = nullptr;
+        if (level == "l1i") pf_cfg = &l1i_pf;
+        else if (level == "l1d") pf_cfg = &l1d_pf;
+
+        // The prefetcher type is the only non-numeric value
+        if (pf_cfg && param == "prefetcher") {
+            if (!Prefetcher::parse_type(value_str, pf_cfg->type)) {
+                error = where + "unknown prefetcher '" + value_str + "'";
+                return false;
+            }
+            continue;
+        }
+
+        long value;
+        try {
+            size_t used;
+            value = std::stol(value_str, &used, 0);
+            // Allow size suffixes: 32K, 1M
+            std::string suffix = value_str.substr(used);
+            if (suffix == "K" || suffix == "k") value *= 1024;
+            else if (suffix == "M" || suffix == "m") value *= 1024 * 1024;
+            else if (!suffix.empty()) throw std::invalid_argument(suffix);
+        } catch (...) {
+            error = where + "invalid value '" + value_str + "'";
+            return false;
+        }
+
+        Cache::Config* cache_cfg = nullptr;
+        if (level == "l1i") cache_cfg = &l1i_cfg;
+        else if (level == "l1d") cache_cfg = &l1d_cfg;
+        else if (level == "l2") cache_cfg = &l2_cfg;
+
+        bool known = true;
+        if (cache_cfg) {
+            if (param == "size") cache_cfg->size = value;
+            else if (param == "line") cache_cfg->line_size = value;
+            else if (param == "assoc") cache_cfg->assoc = value;
+            else if (param == "latency") cache_cfg->latency = value;
+            else if (pf_cfg && param == "pf_degree") pf_cfg->degree = value;
+            else if (pf_cfg && param == "pf_distance") pf_cfg->distance = value;
+            else known = false;
+        } else if (level == "dram") {
+            if (param == "banks") dram_cfg.banks = value;
+            else if (param == "row") dram_cfg.row_size = value;
+            else if (param == "trcd") dram_cfg.t_rcd = value;
+            else if (param == "tcl") dram_cfg.t_cl = value;
+            else if (param == "trp") dram_cfg.t_rp = value;
+            else if (param == "bus") dram_cfg.bus_latency = value;
+            else known = false;
+        } else {
+            known = false;
+        }
+        if (!known) {
+            error = where + "unknown setting '" + key + "'";
+            return false;
+        }
+    }
+
+    // Validate everything before changing anything
+    const std::pair<const char*, Cache::Config*> caches[] = {
+        {"l1i", &l1i_cfg}, {"l1d", &l1d_cfg}, {"l2", &l2_cfg}
+    };
+    for (const auto& [name, cfg] : caches) {
+        if (!Cache::validate(*cfg, error)) {
+            error = filename + ": " + name + ": " + error;
+            return false;
+        }
+    }
+    if (!Dram::validate(dram_cfg, error)) {
+        error = filename + ": dram: " + error;
+        return false;
+    }
+    for (const Prefetcher::Config* pf : {&l1i_pf, &l1d_pf}) {
+        if (pf->degree < 1 || pf->distance < 1) {
+            error = filename + ": prefetch degree and distance must be at least 1";
+            return false;
+        }
+    }
+
+    l1i.configure(l1i_cfg);
+    l1d.configure(l1d_cfg);
+    l2.configure(l2_cfg);
+    dram.configure(dram_cfg);
+    l1i.set_prefetcher(l1i_pf);
+    l1d.set_prefetcher(l1d_pf);
+    enabled = true;
+    reset();
+    return true;
+}
+
+// =============================================================================
+// Display
+// =============================================================================
+
+void MemoryHierarchy::print_config() const {
+    std::cout << "Cache hierarchy: " << (enabled ? "on" : "off") << "\n";
+    l1i.print_config();
+    l1d.print_config();
+    l2.print_config();
+    dram.print_config();
+}
+
+void MemoryHierarchy::register_stats(StatsRegistry& stats, const std::string& prefix) const {
+    stats.remove(prefix);
+    l1i.register_stats(stats, prefix + ".l1i");
+    l1d.register_stats(stats, prefix + ".l1d");
+    l2.register_stats(stats, prefix + ".l2");
+    dram.register_stats(stats, prefix + ".dram");
+}
+
+void MemoryHierarchy::print_stats() const {
+    if (!enabled) return;
+    std::cout << "  Cache hierarchy:\n";
+    l1i.print_stats();
+    l1d.print_stats();
+    l2.print_stats();
+    dram.print_stats();
+}
@@ -0,0 +1,195 @@
+/**
+ * miss_profiler.cpp
+ *
+ * Per-instruction and per-object miss counts and the delinquent-load report.
+ */
+
+#include "miss_profiler.hpp"
+#include "decoder.hpp"
+#include <algorithm>
+
+MissProfiler::MissProfiler() : text_addr(0), data_end(0), stack_floor(0) {
+    configure(Assembler::Result());
+}
+
+void MissProfiler::configure(const Assembler::Result& program) {
+    text_addr = program.text_addr;
+    text = program.text;
+    by_pc.assign(text.size(), Counts());
+
+    const Address data_addr = program.data_addr;
+    data_end = data_addr + static_cast<Address>(program.data.size());
+    stack_floor = data_end + (Memory::STACK_TOP - data_end) / 2;
+
+    // Symbols are by name; order the data and text ones by address. Of
+    // several names for one address the first is kept.
+    std::vector<std::pair<Address, std::string>> data_syms;
+    labels.clear();
+    for (const auto& [name, addr] : program.symbols) {
+        if (addr >= data_addr && addr < data_end) {
+            data_syms.emplace_back(addr, name);
+        } else if (addr >= text_addr && addr - text_addr < 4 * text.size()) {
+            labels.emplace_back(addr, name);
+        }
+    }
+    std::sort(data_syms.begin(), data_syms.end());
+    std::sort(labels.begin(), labels.end());
+
+    objects.clear();
+    starts.clear();
+    if (data_end > data_addr && (data_syms.empty() || data_syms.front().first > data_addr)) {
+        data_syms.insert(data_syms.begin(), {data_addr, "[data]"});
+    }
+    for (size_t i = 0; i < data_syms.size(); i++) {
+        const Address start = data_syms[i].first;
+        if (!starts.empty() && starts.back() == start) continue;
+        const Address end = i + 1 < data_syms.size() ? data_syms[i + 1].first : data_end;
+        objects.push_back({data_syms[i].second, start, end, Counts()});
+        starts.push_back(start);
+    }
+    objects.push_back({"[stack]", stack_floor, Memory::STACK_TOP, Counts()});
+    objects.push_back({"[other]", 0, 0, Counts()});
+
+    reset();
+}
+
+void MissProfiler::reset() {
+    std::fill(by_pc.begin(), by_pc.end(), Counts());
+    for (Object& o : objects) o.counts = Counts();
+    other_pc = Counts();
+    total = Counts();
+}
+
+// =============================================================================
+// Attribution
+// =============================================================================
+
+static void add(MissProfiler::Counts& c, bool miss, bool dram, int stall_cycles) {
+    c.accesses++;
+    c.misses += miss;
+    c.dram += dram;
+    c.stall_cycles += static_cast<uint64_t>(stall_cycles);
+}
+
+size_t MissProfiler::object_of(Address addr) const {
+    if (!starts.empty() && addr >= starts.front() && addr < data_end) {
+        return static_cast<size_t>(std::upper_bound(starts.begin(), starts.end(), addr) -
+                                   starts.begin()) - 1;
+    }
+    return addr >= stack_floor ? starts.size() : starts.size() + 1;
+}
+
+void MissProfiler::record(Address pc, Address addr, bool miss, bool dram, int stall_cycles) {
+    const Address offset = pc - text_addr;
+    add(offset / 4 < by_pc.size() ? by_pc[offset / 4] : other_pc, miss, dram, stall_cycles);
+    add(objects[object_of(addr)].counts, miss, dram, stall_cycles);
+    add(total, miss, dram, stall_cycles);
+}
+
+// =============================================================================
+// Report
+// =============================================================================
+
+std::string MissProfiler::location(Address pc) const {
+    auto it = std::upper_bound(labels.begin(), labels.end(), pc,
+                               [](Address a, const auto& label) { return a < label.first; });
+    if (it == labels.begin()) return "?";
+    --it;
+    if (it->first == pc) return it->second;
+    std::ostringstream s;
+    s << it->second << "+0x" << std::hex << (pc - it->first);
+    return s.str();
+}
+
+static bool heavier(const MissProfiler::Counts& a, const MissProfiler::Counts& b,
+                    MissProfiler::Order order) {
+    if (order == MissProfiler::Order::STALLS && a.stall_cycles != b.stall_cycles) {
+        return a.stall_cycles > b.stall_cycles;
+    }
+    if (a.misses != b.misses) return a.misses > b.misses;
+    return a.stall_cycles > b.stall_cycles;
+}
+
+static void print_counts(const MissProfiler::Counts& c, uint64_t all_stalls) {
+    std::cout << std::setw(10) << c.accesses << std::setw(9) << c.misses
+              << std::setw(8) << 100.0 * c.misses / c.accesses << "%"
+              << std::setw(8) << c.dram << std::setw(11) << c.stall_cycles
+              << std::setw(8) << (all_stalls ? 100.0 * c.stall_cycles / all_stalls : 0.0) << "%\n";
+}
+
+static void print_counts_header() {
+    std::cout << std::setw(10) << "Accesses" << std::setw(9) << "Misses" << std::setw(9) << "Miss%"
+              << std::setw(8) << "DRAM" << std::setw(11) << "Stall cyc" << std::setw(9) << "Stall%"
+              << "\n";
+}
+
+void MissProfiler::print_report(size_t top, Order order) const {
+    std::cout << "Data accesses: " << total.accesses << ", L1D misses: " << total.misses;
+    if (total.accesses) {
+        std::cout << " (" << std::fixed << std::setprecision(2)
+                  << 100.0 * total.misses / total.accesses << "%)";
+    }
+    std::cout << ", served by DRAM: " << total.dram
+              << ", stall cycles beyond L1D hit: " << total.stall_cycles << "\n";
+    if (total.misses == 0 && total.stall_cycles == 0) return;
+
+    const char* by = order == Order::STALLS ? "stall cycles" : "misses";
+    std::cout << std::fixed << std::setprecision(1);
+
+    // Instructions
+    std::vector<size_t> rows;
+    for (size_t i = 0; i < by_pc.size(); i++) {
+        if (by_pc[i].misses || by_pc[i].stall_cycles) rows.push_back(i);
+    }
+    std::sort(rows.begin(), rows.end(), [this, order](size_t a, size_t b) {
+        if (heavier(by_pc[a], by_pc[b], order)) return true;
+        if (heavier(by_pc[b], by_pc[a], order)) return false;
+        return a < b;
+    });
+
+    std::cout << "\nInstructions by " << by << ":\n";
+    std::cout << "  " << std::left << std::setw(12) << "PC" << std::setw(20) << "Location"
+              << std::setw(24) << "Instruction" << std::right;
+    print_counts_header();
+    for (size_t i = 0; i < rows.size() && i < top; i++) {
+        const Address pc = text_addr + 4 * static_cast<Address>(rows[i]);
+        std::cout << "  " << std::left << std::setw(12) << to_hex(pc) << std::setw(20)
+                  << location(pc) << std::setw(24) << Decoder::decode(text[rows[i]], pc).text
+                  << std::right;
+        print_counts(by_pc[rows[i]], total.stall_cycles);
+    }
+    if (rows.size() > top) std::cout << "  ... " << rows.size() - top << " more\n";
+    if (other_pc.accesses) {
+        std::cout << "  " << std::left << std::setw(56) << "(outside the text segment)"
+                  << std::right;
+        print_counts(other_pc, total.stall_cycles);
+    }
+
+    // Data objects
+    std::vector<const Object*> objs;
+    for (const Object& o : objects) {
+        if (o.counts.misses || o.counts.stall_cycles) objs.push_back(&o);
+    }
+    std::stable_sort(objs.begin(), objs.end(), [order](const Object* a, const Object* b) {
+        return heavier(a->counts, b->counts, order);
+    });
+
+    std::cout << "\nData objects by " << by << ":\n";
+    std::cout << "  " << std::left << std::setw(20) << "Object" << std::setw(24) << "Range"
+              << std::right << std::setw(12) << "Size";
+    print_counts_header();
+    for (size_t i = 0; i < objs.size() && i < top; i++) {
+        const Object& o = *objs[i];
+        const bool sized = static_cast<size_t>(&o - objects.data()) < starts.size();
+        std::cout << "  " << std::left << std::setw(20) << o.name << std::setw(24)
+                  << (sized ? to_hex(o.start) + "-" + to_hex(o.end - 1) : std::string("-"))
+                  << std::right << std::setw(12)
+                  << (sized ? std::to_string(o.end - o.start) : std::string("-"));
+        print_counts(o.counts, total.stall_cycles);
+    }
+    if (objs.size() > top) std::cout << "  ... " << objs.size() - top << " more\n";
+    if (objects[starts.size()].counts.accesses || objects[starts.size() + 1].counts.accesses) {
+        std::cout << "  [stack] is the upper half of the space above the data segment, "
+                     "[other] the rest\n";
+    }
+}
@@ -0,0 +1,400 @@
+/**
+ * ooo_model.cpp
+ *
+ * Out-of-order core timing model implementation.
+ */
+
+#include "ooo_model.hpp"
+#include <algorithm>
+
+OoOModel::OoOModel() : OoOModel(Config()) {}
+
+OoOModel::OoOModel(const Config& cfg) {
+    set_config(cfg);
+}
+
+void OoOModel::set_config(const Config& cfg) {
+    config = cfg;
+    config.width = std::clamp(config.width, 1, MAX_WIDTH);
+    config.rob_size = std::max(config.rob_size, 1);
+    config.iq_size = std::max(config.iq_size, 1);
+    config.phys_regs = std::max(config.phys_regs, NUM_REGISTERS + 1);
+    config.lq_size = std::max(config.lq_size, 1);
+    config.sq_size = std::max(config.sq_size, 1);
+    config.alu_units = std::clamp(config.alu_units, 1, MAX_UNITS);
+    config.branch_units = std::clamp(config.branch_units, 1, MAX_UNITS);
+    config.mul_units = std::clamp(config.mul_units, 1, MAX_UNITS);
+    config.mem_units = std::clamp(config.mem_units, 1, MAX_UNITS);
+    config.frontend_depth = std::max(config.frontend_depth, 1);
+
+    units[FU_ALU] = config.alu_units;
+    units[FU_BRANCH] = config.branch_units;
+    units[FU_MUL] = config.mul_units;
+    units[FU_MEM] = config.mem_units;
+    reset();
+}
+
+const OoOModel::Config& OoOModel::get_config() const { return config; }
+
+const char* OoOModel::name() const { return "ooo"; }
+
+void OoOModel::reset() {
+    fetch_cycle = 1;
+    fetch_count = 0;
+    fetch_ready = 1;
+    ras.fill(0);
+    ras_top = 0;
+
+    dispatch_cycle = 0;
+    dispatch_count = 0;
+
+    rob.assign(config.rob_size, 0);
+    lq.assign(config.lq_size, 0);
+    sq.assign(config.sq_size, 0);
+    loads = 0;
+    stores = 0;
+    iq = decltype(iq)();
+
+    // x1-x31 start mapped to p1-p31; p0 is the hardwired zero
+    for (int i = 0; i < NUM_REGISTERS; i++) rat[i] = i;
+    preg_ready.assign(config.phys_regs, 0);
+    free_list.resize(config.phys_regs - NUM_REGISTERS);
+    for (size_t i = 0; i < free_list.size(); i++) free_list[i] = NUM_REGISTERS + i;
+    free_at.assign(free_list.size(), 0);
+    free_head = 0;
+
+    store_ready.clear();
+    store_prune_at = STORE_PRUNE_MIN;
+    calendar.assign(CALENDAR_SIZE, CalendarSlot());
+
+    commit_cycle = 0;
+    commit_count = 0;
+
+    instructions = 0;
+    branches = 0;
+    mispredicts = 0;
+    stall_rob = 0;
+    stall_iq = 0;
+    stall_regs = 0;
+    stall_lsq = 0;
+    rob_occupancy = 0;
+    iq_occupancy = 0;
+    std::fill(std::begin(fu_busy), std::end(fu_busy), 0);
+}
+
+// =============================================================================
+// Instruction Classes
+// =============================================================================
+
+OoOModel::FuClass OoOModel::fu_class(const Instruction& ins) {
+    if (ins.mem_read || ins.mem_write) return FU_MEM;
+    if (ins.branch || ins.jump) return FU_BRANCH;
+    switch (ins.type) {
+        case InsType::MUL: case InsType::MULH: case InsType::MULHSU: case InsType::MULHU:
+        case InsType::DIV: case InsType::DIVU: case InsType::REM: case InsType::REMU:
+            return FU_MUL;
+        default:
+            return FU_ALU;
+    }
+}
+
+int OoOModel::latency(const Instruction& ins) {
+    if (ins.mem_read) return LOAD_LATENCY;
+    switch (ins.type) {
+        case InsType::MUL: case InsType::MULH: case InsType::MULHSU: case InsType::MULHU:
+            return MUL_LATENCY;
+        case InsType::DIV: case InsType::DIVU: case InsType::REM: case InsType::REMU:
+            return DIV_LATENCY;
+        default:
+            return 1;
+    }
+}
+
+// =============================================================================
+// Branch Prediction (static BTFN plus return address stack)
+// =============================================================================
+
+bool OoOModel::predict(const RetiredInsn& r) {
+    const Instruction& ins = r.ins;
+
+    if (ins.branch) {
+        return (ins.imm < 0) == r.taken;
+    }
+
+    bool is_return = ins.type == InsType::JALR && ins.rd == 0 && ins.rs1 == 1;
+    if (is_return) {
+        Address target = ras[ras_top];
+        ras_top = (ras_top + RAS_SIZE - 1) % RAS_SIZE;
+        return target == r.next_pc;
+    }
+
+    if (ins.rd == 1) {
+        ras_top = (ras_top + 1) % RAS_SIZE;
+        ras[ras_top] = ins.pc + 4;
+    }
+
+    // JAL targets are known at decode; other indirect jumps are not predicted
+    return ins.type == InsType::JAL;
+}
+
+// =============================================================================
+// Functional Unit Calendar
+// =============================================================================
+
+// A slot after the dispatch cycle may still be looked up; it must not be
+// recycled for another cycle
+OoOModel::CalendarSlot& OoOModel::slot(uint64_t cycle) {
+    while (true) {
+        CalendarSlot& s = calendar[cycle % calendar.size()];
+        if (s.cycle == cycle) return s;
+        if (s.cycle <= dispatch_cycle) {
+            s = CalendarSlot();
+            s.cycle = cycle;
+            return s;
+        }
+        grow_calendar();
+    }
+}
+
+// Double the calendar, keeping the live slots. Cycles that differ modulo
+// the old size still differ modulo the new one.
+void OoOModel::grow_calendar() {
+    std::vector<CalendarSlot> old(calendar.size() * 2);
+    old.swap(calendar);
+    for (const CalendarSlot& s : old) {
+        if (s.cycle > dispatch_cycle) calendar[s.cycle % calendar.size()] = s;
+    }
+}
+
+uint64_t OoOModel::schedule(FuClass fu, uint64_t earliest, int occupancy) {
+    const unsigned all = (1u << units[fu]) - 1;
+
+    for (uint64_t c = earliest; ; c++) {
+        const CalendarSlot& s = slot(c);
+        if (s.issued >= config.width) continue;
+
+        // Unpipelined units must stay free for the whole occupancy. Looking
+        // ahead may grow the calendar, so s is not used past this point.
+        unsigned free_units = all & ~s.busy[fu];
+        for (int k = 1; k < occupancy && free_units; k++) {
+            free_units &= ~slot(c + k).busy[fu];
+        }
+        if (!free_units) continue;
+
+        unsigned bit = free_units & (~free_units + 1);
+        slot(c).issued++;
+        for (int k = 0; k < occupancy; k++) {
+            slot(c + k).busy[fu] |= bit;
+        }
+        return c;
+    }
+}
+
+// =============================================================================
+// Memory Dependences
+// =============================================================================
+
+// A later load issues after the dispatch cycle anyway
+void OoOModel::prune_store_ready() {
+    for (auto it = store_ready.begin(); it != store_ready.end();) {
+        if (it->second <= dispatch_cycle + 1) it = store_ready.erase(it);
+        else ++it;
+    }
+    store_prune_at = std::max(STORE_PRUNE_MIN, 2 * store_ready.size());
+}
+
+// =============================================================================
+// Retire
+// =============================================================================
+
+void OoOModel::retire(const RetiredInsn& r) {
+    const Instruction& ins = r.ins;
+    const FuClass fu = fu_class(ins);
+    const uint64_t seq = instructions;
+
+    // Fetch: 'width' per cycle, a taken branch ends the fetch group
+    uint64_t f = std::max(fetch_cycle, fetch_ready);
+    if (f == fetch_cycle && fetch_count >= config.width) f++;
+    if (caches_enabled()) {
+        int fetch_latency = memory->fetch(ins.pc, f);
+        if (fetch_latency > 1) {
+            f += fetch_latency - 1;
+            fetch_ready = f;
+        }
+    }
+    if (f != fetch_cycle) {
+        fetch_cycle = f;
+        fetch_count = 0;
+    }
+    fetch_count++;
+
+    bool correct = true;
+    if (ins.branch || ins.jump) {
+        branches++;
+        correct = predict(r);
+    }
+    if (r.taken) fetch_count = config.width;
+
+    // Dispatch in order, once every structure has a free entry
+    uint64_t d = std::max(dispatch_cycle, f + config.frontend_depth);
+    if (d == dispatch_cycle && dispatch_count >= config.width) d++;
+
+    auto wait = [&d](uint64_t ready, uint64_t& stalls) {
+        if (ready > d) {
+            stalls += ready - d;
+            d = ready;
+        }
+    };
+
+    if (seq >= rob.size()) wait(rob[seq % rob.size()], stall_rob);
+    if (ins.mem_read && loads >= lq.size()) wait(lq[loads % lq.size()], stall_lsq);
+    if (ins.mem_write && stores >= sq.size()) wait(sq[stores % sq.size()], stall_lsq);
+
+    const bool renames = ins.writes_rd;
+    if (renames) wait(free_at[free_head], stall_regs);
+
+    while (!iq.empty() && iq.top() <= d) iq.pop();
+    if (iq.size() >= static_cast<size_t>(config.iq_size)) {
+        wait(iq.top(), stall_iq);
+        while (!iq.empty() && iq.top() <= d) iq.pop();
+    }
+
+    if (d != dispatch_cycle) {
+        dispatch_cycle = d;
+        dispatch_count = 0;
+    }
+    dispatch_count++;
+
+    // Issue: wake up when all source tags are ready, then find a unit
+    uint64_t ready = d + 1;
+    if (ins.reads_rs1 && ins.rs1 != 0) ready = std::max(ready, preg_ready[rat[ins.rs1]]);
+    if (ins.reads_rs2 && ins.rs2 != 0) ready = std::max(ready, preg_ready[rat[ins.rs2]]);
+
+    const Address word = r.mem_addr & ~3u;
+    if (ins.mem_read) {
+        auto it = store_ready.find(word);
+        if (it != store_ready.end()) ready = std::max(ready, it->second);
+    }
+
+    int lat = latency(ins);
+    const int occupancy = (fu == FU_MUL && lat == DIV_LATENCY) ? lat : 1;
+    const uint64_t issue = schedule(fu, ready, occupancy);
+
+    // Address generation, then the cache hierarchy; stores complete into the SQ
+    if (caches_enabled()) {
+        if (ins.mem_read) lat = 1 + memory->load(r.mem_addr, issue + 1, ins.pc);
+        else if (ins.mem_write) memory->store(r.mem_addr, issue + 1, ins.pc);
+    }
+    const uint64_t complete = issue + lat;
+    iq.push(issue);
+
+    if (ins.mem_write) {
+        store_ready[word] = complete;
+        if (store_ready.size() >= store_prune_at) prune_store_ready();
+    }
+
+    // Mispredicted control flow redirects fetch once it resolves
+    if (!correct) {
+        mispredicts++;
+        fetch_ready = std::max(fetch_ready, complete + 1);
+    }
+
+    // Commit in order, 'width' per cycle
+    uint64_t c = std::max(commit_cycle, complete + 1);
+    if (c == commit_cycle && commit_count >= config.width) c++;
+    if (c != commit_cycle) {
+        commit_cycle = c;
+        commit_count = 0;
+    }
+    commit_count++;
+
+    rob[seq % rob.size()] = c;
+    if (ins.mem_read) lq[loads++ % lq.size()] = c;
+    if (ins.mem_write) sq[stores++ % sq.size()] = c;
+
+    // Rename the destination; the previous mapping is freed at commit
+    if (renames) {
+        int preg = free_list[free_head];
+        preg_ready[preg] = complete;
+        free_list[free_head] = rat[ins.rd];
+        free_at[free_head] = c;
+        free_head = (free_head + 1) % free_list.size();
+        rat[ins.rd] = preg;
+    }
+
+    instructions++;
+    rob_occupancy += c - d;
+    iq_occupancy += issue - d;
+    fu_busy[fu] += occupancy;
+}
+
+// =============================================================================
+// Statistics
+// =============================================================================
+
+uint64_t OoOModel::get_cycle_count() const { return commit_cycle; }
+
+uint64_t OoOModel::get_instruction_count() const { return instructions; }
+
+void OoOModel::print_config() const {
+    std::cout << "Out-of-order model: width " << config.width
+              << ", ROB " << config.rob_size
+              << ", IQ " << config.iq_size
+              << ", " << config.phys_regs << " physical regs"
+              << ", LQ " << config.lq_size
+              << ", SQ " << config.sq_size << "\n";
+    std::cout << "  Units: " << config.alu_units << " ALU, "
+              << config.branch_units << " branch, "
+              << config.mul_units << " mul/div, "
+              << config.mem_units << " load/store"
+              << "; front end " << config.frontend_depth << " stages\n";
+}
+
+void OoOModel::register_stats(StatsRegistry& stats, const std::string& prefix) const {
+    TimingModel::register_stats(stats, prefix);
+    stats.add_counter(prefix + ".branches", &branches, "Branches and jumps");
+    stats.add_counter(prefix + ".mispredicts", &mispredicts, "Mispredicted branches and jumps");
+    stats.add_formula(prefix + ".mispredict_rate", [prefix](const StatsRegistry& s) {
+        return s.ratio(prefix + ".mispredicts", prefix + ".branches");
+    }, "Mispredicts per branch");
+    stats.add_counter(prefix + ".stalls.rob", &stall_rob, "Dispatch stalls: ROB full");
+    stats.add_counter(prefix + ".stalls.iq", &stall_iq, "Dispatch stalls: IQ full");
+    stats.add_counter(prefix + ".stalls.regs", &stall_regs, "Dispatch stalls: no free register");
+    stats.add_counter(prefix + ".stalls.lsq", &stall_lsq, "Dispatch stalls: LSQ full");
+    stats.add_counter(prefix + ".rob_occupancy", &rob_occupancy, "Dispatch to commit cycles, summed");
+    stats.add_counter(prefix + ".iq_occupancy", &iq_occupancy, "Dispatch to issue cycles, summed");
+    stats.add_histogram(prefix + ".unit_busy", fu_busy, {"alu", "branch", "muldiv", "mem"},
+                        "Busy unit-cycles per class");
+}
+
+void OoOModel::print_stats() const {
+    uint64_t cycles = get_cycle_count();
+
+    std::cout << "  Out-of-order model (width " << config.width
+              << ", ROB " << config.rob_size << ", IQ " << config.iq_size
+              << ", " << config.phys_regs << " regs):\n";
+    std::cout << "    Cycles: " << cycles << "\n";
+    std::cout << "    Instructions: " << instructions << "\n";
+    if (instructions == 0 || cycles == 0) return;
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "    IPC: " << static_cast<double>(instructions) / cycles
+              << "  CPI: " << static_cast<double>(cycles) / instructions << "\n";
+    std::cout << "    Branches: " << branches << ", mispredicted " << mispredicts;
+    if (branches > 0) std::cout << " (" << 100.0 * mispredicts / branches << "%)";
+    std::cout << "\n";
+    std::cout << "    Avg occupancy: ROB " << static_cast<double>(rob_occupancy) / cycles
+              << ", IQ " << static_cast<double>(iq_occupancy) / cycles << "\n";
+    std::cout << "    Dispatch stall cycles: ROB full " << stall_rob
+              << ", IQ full " << stall_iq
+              << ", no free register " << stall_regs
+              << ", LSQ full " << stall_lsq << "\n";
+
+    static const char* const fu_names[FU_COUNT] = {"ALU", "branch", "mul/div", "load/store"};
+    std::cout << "    Unit utilization:";
+    for (int i = 0; i < FU_COUNT; i++) {
+        std::cout << (i ? ", " : " ") << fu_names[i] << " "
+                  << 100.0 * fu_busy[i] / (static_cast<double>(cycles) * units[i]) << "%";
+    }
+    std::cout << "\n";
+}
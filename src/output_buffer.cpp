@@ -0,0 +1,86 @@
+/**
+ * output_buffer.cpp
+ *
+ * Implementation of the chunked output buffer.
+ */
+
+#include "output_buffer.hpp"
+#include <cstring>
+
+OutputBuffer::OutputBuffer(std::ostream& out, size_t capacity)
+    : out(&out), buf(capacity), len(0) {}
+
+OutputBuffer::~OutputBuffer() {
+    flush();
+}
+
+void OutputBuffer::set_stream(std::ostream& stream) {
+    flush();
+    out = &stream;
+}
+
+// =============================================================================
+// Appending
+// =============================================================================
+
+void OutputBuffer::reserve(size_t n) {
+    if (len + n > buf.size()) {
+        flush();
+        if (n > buf.size()) buf.resize(n);
+    }
+}
+
+void OutputBuffer::put(char c) {
+    reserve(1);
+    buf[len++] = c;
+}
+
+void OutputBuffer::put(const char* s) {
+    size_t n = std::strlen(s);
+    reserve(n);
+    std::memcpy(&buf[len], s, n);
+    len += n;
+}
+
+void OutputBuffer::put(const std::string& s) {
+    reserve(s.size());
+    std::memcpy(&buf[len], s.data(), s.size());
+    len += s.size();
+}
+
+void OutputBuffer::put_hex(Word value, int width) {
+    reserve(2 + 8);
+    len += format_hex(&buf[len], value, width);
+}
+
+void OutputBuffer::put_dec(uint64_t value) {
+    char tmp[20];
+    int n = 0;
+    do {
+        tmp[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    reserve(n);
+    while (n > 0) buf[len++] = tmp[--n];
+}
+
+void OutputBuffer::put_signed(int64_t value) {
+    if (value < 0) {
+        put('-');
+        put_dec(0 - static_cast<uint64_t>(value));
+    } else {
+        put_dec(static_cast<uint64_t>(value));
+    }
+}
+
+// =============================================================================
+// Flush
+// =============================================================================
+
+void OutputBuffer::flush() {
+    if (len == 0) return;
+    out->write(buf.data(), static_cast<std::streamsize>(len));
+    out->flush();
+    len = 0;
+}
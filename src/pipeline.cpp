@@ -9,19 +9,55 @@
 
 Pipeline::Pipeline(Memory& mem, RegisterFile& regs)
     : mem(mem), regs(regs), pc(Memory::TEXT_BASE), next_pc(Memory::TEXT_BASE + 4),
-      hazard_detection(true), forwarding(true), halted(false), stalled(false),
-      cycles(0), instructions(0), stalls(0), flushes(0), forwards(0) {}
+      hazard_detection(true), forwarding(true), branch_stage(BranchStage::EX),
+      redirecting(false), halted(false), stalled(false), phantom_load_use(false),
+      halt_reason(StopReason::HALTED), exit_code(0),
+      trap_hit(false), illegal_hit(false), watch_hit(false),
+      wb_rd(0), wb_value(0), mem_stored(false), mem_store_addr(0),
+      cycles(0), instructions(0), type_counts{}, redirects(0), stalls(0), branch_stalls(0), flushes(0), forwards(0),
+      phantom_forwards(0), stalls_avoided(0), sb_forwards(0), sb_full_stalls(0), sb_conflict_stalls(0),
+      icache_stalls(0), dcache_stalls(0), skipped_cycles(0),
+      caches(nullptr), fetch_started(false), fetch_wait(0), dmem_started(false), dmem_wait(0),
+      loops(nullptr), break_reported(false), break_pc(0),
+      roi_enabled(false), roi_end(0),
+      roi_start_enabled(false), roi_start_armed(false), roi_start(0) {}
 
 void Pipeline::reset() {
     pc = Memory::TEXT_BASE;
     next_pc = Memory::TEXT_BASE + 4;
     halted = false;
     stalled = false;
+    halt_reason = StopReason::HALTED;
+    exit_code = 0;
+    trap_hit = false;
+    illegal_hit = false;
+    watch_hit = false;
+    roi_start_armed = roi_start_enabled;
+    break_reported = false;
+    redirecting = false;
     cycles = 0;
     instructions = 0;
+    type_counts.fill(0);
+    redirects = 0;
     stalls = 0;
+    branch_stalls = 0;
     flushes = 0;
     forwards = 0;
+    phantom_forwards = 0;
+    stalls_avoided = 0;
+    phantom_load_use = false;
+    sb_forwards = 0;
+    sb_full_stalls = 0;
+    sb_conflict_stalls = 0;
+    icache_stalls = 0;
+    dcache_stalls = 0;
+    skipped_cycles = 0;
+    store_buffer.reset();
+    if (loops) loops->reset();
+    fetch_started = false;
+    fetch_wait = 0;
+    dmem_started = false;
+    dmem_wait = 0;
 
     if_id.flush();
     id_ex.flush();
@@ -41,14 +77,23 @@ Forward Pipeline::get_forward_a() {
     int rs1 = id_ex.ins.rs1;
     if (rs1 == 0) return Forward::NONE;
 
+    bool from_ex_mem = ex_mem.valid && ex_mem.ins.writes_rd && ex_mem.ins.rd == rs1;
+    bool from_mem_wb = wb_rd == rs1;
+
+    // Immediate bits that only look like rs1 need no forwarding
+    if (!id_ex.ins.reads_rs1) {
+        if (from_ex_mem || from_mem_wb) phantom_forwards++;
+        return Forward::NONE;
+    }
+
     // Forward from EX/MEM
-    if (ex_mem.valid && ex_mem.ins.reg_write && ex_mem.ins.rd == rs1) {
+    if (from_ex_mem) {
         forwards++;
         return Forward::EX_MEM;
     }
 
-    // Forward from MEM/WB
-    if (mem_wb.valid && mem_wb.ins.reg_write && mem_wb.ins.rd == rs1) {
+    // Forward from MEM/WB (already written back this cycle)
+    if (from_mem_wb) {
         forwards++;
         return Forward::MEM_WB;
     }
@@ -62,14 +107,23 @@ Forward Pipeline::get_forward_b() {
     int rs2 = id_ex.ins.rs2;
     if (rs2 == 0) return Forward::NONE;
 
+    bool from_ex_mem = ex_mem.valid && ex_mem.ins.writes_rd && ex_mem.ins.rd == rs2;
+    bool from_mem_wb = wb_rd == rs2;
+
+    // Immediate bits that only look like rs2 need no forwarding
+    if (!id_ex.ins.reads_rs2) {
+        if (from_ex_mem || from_mem_wb) phantom_forwards++;
+        return Forward::NONE;
+    }
+
     // Forward from EX/MEM
-    if (ex_mem.valid && ex_mem.ins.reg_write && ex_mem.ins.rd == rs2) {
+    if (from_ex_mem) {
         forwards++;
         return Forward::EX_MEM;
     }
 
-    // Forward from MEM/WB
-    if (mem_wb.valid && mem_wb.ins.reg_write && mem_wb.ins.rd == rs2) {
+    // Forward from MEM/WB (already written back this cycle)
+    if (from_mem_wb) {
         forwards++;
         return Forward::MEM_WB;
     }
@@ -82,7 +136,7 @@ Word Pipeline::get_forwarded_value(Forward fwd, Word reg_val) {
         case Forward::EX_MEM:
             return ex_mem.alu_result;
         case Forward::MEM_WB:
-            return mem_wb.ins.mem_to_reg ? mem_wb.mem_data : mem_wb.alu_result;
+            return wb_value;
         default:
             return reg_val;
     }
@@ -96,15 +150,19 @@ bool Pipeline::detect_load_use_hazard() {
     if (!hazard_detection) return false;
 
     // Load-use hazard: ID/EX has a load, and IF/ID needs that register
-    if (id_ex.valid && id_ex.ins.mem_read) {
+    if (id_ex.valid && id_ex.ins.mem_read && id_ex.ins.writes_rd) {
         Instruction next_ins = Decoder::decode(if_id.instruction, if_id.pc);
-        
-        // Check if next instruction uses the load destination
-        if (id_ex.ins.rd != 0) {
-            if (id_ex.ins.rd == next_ins.rs1 || id_ex.ins.rd == next_ins.rs2) {
-                return true;
-            }
+        int rd = id_ex.ins.rd;
+
+        // Check if next instruction reads the load destination
+        bool rs1_hit = rd == next_ins.rs1;
+        bool rs2_hit = rd == next_ins.rs2;
+        if ((rs1_hit && next_ins.reads_rs1) || (rs2_hit && next_ins.reads_rs2)) {
+            return true;
         }
+
+        // Only the immediate bits match: no stall
+        phantom_load_use = rs1_hit || rs2_hit;
     }
     return false;
 }
@@ -114,12 +172,162 @@ bool Pipeline::detect_control_hazard() {
     return ex_mem.branch_taken;
 }
 
+bool Pipeline::detect_branch_hazard() {
+    // Only the ID-stage comparator needs extra interlocks
+    if (!hazard_detection || branch_stage != BranchStage::ID || !if_id.valid) return false;
+
+    Instruction next_ins = Decoder::decode(if_id.instruction, if_id.pc);
+    if (!next_ins.branch && next_ins.type != InsType::JALR) return false;
+
+    auto needs = [&next_ins](int rd) {
+        return (next_ins.reads_rs1 && rd == next_ins.rs1) ||
+               (next_ins.reads_rs2 && rd == next_ins.rs2);
+    };
+
+    // Producer in EX this cycle: result not ready in time for the comparator
+    if (id_ex.valid && id_ex.ins.writes_rd && needs(id_ex.ins.rd)) return true;
+
+    // Producer in MEM this cycle: only an ALU result can be forwarded
+    if (ex_mem.valid && ex_mem.ins.writes_rd && needs(ex_mem.ins.rd) &&
+        (ex_mem.ins.mem_read || !forwarding)) {
+        return true;
+    }
+
+    return false;
+}
+
+// A load in MEM that partially overlaps a buffered store: it waits for
+// the store to drain, so every policy must let the buffer drain
+bool Pipeline::load_waits_for_store() const {
+    if (!ex_mem.valid || !ex_mem.ins.mem_read || store_buffer.size() == 0) return false;
+    return store_buffer.lookup(ex_mem.alu_result, access_bytes(ex_mem.ins.type)) ==
+           StoreBuffer::Match::CONFLICT;
+}
+
+bool Pipeline::load_uses_dport() const {
+    // A load held back by the store buffer leaves the port free
+    return ex_mem.valid && ex_mem.ins.mem_read && !load_waits_for_store();
+}
+
+bool Pipeline::detect_store_buffer_stall() {
+    if (!store_buffer.enabled() || !ex_mem.valid) return false;
+
+    const Instruction& ins = ex_mem.ins;
+    if (ins.mem_write && store_buffer.full()) {
+        sb_full_stalls++;
+        return true;
+    }
+    if (load_waits_for_store()) {
+        sb_conflict_stalls++;
+        return true;
+    }
+    return false;
+}
+
+bool Pipeline::detect_dcache_stall() {
+    if (!caches || !caches->is_enabled() || !ex_mem.valid) return false;
+
+    const Instruction& ins = ex_mem.ins;
+    if (!ins.mem_read && !ins.mem_write) return false;
+
+    // First cycle in MEM: look up the latency of this access
+    if (!dmem_started) {
+        dmem_started = true;
+        Address addr = ex_mem.alu_result;
+        int latency;
+        if (ins.mem_write && store_buffer.enabled()) {
+            latency = 1;    // Retires into the store buffer
+        } else if (ins.mem_read && store_buffer.size() > 0 &&
+                   store_buffer.lookup(addr, access_bytes(ins.type)) == StoreBuffer::Match::FORWARD) {
+            latency = 1;
+        } else {
+            latency = ins.mem_read ? caches->load(addr, cycles, ins.pc)
+                                   : caches->store(addr, cycles, ins.pc);
+        }
+        dmem_wait = latency - 1;
+    }
+
+    if (dmem_wait > 0) {
+        dmem_wait--;
+        dcache_stalls++;
+        return true;
+    }
+    return false;
+}
+
+// =============================================================================
+// Branch Resolution
+// =============================================================================
+
+void Pipeline::redirect(const Instruction& ins, Address target) {
+    if (loops) {
+        loops->edge(ins, target, {instructions, cycles, stalls, flushes, icache_stalls, dcache_stalls});
+    }
+
+    pc = target;
+    next_pc = target + 4;
+
+    // Squash everything fetched after the branch: one slot per stage
+    // between IF and the resolving stage
+    if_id.flush();
+    if (branch_stage != BranchStage::ID) id_ex.flush();
+    redirecting = true;
+    redirects++;
+    flushes += static_cast<int>(branch_stage) + 1;
+
+    // Abandon a wrong-path I-cache miss
+    fetch_started = false;
+    fetch_wait = 0;
+}
+
+bool Pipeline::resolve_in_id(const Instruction& ins, Address& target) {
+    // Operands: this cycle's WB is already in the register file; an ALU
+    // result now in MEM comes over the EX/MEM -> ID forwarding path
+    auto operand = [this](int r) -> Word {
+        if (r == 0) return 0;
+        if (forwarding && mem_wb.valid && mem_wb.ins.reg_write &&
+            !mem_wb.ins.mem_to_reg && mem_wb.ins.rd == r) {
+            forwards++;
+            return mem_wb.alu_result;
+        }
+        return regs.read_fast(r);
+    };
+
+    if (ins.type == InsType::JAL) {
+        target = if_id.pc + ins.imm;
+        return true;
+    }
+    if (ins.type == InsType::JALR) {
+        target = (operand(ins.rs1) + ins.imm) & ~1;
+        return true;
+    }
+    if (ALU::branch_taken(ins.type, operand(ins.rs1), operand(ins.rs2))) {
+        target = if_id.pc + ins.imm;
+        return true;
+    }
+    return false;
+}
+
 // =============================================================================
 // IF Stage
 // =============================================================================
 
 void Pipeline::stage_if() {
-    if (stalled) return;
+    if (stalled || redirecting) return;
+
+    // I-cache miss: deliver bubbles until the line arrives
+    if (caches && caches->is_enabled()) {
+        if (!fetch_started) {
+            fetch_started = true;
+            fetch_wait = caches->fetch(pc, cycles) - 1;
+        }
+        if (fetch_wait > 0) {
+            icache_stalls++;
+            if_id.flush();
+            return;
+        }
+        fetch_started = false;
+    }
 
     if_id.instruction = mem.read_word(pc);
     if_id.pc = pc;
@@ -143,11 +351,16 @@ void Pipeline::stage_id() {
     Instruction ins = Decoder::decode(if_id.instruction, if_id.pc);
 
     id_ex.ins = ins;
-    id_ex.rs1_val = regs.read(ins.rs1);
-    id_ex.rs2_val = regs.read(ins.rs2);
+    id_ex.rs1_val = regs.read_fast(ins.rs1);
+    id_ex.rs2_val = regs.read_fast(ins.rs2);
     id_ex.pc = if_id.pc;
     id_ex.next_pc = if_id.next_pc;
     id_ex.valid = true;
+
+    if (branch_stage == BranchStage::ID && (ins.branch || ins.jump)) {
+        Address target;
+        if (resolve_in_id(ins, target)) redirect(ins, target);
+    }
 }
 
 // =============================================================================
@@ -211,13 +424,8 @@ void Pipeline::stage_ex() {
     ex_mem.valid = true;
 
     // Handle control hazard (branch taken)
-    if (branch_taken) {
-        next_pc = branch_target;
-        pc = branch_target;
-        // Flush IF/ID and ID/EX
-        if_id.flush();
-        id_ex.flush();
-        flushes += 2;
+    if (branch_taken && branch_stage == BranchStage::EX) {
+        redirect(ins, branch_target);
     }
 }
 
@@ -237,6 +445,10 @@ void Pipeline::stage_mem() {
 
     // Memory read
     if (ins.mem_read) {
+        if (store_buffer.size() > 0 &&
+            store_buffer.lookup(addr, access_bytes(ins.type)) == StoreBuffer::Match::FORWARD) {
+            sb_forwards++;
+        }
         switch (ins.type) {
             case InsType::LB:  mem_data = static_cast<Word>(mem.read_byte_signed(addr)); break;
             case InsType::LH:  mem_data = static_cast<Word>(mem.read_half_signed(addr)); break;
@@ -247,8 +459,11 @@ void Pipeline::stage_mem() {
         }
     }
 
-    // Memory write
+    // Memory write (timing goes through the store buffer when enabled)
     if (ins.mem_write) {
+        if (store_buffer.enabled()) store_buffer.push(addr, access_bytes(ins.type), ins.pc);
+        mem_stored = true;
+        mem_store_addr = addr;
         Word val = ex_mem.rs2_val;
         switch (ins.type) {
             case InsType::SB: mem.write_byte(addr, val & 0xFF); break;
@@ -256,6 +471,11 @@ void Pipeline::stage_mem() {
             case InsType::SW: mem.write_word(addr, val); break;
             default: break;
         }
+        if (!watchpoints.empty()) {
+            for (Address w : watchpoints) {
+                if (addr < w + 4 && addr + access_bytes(ins.type) > w) watch_hit = true;
+            }
+        }
     }
 
     // Update pipeline register
@@ -263,10 +483,16 @@ void Pipeline::stage_mem() {
     mem_wb.alu_result = ex_mem.alu_result;
     mem_wb.mem_data = mem_data;
     mem_wb.valid = true;
+    dmem_started = false;
+
+    if (ex_mem.branch_taken && branch_stage == BranchStage::MEM) {
+        redirect(ex_mem.ins, ex_mem.branch_target);
+    }
 
     // Count completed instruction
     if (ins.type != InsType::UNKNOWN && !ins.is_nop()) {
         instructions++;
+        type_counts[static_cast<int>(ins.type)]++;
     }
 }
 
@@ -279,14 +505,28 @@ void Pipeline::stage_wb() {
 
     Instruction ins = mem_wb.ins;
 
-    if (ins.reg_write && ins.rd != 0) {
+    // Illegal instruction: do not commit, refetch it after the trap
+    if (ins.type == InsType::UNKNOWN) {
+        illegal_hit = true;
+        return;
+    }
+
+    if (ins.writes_rd) {
         Word result = ins.mem_to_reg ? mem_wb.mem_data : mem_wb.alu_result;
-        regs.write(ins.rd, result);
+        regs.write_fast(ins.rd, result);
+        wb_rd = ins.rd;
+        wb_value = result;
     }
 
     // Check for halt
     if (ins.type == InsType::ECALL) {
         halted = true;
+        if (regs.read_fast(17) == SYS_EXIT) {
+            halt_reason = StopReason::EXITED;
+            exit_code = regs.read_fast(10);
+        }
+    } else if (ins.type == InsType::EBREAK) {
+        trap_hit = true;
     }
 }
 
@@ -294,23 +534,73 @@ void Pipeline::stage_wb() {
 // Cycle
 // =============================================================================
 
-bool Pipeline::cycle() {
-    if (halted) return false;
+StopReason Pipeline::cycle() {
+    if (halted) return halt_reason;
+
+    wb_rd = 0;
+    mem_stored = false;
+    redirecting = false;
+    if (fetch_wait > 0) fetch_wait--;
+
+    // Check for load-use hazard, and operands an ID-stage branch can't get yet
+    phantom_load_use = false;
+    bool load_use = detect_load_use_hazard();
+    bool branch_wait = !load_use && detect_branch_hazard();
+    stalled = load_use || branch_wait;
+
+    // Writeback first (in reverse order to avoid overwrites)
+    stage_wb();
+
+    if (illegal_hit) {
+        // Squash everything younger and restart fetch at the faulting instruction
+        illegal_hit = false;
+        pc = mem_wb.ins.pc;
+        next_pc = pc + 4;
+        if_id.flush();
+        id_ex.flush();
+        ex_mem.flush();
+        mem_wb.flush();
+        fetch_started = false;
+        fetch_wait = 0;
+        dmem_started = false;
+        cycles++;
+        return StopReason::TRAP;
+    }
 
-    // Check for load-use hazard
-    stalled = detect_load_use_hazard();
+    // Store buffer drains in the background; MEM waits if it is full
+    // or a load only partially overlaps a buffered store
+    bool mem_blocked = false;
+    if (store_buffer.enabled()) {
+        if (store_buffer.tick(cycles, load_uses_dport(), load_waits_for_store())) {
+            int latency = caches ? caches->drain(store_buffer.front(), cycles, store_buffer.front_pc())
+                                 : 0;
+            store_buffer.drain(cycles, latency);
+        }
+        mem_blocked = detect_store_buffer_stall();
+    }
+    if (!mem_blocked) mem_blocked = detect_dcache_stall();
 
-    if (stalled) {
+    if (mem_blocked) {
         stalls++;
+        stalled = true;
+        // Freeze MEM and everything before it, bubble into WB. The value
+        // written back this cycle would be lost to the held EX operands.
+        mem_wb.flush();
+        if (wb_rd != 0 && id_ex.valid) {
+            if (id_ex.ins.reads_rs1 && id_ex.ins.rs1 == wb_rd) id_ex.rs1_val = wb_value;
+            if (id_ex.ins.reads_rs2 && id_ex.ins.rs2 == wb_rd) id_ex.rs2_val = wb_value;
+        }
+    } else if (stalled) {
+        stalls++;
+        if (branch_wait) branch_stalls++;
         // Stall: keep IF/ID, insert bubble in ID/EX
-        stage_wb();
         stage_mem();
         stage_ex();
         id_ex.flush();  // Insert bubble
         // Don't advance IF or ID
     } else {
-        // Normal pipeline advance (in reverse order to avoid overwrites)
-        stage_wb();
+        // Normal pipeline advance
+        if (phantom_load_use) stalls_avoided++;
         stage_mem();
         stage_ex();
         stage_id();
@@ -318,21 +608,128 @@ bool Pipeline::cycle() {
     }
 
     cycles++;
+    if (break_reported && pc != break_pc) break_reported = false;
 
-    // Check breakpoint
-    if (has_breakpoint(pc)) {
-        return false;
+    if (halted) return halt_reason;
+    if (trap_hit) {
+        trap_hit = false;
+        return StopReason::TRAP;
+    }
+    if (watch_hit) {
+        watch_hit = false;
+        return StopReason::WATCHPOINT;
+    }
+    if (roi_start_armed && pc == roi_start) {
+        roi_start_armed = false;
+        return StopReason::ROI_START;
+    }
+    if (roi_enabled && pc == roi_end) {
+        return StopReason::ROI_END;
+    }
+    if (breakpoint_pending()) {
+        break_reported = true;
+        break_pc = pc;
+        return StopReason::BREAKPOINT;
     }
 
-    return !halted;
+    return StopReason::NONE;
+}
+
+// =============================================================================
+// Event-Driven Cycle Skipping
+// =============================================================================
+
+uint64_t Pipeline::quiet_cycles() const {
+    if (halted || !caches || !caches->is_enabled()) return 0;
+
+    // Stopping at pc must still happen on the first stalled cycle
+    if (breakpoint_pending()) return 0;
+    if (roi_enabled && pc == roi_end) return 0;
+    if (roi_start_armed && pc == roi_start) return 0;
+
+    uint64_t n;
+    if (dmem_started && dmem_wait > 0 && !mem_wb.valid) {
+        // D-cache fill: MEM and everything behind it frozen, WB empty
+        n = dmem_wait;
+    } else if (fetch_started && fetch_wait > 1 && !if_id.valid && !id_ex.valid &&
+               !ex_mem.valid && !mem_wb.valid) {
+        // I-cache fill with the pipe drained; the last cycle fetches
+        n = fetch_wait - 1;
+    } else {
+        return 0;
+    }
+
+    if (store_buffer.enabled()) {
+        n = std::min(n, store_buffer.quiet_cycles(cycles, load_uses_dport(),
+                                                  load_waits_for_store()));
+    }
+    return n;
+}
+
+void Pipeline::skip_cycles(uint64_t n) {
+    // Same counters a stalled cycle() would bump, n times over
+    if (dmem_started && dmem_wait > 0) {
+        dmem_wait -= static_cast<int>(n);
+        fetch_wait = static_cast<int>(std::max<int64_t>(fetch_wait - static_cast<int64_t>(n), 0));
+        stalls += n;
+        dcache_stalls += n;
+    } else {
+        fetch_wait -= static_cast<int>(n);
+        icache_stalls += n;
+    }
+    if (store_buffer.enabled()) store_buffer.skip(n);
+    cycles += n;
+    skipped_cycles += n;
 }
 
 // =============================================================================
 // Run
 // =============================================================================
 
-void Pipeline::run() {
-    while (cycle()) {}
+StopReason Pipeline::run(uint64_t max_cycles) {
+    watchdog.start(limits, instructions, cycles);
+    for (uint64_t i = 0; i < max_cycles; i++) {
+        // Jump to the cycle that completes an outstanding fill. run_until
+        // steps every cycle since its predicate may look at the cycle count.
+        uint64_t skip = quiet_cycles();
+        if (skip > 0) {
+            uint64_t left = watchdog.cycles_left(cycles);
+            skip = std::min({skip, max_cycles - i - 1, left > 0 ? left - 1 : 0});
+            if (skip > 0) {
+                skip_cycles(skip);
+                i += skip;
+                watchdog.resync();
+            }
+        }
+
+        StopReason reason = cycle();
+        if (reason == StopReason::NONE) reason = watchdog.tick(instructions, cycles);
+        if (reason != StopReason::NONE) return reason;
+    }
+    return StopReason::NONE;
+}
+
+StopReason Pipeline::run_until(Predicate& pred) {
+    watchdog.start(limits, instructions, cycles);
+    pred.invalidate();
+    while (true) {
+        StopReason reason = cycle();
+        pred.observe(wb_rd, mem_stored, mem_store_addr);
+        if (pred.test(predicate_state())) return StopReason::CONDITION;
+        if (reason == StopReason::NONE) reason = watchdog.tick(instructions, cycles);
+        if (reason != StopReason::NONE) return reason;
+    }
+}
+
+void Pipeline::set_limits(const RunLimits& run_limits) { limits = run_limits; }
+const RunLimits& Pipeline::get_limits() const { return limits; }
+
+void Pipeline::set_sampling(uint64_t period, bool by_cycles, std::function<void()> sample) {
+    watchdog.set_sampling(period, by_cycles, std::move(sample));
+}
+
+Predicate::State Pipeline::predicate_state() const {
+    return {pc, cycles, instructions, regs, mem};
 }
 
 // =============================================================================
@@ -341,8 +738,20 @@ void Pipeline::run() {
 
 void Pipeline::set_hazard_detection(bool enabled) { hazard_detection = enabled; }
 void Pipeline::set_forwarding(bool enabled) { forwarding = enabled; }
+void Pipeline::set_branch_stage(BranchStage stage) { branch_stage = stage; }
 bool Pipeline::get_hazard_detection() const { return hazard_detection; }
 bool Pipeline::get_forwarding() const { return forwarding; }
+BranchStage Pipeline::get_branch_stage() const { return branch_stage; }
+StoreBuffer& Pipeline::get_store_buffer() { return store_buffer; }
+void Pipeline::set_memory_hierarchy(MemoryHierarchy* hierarchy) { caches = hierarchy; }
+
+void Pipeline::set_loop_profiler(LoopProfiler* profiler) {
+    loops = profiler;
+    if (loops) {
+        loops->reset();
+        loops->set_timed(true);
+    }
+}
 
 // =============================================================================
 // State Access
@@ -352,8 +761,37 @@ Address Pipeline::get_pc() const { return pc; }
 void Pipeline::set_pc(Address addr) { pc = addr; next_pc = addr + 4; }
 uint64_t Pipeline::get_cycle_count() const { return cycles; }
 uint64_t Pipeline::get_instruction_count() const { return instructions; }
+
+void Pipeline::register_stats(StatsRegistry& stats, const std::string& prefix) const {
+    stats.add_counter(prefix + ".cycles", &cycles, "Cycles");
+    stats.add_counter(prefix + ".instructions", &instructions, "Instructions retired (excluding nops)");
+    for (int c = 0; c < NUM_INS_CLASSES; c++) {
+        InsClass cls = static_cast<InsClass>(c);
+        stats.add_computed(prefix + ".mix." + ins_class_name(cls),
+                           [this, cls] { return class_count(type_counts, cls); },
+                           std::string("Retired ") + ins_class_name(cls) + " instructions");
+    }
+    stats.add_formula(prefix + ".cpi", [prefix](const StatsRegistry& s) {
+        return s.ratio(prefix + ".cycles", prefix + ".instructions");
+    }, "Cycles per instruction");
+    stats.add_counter(prefix + ".stalls", &stalls, "Stall cycles");
+    stats.add_counter(prefix + ".branch_stalls", &branch_stalls, "Stalls for ID-stage branch operands");
+    stats.add_counter(prefix + ".flushes", &flushes, "Squashed slots");
+    stats.add_counter(prefix + ".redirects", &redirects, "Taken branches and jumps (predicted not taken)");
+    stats.add_counter(prefix + ".forwards", &forwards, "Operands forwarded");
+    stats.add_counter(prefix + ".phantom_forwards", &phantom_forwards, "Forwards skipped: field not an operand");
+    stats.add_counter(prefix + ".stalls_avoided", &stalls_avoided, "Load-use stalls avoided by operand metadata");
+    stats.add_counter(prefix + ".icache_stalls", &icache_stalls, "I-cache stall cycles");
+    stats.add_counter(prefix + ".dcache_stalls", &dcache_stalls, "D-cache stall cycles");
+    stats.add_counter(prefix + ".skipped_cycles", &skipped_cycles, "Stall cycles skipped (event-driven)");
+    stats.add_counter(prefix + ".store_buffer.forwards", &sb_forwards, "Loads forwarded from the store buffer");
+    stats.add_counter(prefix + ".store_buffer.full_stalls", &sb_full_stalls, "Stalls on a full store buffer");
+    stats.add_counter(prefix + ".store_buffer.conflict_stalls", &sb_conflict_stalls, "Stalls on a partial overlap");
+    store_buffer.register_stats(stats, prefix + ".store_buffer");
+}
 bool Pipeline::is_halted() const { return halted; }
 bool Pipeline::is_stalled() const { return stalled; }
+Word Pipeline::get_exit_code() const { return exit_code; }
 
 const IF_ID& Pipeline::get_if_id() const { return if_id; }
 const ID_EX& Pipeline::get_id_ex() const { return id_ex; }
@@ -365,14 +803,27 @@ const MEM_WB& Pipeline::get_mem_wb() const { return mem_wb; }
 // =============================================================================
 
 void Pipeline::print_state() const {
-    std::cout << "Cycle " << cycles << ":\n";
+    OutputBuffer out(std::cout);
+    print_state(out);
+}
 
-    auto print_stage = [](const char* name, bool valid, Address pc, const std::string& text) {
-        std::cout << "  " << name << ": ";
+void Pipeline::print_state(OutputBuffer& out) const {
+    out.put("Cycle ");
+    out.put_dec(cycles);
+    out.put(":\n");
+
+    auto print_stage = [&out](const char* name, bool valid, Address pc, const std::string& text) {
+        out.put("  ");
+        out.put(name);
+        out.put(": ");
         if (valid) {
-            std::cout << "[" << to_hex(pc) << "] " << text << "\n";
+            out.put('[');
+            out.put_hex(pc);
+            out.put("] ");
+            out.put(text);
+            out.put('\n');
         } else {
-            std::cout << "(bubble)\n";
+            out.put("(bubble)\n");
         }
     };
 
@@ -382,12 +833,14 @@ void Pipeline::print_state() const {
     print_stage("EX ", ex_mem.valid, ex_mem.ins.pc, ex_mem.ins.text);
     print_stage("MEM", mem_wb.valid, mem_wb.ins.pc, mem_wb.ins.text);
 
-    std::cout << "  WB : ";
+    out.put("  WB : ");
     if (mem_wb.valid && mem_wb.ins.reg_write) {
-        std::cout << reg_name(mem_wb.ins.rd) << " <- "
-                  << to_hex(mem_wb.ins.mem_to_reg ? mem_wb.mem_data : mem_wb.alu_result) << "\n";
+        out.put(reg_name(mem_wb.ins.rd));
+        out.put(" <- ");
+        out.put_hex(mem_wb.ins.mem_to_reg ? mem_wb.mem_data : mem_wb.alu_result);
+        out.put('\n');
     } else {
-        std::cout << "(none)\n";
+        out.put("(none)\n");
     }
 }
 
@@ -409,10 +862,60 @@ bool Pipeline::has_breakpoint(Address addr) const {
     return std::find(breakpoints.begin(), breakpoints.end(), addr) != breakpoints.end();
 }
 
+// A breakpoint stops once per arrival at its address, not on every cycle
+// an I-cache miss holds fetch there
+bool Pipeline::breakpoint_pending() const {
+    return !breakpoints.empty() && has_breakpoint(pc) && !(break_reported && break_pc == pc);
+}
+
+// =============================================================================
+// Watchpoints and Region of Interest
+// =============================================================================
+
+void Pipeline::add_watchpoint(Address addr) {
+    if (std::find(watchpoints.begin(), watchpoints.end(), addr) == watchpoints.end()) {
+        watchpoints.push_back(addr);
+    }
+}
+
+void Pipeline::clear_watchpoints() {
+    watchpoints.clear();
+    watch_hit = false;
+}
+
+void Pipeline::set_roi_end(Address addr) {
+    roi_enabled = true;
+    roi_end = addr;
+}
+
+void Pipeline::clear_roi_end() {
+    roi_enabled = false;
+}
+
+void Pipeline::set_roi_start(Address addr) {
+    roi_start_enabled = true;
+    roi_start_armed = true;
+    roi_start = addr;
+}
+
+void Pipeline::clear_roi_start() {
+    roi_start_enabled = false;
+    roi_start_armed = false;
+}
+
 // =============================================================================
 // Statistics
 // =============================================================================
 
 uint64_t Pipeline::get_stall_count() const { return stalls; }
+uint64_t Pipeline::get_branch_stall_count() const { return branch_stalls; }
+uint64_t Pipeline::get_sb_forward_count() const { return sb_forwards; }
+uint64_t Pipeline::get_sb_full_stall_count() const { return sb_full_stalls; }
+uint64_t Pipeline::get_sb_conflict_stall_count() const { return sb_conflict_stalls; }
+uint64_t Pipeline::get_icache_stall_count() const { return icache_stalls; }
+uint64_t Pipeline::get_dcache_stall_count() const { return dcache_stalls; }
+uint64_t Pipeline::get_skipped_cycle_count() const { return skipped_cycles; }
 uint64_t Pipeline::get_flush_count() const { return flushes; }
 uint64_t Pipeline::get_forward_count() const { return forwards; }
+uint64_t Pipeline::get_phantom_forward_count() const { return phantom_forwards; }
+uint64_t Pipeline::get_stalls_avoided() const { return stalls_avoided; }
@@ -0,0 +1,438 @@
+/**
+ * predicate.cpp
+ *
+ * Expression compiler and bytecode evaluator for run-until predicates.
+ */
+
+#include "predicate.hpp"
+#include <cctype>
+#include <cstring>
+
+// =============================================================================
+// Compile
+// =============================================================================
+
+bool Predicate::compile(const std::string& expr, const std::map<std::string, Address>& symbols,
+                        size_t& used, std::string& error) {
+    code.clear();
+    reg_mask = 0;
+    always_dirty = false;
+    reads_mem = false;
+    mem_dynamic = false;
+    mem_addrs.clear();
+    dirty = true;
+
+    src = &expr;
+    syms = &symbols;
+    pos = 0;
+    err.clear();
+
+    bool ok = parse_or();
+    if (ok && code.empty()) {
+        err = "empty expression";
+        ok = false;
+    }
+
+    skip_space();
+    used = pos;
+    text = expr.substr(0, pos);
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) text.pop_back();
+
+    src = nullptr;
+    syms = nullptr;
+
+    if (!ok) {
+        error = err;
+        code.clear();
+        return false;
+    }
+
+    // Check stack depth and collect dependencies
+    int depth = 0;
+    for (size_t i = 0; i < code.size(); i++) {
+        const Insn& in = code[i];
+        switch (in.op) {
+            case Op::CONST:
+            case Op::PC:
+            case Op::CYCLES:
+            case Op::INSTRUCTIONS:
+                depth++;
+                if (in.op != Op::CONST) always_dirty = true;
+                break;
+            case Op::REG:
+                depth++;
+                reg_mask |= (1u << in.arg);
+                break;
+            case Op::MEM:
+                reads_mem = true;
+                // A lone constant before MEM is the whole address expression
+                if (i > 0 && code[i - 1].op == Op::CONST) {
+                    mem_addrs.push_back(static_cast<Address>(code[i - 1].arg));
+                } else {
+                    mem_dynamic = true;
+                }
+                break;
+            case Op::NEG:
+            case Op::NOT:
+            case Op::BNOT:
+                break;
+            default:
+                depth--;
+                break;
+        }
+        if (depth > MAX_STACK) {
+            error = "expression too complex";
+            code.clear();
+            return false;
+        }
+    }
+    reg_mask &= ~1u;
+
+    return true;
+}
+
+// =============================================================================
+// Lexing
+// =============================================================================
+
+void Predicate::skip_space() {
+    while (pos < src->size() && std::isspace(static_cast<unsigned char>((*src)[pos]))) pos++;
+}
+
+bool Predicate::peek(const char* tok) {
+    skip_space();
+    return src->compare(pos, std::strlen(tok), tok) == 0;
+}
+
+bool Predicate::accept(const char* tok) {
+    if (!peek(tok)) return false;
+    pos += std::strlen(tok);
+    return true;
+}
+
+std::string Predicate::ident() {
+    skip_space();
+    size_t start = pos;
+    while (pos < src->size()) {
+        char c = (*src)[pos];
+        if (std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.') {
+            pos++;
+        } else {
+            break;
+        }
+    }
+    return src->substr(start, pos - start);
+}
+
+// =============================================================================
+// Parsing (one function per precedence level)
+// =============================================================================
+
+bool Predicate::parse_or() {
+    if (!parse_and()) return false;
+    while (accept("||")) {
+        if (!parse_and()) return false;
+        emit_binary(Op::LOR);
+    }
+    return true;
+}
+
+bool Predicate::parse_and() {
+    if (!parse_cmp()) return false;
+    while (accept("&&")) {
+        if (!parse_cmp()) return false;
+        emit_binary(Op::LAND);
+    }
+    return true;
+}
+
+bool Predicate::parse_cmp() {
+    if (!parse_bitor()) return false;
+
+    Op op;
+    if (accept("==")) op = Op::EQ;
+    else if (accept("!=")) op = Op::NE;
+    else if (accept("<=")) op = Op::LE;
+    else if (accept(">=")) op = Op::GE;
+    else if (accept("<")) op = Op::LT;
+    else if (accept(">")) op = Op::GT;
+    else return true;
+
+    if (!parse_bitor()) return false;
+    emit_binary(op);
+    return true;
+}
+
+bool Predicate::parse_bitor() {
+    if (!parse_bitxor()) return false;
+    while (!peek("||") && accept("|")) {
+        if (!parse_bitxor()) return false;
+        emit_binary(Op::OR);
+    }
+    return true;
+}
+
+bool Predicate::parse_bitxor() {
+    if (!parse_bitand()) return false;
+    while (accept("^")) {
+        if (!parse_bitand()) return false;
+        emit_binary(Op::XOR);
+    }
+    return true;
+}
+
+bool Predicate::parse_bitand() {
+    if (!parse_shift()) return false;
+    while (!peek("&&") && accept("&")) {
+        if (!parse_shift()) return false;
+        emit_binary(Op::AND);
+    }
+    return true;
+}
+
+bool Predicate::parse_shift() {
+    if (!parse_sum()) return false;
+    while (true) {
+        Op op;
+        if (accept("<<")) op = Op::SHL;
+        else if (accept(">>")) op = Op::SHR;
+        else return true;
+        if (!parse_sum()) return false;
+        emit_binary(op);
+    }
+}
+
+bool Predicate::parse_sum() {
+    if (!parse_term()) return false;
+    while (true) {
+        Op op;
+        if (accept("+")) op = Op::ADD;
+        else if (accept("-")) op = Op::SUB;
+        else return true;
+        if (!parse_term()) return false;
+        emit_binary(op);
+    }
+}
+
+bool Predicate::parse_term() {
+    if (!parse_unary()) return false;
+    while (true) {
+        Op op;
+        if (accept("*")) op = Op::MUL;
+        else if (accept("/")) op = Op::DIV;
+        else if (accept("%")) op = Op::REM;
+        else return true;
+        if (!parse_unary()) return false;
+        emit_binary(op);
+    }
+}
+
+bool Predicate::parse_unary() {
+    Op op;
+    if (accept("-")) op = Op::NEG;
+    else if (!peek("!=") && accept("!")) op = Op::NOT;
+    else if (accept("~")) op = Op::BNOT;
+    else return parse_primary();
+
+    if (!parse_unary()) return false;
+    emit_unary(op);
+    return true;
+}
+
+bool Predicate::parse_primary() {
+    skip_space();
+    if (pos >= src->size()) {
+        err = "unexpected end of expression";
+        return false;
+    }
+
+    // Parenthesised expression
+    if (accept("(")) {
+        if (!parse_or()) return false;
+        if (!accept(")")) { err = "expected ')'"; return false; }
+        return true;
+    }
+
+    // Memory word: [addr]
+    if (accept("[")) {
+        if (!parse_or()) return false;
+        if (!accept("]")) { err = "expected ']'"; return false; }
+        emit(Op::MEM);
+        return true;
+    }
+
+    // Number
+    char c = (*src)[pos];
+    if (std::isdigit(static_cast<unsigned char>(c))) {
+        size_t len = 0;
+        int64_t val = 0;
+        try {
+            bool hex = src->compare(pos, 2, "0x") == 0 || src->compare(pos, 2, "0X") == 0;
+            val = static_cast<int64_t>(std::stoull(src->substr(pos), &len, hex ? 16 : 10));
+        } catch (...) {
+            err = "bad number";
+            return false;
+        }
+        pos += len;
+        emit(Op::CONST, val);
+        return true;
+    }
+
+    size_t start = pos;
+    std::string name = ident();
+    if (name.empty()) {
+        err = std::string("unexpected '") + c + "'";
+        return false;
+    }
+    std::string lower = name;
+    for (char& ch : lower) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+
+    if (lower == "pc") { emit(Op::PC); return true; }
+    if (lower == "cycles" || lower == "cycle") { emit(Op::CYCLES); return true; }
+    if (lower == "instructions" || lower == "insns") { emit(Op::INSTRUCTIONS); return true; }
+
+    if (lower == "mem" && peek("[")) {
+        return parse_primary();
+    }
+
+    if (lower == "reg") {
+        name = ident();
+        int reg = reg_index(name);
+        if (reg < 0) { err = "unknown register: " + name; return false; }
+        emit(Op::REG, reg);
+        return true;
+    }
+
+    int reg = reg_index(lower);
+    if (reg >= 0) {
+        emit(Op::REG, reg);
+        return true;
+    }
+
+    auto it = syms->find(name);
+    if (it != syms->end()) {
+        emit(Op::CONST, it->second);
+        return true;
+    }
+
+    pos = start;
+    err = "unknown name: " + name;
+    return false;
+}
+
+// =============================================================================
+// Emit (with constant folding)
+// =============================================================================
+
+void Predicate::emit(Op op, int64_t arg) {
+    code.push_back({op, arg});
+}
+
+void Predicate::emit_unary(Op op) {
+    if (!code.empty() && code.back().op == Op::CONST) {
+        code.back().arg = apply(op, code.back().arg, 0);
+        return;
+    }
+    emit(op);
+}
+
+void Predicate::emit_binary(Op op) {
+    size_t n = code.size();
+    if (n >= 2 && code[n - 1].op == Op::CONST && code[n - 2].op == Op::CONST) {
+        code[n - 2].arg = apply(op, code[n - 2].arg, code[n - 1].arg);
+        code.pop_back();
+        return;
+    }
+    emit(op);
+}
+
+// Arithmetic wraps as on the machine: +, -, * and << work on the unsigned
+// bits, and the one overflowing quotient keeps the RISC-V result
+int64_t Predicate::apply(Op op, int64_t a, int64_t b) {
+    const uint64_t ua = static_cast<uint64_t>(a);
+    const uint64_t ub = static_cast<uint64_t>(b);
+    const bool overflow = a == std::numeric_limits<int64_t>::min() && b == -1;
+    switch (op) {
+        case Op::NEG:  return static_cast<int64_t>(0 - ua);
+        case Op::NOT:  return !a;
+        case Op::BNOT: return ~a;
+        case Op::ADD:  return static_cast<int64_t>(ua + ub);
+        case Op::SUB:  return static_cast<int64_t>(ua - ub);
+        case Op::MUL:  return static_cast<int64_t>(ua * ub);
+        case Op::DIV:  return b == 0 ? -1 : overflow ? a : a / b;     // RISC-V semantics
+        case Op::REM:  return b == 0 ? a : overflow ? 0 : a % b;
+        case Op::AND:  return a & b;
+        case Op::OR:   return a | b;
+        case Op::XOR:  return a ^ b;
+        case Op::SHL:  return static_cast<int64_t>(ua << (b & 63));
+        case Op::SHR:  return a >> (b & 63);
+        case Op::EQ:   return a == b;
+        case Op::NE:   return a != b;
+        case Op::LT:   return a < b;
+        case Op::LE:   return a <= b;
+        case Op::GT:   return a > b;
+        case Op::GE:   return a >= b;
+        case Op::LAND: return a && b;
+        case Op::LOR:  return a || b;
+        default:       return 0;
+    }
+}
+
+// =============================================================================
+// Evaluation
+// =============================================================================
+
+int64_t Predicate::eval(const State& state) const {
+    int64_t stack[MAX_STACK];
+    int sp = 0;
+
+    for (const Insn& in : code) {
+        switch (in.op) {
+            case Op::CONST:
+                stack[sp++] = in.arg;
+                break;
+            case Op::REG:
+                stack[sp++] = static_cast<SignedWord>(state.regs.read_fast(static_cast<unsigned>(in.arg)));
+                break;
+            case Op::MEM:
+                stack[sp - 1] = static_cast<SignedWord>(state.mem.peek_word(static_cast<Address>(stack[sp - 1])));
+                break;
+            case Op::PC:
+                stack[sp++] = state.pc;
+                break;
+            case Op::CYCLES:
+                stack[sp++] = static_cast<int64_t>(state.cycles);
+                break;
+            case Op::INSTRUCTIONS:
+                stack[sp++] = static_cast<int64_t>(state.instructions);
+                break;
+            case Op::NEG:
+            case Op::NOT:
+            case Op::BNOT:
+                stack[sp - 1] = apply(in.op, stack[sp - 1], 0);
+                break;
+            default:
+                sp--;
+                stack[sp - 1] = apply(in.op, stack[sp - 1], stack[sp]);
+                break;
+        }
+    }
+
+    return sp > 0 ? stack[sp - 1] : 0;
+}
+
+bool Predicate::test(const State& state) {
+    if (dirty) {
+        cached = eval(state) != 0;
+        dirty = false;
+    }
+    return cached;
+}
+
+bool Predicate::watches(Address store_addr) const {
+    // Stores are at most 4 bytes; a watched word covers [a, a + 4)
+    for (Address a : mem_addrs) {
+        if (store_addr < a + 4 && store_addr + 4 > a) return true;
+    }
+    return false;
+}
@@ -0,0 +1,160 @@
+/**
+ * prefetcher.cpp
+ *
+ * Next-line, stride and stream prefetcher implementations.
+ */
+
+#include "prefetcher.hpp"
+#include <algorithm>
+
+// =============================================================================
+// Factory
+// =============================================================================
+
+std::unique_ptr<Prefetcher> Prefetcher::create(const Config& config, uint32_t line_size) {
+    int degree = std::max(config.degree, 1);
+    int distance = std::max(config.distance, 1);
+    switch (config.type) {
+        case Type::NEXT_LINE: return std::make_unique<NextLinePrefetcher>(degree, distance, line_size);
+        case Type::STRIDE:    return std::make_unique<StridePrefetcher>(degree, distance);
+        case Type::STREAM:    return std::make_unique<StreamPrefetcher>(degree, distance, line_size);
+        case Type::NONE:      break;
+    }
+    return nullptr;
+}
+
+const char* Prefetcher::type_name(Type type) {
+    switch (type) {
+        case Type::NONE:      return "none";
+        case Type::NEXT_LINE: return "nextline";
+        case Type::STRIDE:    return "stride";
+        case Type::STREAM:    return "stream";
+    }
+    return "?";
+}
+
+bool Prefetcher::parse_type(const std::string& name, Type& type) {
+    if (name == "none" || name == "off") type = Type::NONE;
+    else if (name == "nextline" || name == "next") type = Type::NEXT_LINE;
+    else if (name == "stride") type = Type::STRIDE;
+    else if (name == "stream") type = Type::STREAM;
+    else return false;
+    return true;
+}
+
+// =============================================================================
+// Next Line
+// =============================================================================
+
+NextLinePrefetcher::NextLinePrefetcher(int degree, int distance, uint32_t line_size)
+    : degree(degree), distance(distance), line_size(line_size) {}
+
+void NextLinePrefetcher::observe(Address, Address addr, bool trigger,
+                                 std::vector<Address>& prefetches) {
+    if (!trigger) return;
+    Address line = addr & ~(line_size - 1);
+    for (int i = 0; i < degree; i++) {
+        prefetches.push_back(line + (distance + i) * line_size);
+    }
+}
+
+void NextLinePrefetcher::reset() {}
+
+// =============================================================================
+// Stride (PC-indexed)
+// =============================================================================
+
+StridePrefetcher::StridePrefetcher(int degree, int distance)
+    : degree(degree), distance(distance) {}
+
+void StridePrefetcher::observe(Address pc, Address addr, bool,
+                               std::vector<Address>& prefetches) {
+    Entry& e = table[(pc >> 2) % TABLE_SIZE];
+
+    if (!e.valid || e.pc != pc) {
+        e = Entry();
+        e.pc = pc;
+        e.last_addr = addr;
+        e.valid = true;
+        return;
+    }
+
+    int32_t stride = static_cast<int32_t>(addr - e.last_addr);
+    if (stride != 0 && stride == e.stride) {
+        e.confidence = std::min(e.confidence + 1, 3);
+    } else if (e.confidence > 0) {
+        e.confidence--;
+    } else {
+        e.stride = stride;
+    }
+    e.last_addr = addr;
+
+    if (e.confidence >= 2) {
+        for (int i = 0; i < degree; i++) {
+            prefetches.push_back(addr + e.stride * (distance + i));
+        }
+    }
+}
+
+void StridePrefetcher::reset() {
+    table.fill(Entry());
+}
+
+// =============================================================================
+// Stream
+// =============================================================================
+
+StreamPrefetcher::StreamPrefetcher(int degree, int distance, uint32_t line_size)
+    : degree(degree), distance(distance), line_size(line_size), clock(0) {}
+
+void StreamPrefetcher::observe(Address, Address addr, bool trigger,
+                               std::vector<Address>& prefetches) {
+    if (!trigger) return;
+    clock++;
+
+    int64_t line = addr / line_size;
+
+    // Continue a stream whose last line is close by
+    for (Stream& s : streams) {
+        if (!s.valid) continue;
+        int64_t delta = line - s.last_line;
+        if (delta == 0 || delta > WINDOW || delta < -WINDOW) continue;
+
+        int direction = delta > 0 ? 1 : -1;
+        if (direction == s.direction) {
+            s.confidence = std::min(s.confidence + 1, 3);
+        } else {
+            s.direction = direction;
+            s.confidence = 1;
+        }
+        s.last_line = line;
+        s.last_use = clock;
+
+        if (s.confidence >= 2) {
+            for (int i = 0; i < degree; i++) {
+                int64_t target = line + s.direction * (distance + i);
+                if (target >= 0) prefetches.push_back(static_cast<Address>(target * line_size));
+            }
+        }
+        return;
+    }
+
+    // Start a new stream in the least recently used slot
+    Stream* victim = &streams[0];
+    for (Stream& s : streams) {
+        if (!s.valid) {
+            victim = &s;
+            break;
+        }
+        if (s.last_use < victim->last_use) victim = &s;
+    }
+    *victim = Stream();
+    victim->last_line = line;
+    victim->last_use = clock;
+    victim->valid = true;
+}
+
+void StreamPrefetcher::reset() {
+    streams.fill(Stream());
+    clock = 0;
+}
@@ -5,6 +5,7 @@
  */
 
 #include "register_file.hpp"
+#include <algorithm>
 
 RegisterFile::RegisterFile() {
     reset();
@@ -18,8 +19,7 @@ Word RegisterFile::read(int reg) const {
     if (reg < 0 || reg >= NUM_REGISTERS) {
         throw std::out_of_range("Invalid register: " + std::to_string(reg));
     }
-    // x0 always returns 0
-    return (reg == 0) ? 0 : regs[reg];
+    return regs[reg];
 }
 
 void RegisterFile::write(int reg, Word value) {
@@ -27,9 +27,7 @@ void RegisterFile::write(int reg, Word value) {
         throw std::out_of_range("Invalid register: " + std::to_string(reg));
     }
     // Writes to x0 are ignored
-    if (reg != 0) {
-        regs[reg] = value;
-    }
+    regs[reg == 0 ? SINK : reg] = value;
 }
 
 void RegisterFile::dump() const {
@@ -57,6 +55,8 @@ void RegisterFile::dump_reg(int reg) const {
               << " (" << static_cast<SignedWord>(regs[reg]) << ")\n";
 }
 
-const std::array<Word, NUM_REGISTERS>& RegisterFile::get_all() const {
-    return regs;
+std::array<Word, NUM_REGISTERS> RegisterFile::get_all() const {
+    std::array<Word, NUM_REGISTERS> copy;
+    std::copy(regs.begin(), regs.begin() + NUM_REGISTERS, copy.begin());
+    return copy;
 }
@@ -0,0 +1,143 @@
+/**
+ * sampler.cpp
+ *
+ * Column selection and CSV rows for interval snapshots.
+ */
+
+#include "sampler.hpp"
+
+Sampler::Sampler(const StatsRegistry& stats, const Config& cfg)
+    : stats(stats), config(cfg), out(&std::cout), insns(0), cycles(0), rows(0) {
+    if (config.period == 0) config.period = 1;
+}
+
+const Sampler::Config& Sampler::get_config() const { return config; }
+
+bool Sampler::open(const std::string& name, std::string& error) {
+    filename = name;
+    if (filename.empty()) {
+        out = &std::cout;
+        return true;
+    }
+    file.open(filename);
+    if (!file) {
+        error = "cannot open file: " + filename;
+        return false;
+    }
+    out = &file;
+    return true;
+}
+
+const std::string& Sampler::get_filename() const { return filename; }
+
+uint64_t Sampler::get_rows() const { return rows; }
+
+// =============================================================================
+// Columns
+// =============================================================================
+
+int Sampler::counter(const std::string& name) {
+    for (size_t i = 0; i < counters.size(); i++) {
+        if (counters[i] == name) return static_cast<int>(i);
+    }
+    counters.push_back(name);
+    return static_cast<int>(counters.size()) - 1;
+}
+
+void Sampler::add_rate(const std::string& name, const std::vector<std::string>& num,
+                       const std::vector<std::string>& den) {
+    Column c;
+    c.name = name;
+    for (const auto& n : num) c.num.push_back(counter(n));
+    for (const auto& d : den) c.den.push_back(counter(d));
+    columns.push_back(c);
+}
+
+void Sampler::start(const std::string& engine, const std::string& timing, bool caches) {
+    counters.clear();
+    columns.clear();
+
+    const std::string cycle_source = timing.empty() ? engine : timing;
+    insns = counter(engine + ".instructions");
+    cycles = counter(cycle_source + ".cycles");
+
+    add_rate("insns", {engine + ".instructions"}, {});
+    add_rate("cycles", {cycle_source + ".cycles"}, {});
+    add_rate("ipc", {engine + ".instructions"}, {cycle_source + ".cycles"});
+
+    if (stats.has(engine + ".stalls")) {
+        add_rate("stall_rate", {engine + ".stalls"}, {engine + ".cycles"});
+        add_rate("flush_rate", {engine + ".flushes"}, {engine + ".cycles"});
+    }
+
+    // Branch predictor: the Pipeline predicts not taken, so every redirect
+    // is a misprediction; timing models count their own
+    const std::vector<std::string> control = {engine + ".mix.branch", engine + ".mix.jump"};
+    if (stats.has(engine + ".redirects")) {
+        add_rate("mispredict_rate", {engine + ".redirects"}, control);
+    } else if (!timing.empty() && stats.has(timing + ".mispredicts")) {
+        add_rate("mispredict_rate", {timing + ".mispredicts"}, {timing + ".branches"});
+    }
+
+    if (caches) {
+        for (const char* level : {"l1i", "l1d", "l2"}) {
+            std::string p = std::string("caches.") + level;
+            add_rate(std::string(level) + "_miss_rate", {p + ".misses"}, {p + ".accesses"});
+        }
+    }
+
+    for (int c = 0; c < NUM_INS_CLASSES; c++) {
+        std::string cls = ins_class_name(static_cast<InsClass>(c));
+        add_rate(cls, {engine + ".mix." + cls}, {engine + ".instructions"});
+    }
+
+    *out << "interval,end_insns,end_cycles";
+    for (const Column& c : columns) *out << "," << c.name;
+    *out << "\n";
+
+    read(prev);
+}
+
+void Sampler::restart() {
+    read(prev);
+}
+
+// =============================================================================
+// Rows
+// =============================================================================
+
+void Sampler::read(std::vector<uint64_t>& values) const {
+    values.resize(counters.size());
+    for (size_t i = 0; i < counters.size(); i++) values[i] = stats.total(counters[i]);
+}
+
+void Sampler::sample() {
+    read(now);
+    if (now[insns] == prev[insns] && now[cycles] == prev[cycles]) return;
+
+    auto delta = [this](const std::vector<int>& ids) {
+        uint64_t sum = 0;
+        for (int i : ids) sum += now[i] - prev[i];
+        return sum;
+    };
+
+    *out << rows << "," << now[insns] << "," << now[cycles];
+    for (const Column& c : columns) {
+        uint64_t num = delta(c.num);
+        if (c.den.empty()) {
+            *out << "," << num;
+        } else {
+            uint64_t den = delta(c.den);
+            *out << "," << std::setprecision(4) << (den ? static_cast<double>(num) / den : 0.0);
+        }
+    }
+    *out << "\n";
+
+    rows++;
+    prev.swap(now);
+}
+
+void Sampler::finish() {
+    sample();
+    out->flush();
+}
@@ -0,0 +1,147 @@
+/**
+ * smp.cpp
+ *
+ * Multi-hart scheduling and per-hart coherence timing.
+ */
+
+#include "smp.hpp"
+#include <algorithm>
+
+// =============================================================================
+// Hart Timing
+// =============================================================================
+
+Smp::HartTiming::HartTiming(CoherenceModel& coherence, int hart)
+    : coherence(coherence), hart(hart) {
+    reset();
+}
+
+const char* Smp::HartTiming::name() const { return "hart"; }
+
+void Smp::HartTiming::reset() {
+    cycles = 0;
+    instructions = 0;
+    stall_cycles = 0;
+}
+
+void Smp::HartTiming::retire(const RetiredInsn& r) {
+    instructions++;
+    cycles++;
+    if (r.ins.mem_read || r.ins.mem_write) {
+        int latency = coherence.access(hart, r.mem_addr, access_bytes(r.ins.type), r.ins.mem_write);
+        int extra = latency - coherence.get_config().hit_latency;
+        cycles += extra;
+        stall_cycles += extra;
+    }
+}
+
+uint64_t Smp::HartTiming::get_cycle_count() const { return cycles; }
+uint64_t Smp::HartTiming::get_instruction_count() const { return instructions; }
+
+void Smp::HartTiming::print_config() const {}
+
+void Smp::HartTiming::print_stats() const {
+    std::cout << "    Hart " << hart << ": " << instructions << " instructions, " << cycles
+              << " cycles (" << stall_cycles << " coherence/memory stall)";
+    if (instructions > 0) {
+        std::cout << std::fixed << std::setprecision(2)
+                  << ", CPI " << static_cast<double>(cycles) / instructions;
+    }
+    std::cout << "\n";
+}
+
+Smp::Hart::Hart(Memory& mem, CoherenceModel& coherence, int id)
+    : cpu(mem, regs), timing(coherence, id), done(false) {
+    cpu.set_timing_model(&timing);
+}
+
+// =============================================================================
+// Setup
+// =============================================================================
+
+Smp::Smp(Memory& mem) : mem(mem), stop_hart(-1) {}
+
+void Smp::set_config(const CoherenceModel::Config& cfg) {
+    coherence.configure(cfg);
+}
+
+const CoherenceModel& Smp::get_coherence() const { return coherence; }
+
+void Smp::start(Address entry) {
+    coherence.reset();
+    harts.clear();
+    stop_hart = -1;
+
+    int count = coherence.get_config().harts;
+    for (int h = 0; h < count; h++) {
+        harts.push_back(std::make_unique<Hart>(mem, coherence, h));
+        Hart& hart = *harts.back();
+        hart.cpu.reset();
+        hart.cpu.set_pc(entry);
+        hart.regs.write(2, Memory::STACK_TOP - h * STACK_SIZE);
+        hart.regs.write(4, h);      // tp
+        hart.regs.write(10, h);     // a0
+    }
+}
+
+// =============================================================================
+// Run
+// =============================================================================
+
+StopReason Smp::run(const RunLimits& limits) {
+    auto totals = [this](uint64_t& insns, uint64_t& cycles) {
+        insns = 0;
+        cycles = 0;
+        for (const auto& h : harts) {
+            insns += h->timing.get_instruction_count();
+            cycles = std::max(cycles, h->timing.get_cycle_count());
+        }
+    };
+
+    uint64_t insns, cycles;
+    totals(insns, cycles);
+    watchdog.start(limits, insns, cycles);
+
+    while (true) {
+        // Advance the hart that is furthest behind
+        Hart* next = nullptr;
+        int next_id = -1;
+        for (size_t h = 0; h < harts.size(); h++) {
+            Hart& hart = *harts[h];
+            if (hart.done) continue;
+            if (!next || hart.timing.get_cycle_count() < next->timing.get_cycle_count()) {
+                next = &hart;
+                next_id = static_cast<int>(h);
+            }
+        }
+        if (!next) return StopReason::HALTED;
+
+        StopReason reason = next->cpu.step();
+        if (reason == StopReason::HALTED || reason == StopReason::EXITED) {
+            next->done = true;
+        } else if (reason != StopReason::NONE) {
+            stop_hart = next_id;
+            return reason;
+        }
+
+        totals(insns, cycles);
+        reason = watchdog.tick(insns, cycles);
+        if (reason != StopReason::NONE) return reason;
+    }
+}
+
+int Smp::get_stop_hart() const { return stop_hart; }
+
+Address Smp::get_pc(int hart) const { return harts[hart]->cpu.get_pc(); }
+
+// =============================================================================
+// Display
+// =============================================================================
+
+void Smp::print_stats() const {
+    uint64_t cycles = 0;
+    for (const auto& h : harts) cycles = std::max(cycles, h->timing.get_cycle_count());
+    std::cout << "  SMP run: " << harts.size() << " harts, " << cycles << " cycles\n";
+    for (const auto& h : harts) h->timing.print_stats();
+    coherence.print_stats();
+}
@@ -0,0 +1,262 @@
+/**
+ * stats.cpp
+ *
+ * Statistics registry and text/JSON/CSV dumps.
+ */
+
+#include "stats.hpp"
+#include <cmath>
+
+// =============================================================================
+// Registration
+// =============================================================================
+
+void StatsRegistry::add_counter(const std::string& name, const uint64_t* counter,
+                                const std::string& desc) {
+    Entry e;
+    e.data = counter;
+    e.base.assign(1, 0);
+    e.desc = desc;
+    entries[name] = std::move(e);
+}
+
+void StatsRegistry::add_computed(const std::string& name, Reader read, const std::string& desc) {
+    Entry e;
+    e.read = std::move(read);
+    e.base.assign(1, 0);
+    e.desc = desc;
+    entries[name] = std::move(e);
+}
+
+void StatsRegistry::add_histogram(const std::string& name, const uint64_t* buckets,
+                                  const std::vector<std::string>& labels, const std::string& desc) {
+    Entry e;
+    e.kind = Kind::HISTOGRAM;
+    e.data = buckets;
+    e.labels = labels;
+    e.base.assign(labels.size(), 0);
+    e.desc = desc;
+    entries[name] = std::move(e);
+}
+
+void StatsRegistry::add_formula(const std::string& name, Formula formula, const std::string& desc) {
+    Entry e;
+    e.kind = Kind::FORMULA;
+    e.formula = std::move(formula);
+    e.desc = desc;
+    entries[name] = std::move(e);
+}
+
+void StatsRegistry::remove(const std::string& prefix) {
+    for (auto it : select(prefix)) entries.erase(it);
+}
+
+bool StatsRegistry::below(const std::string& name, const std::string& prefix) {
+    if (prefix.empty()) return true;
+    if (name.compare(0, prefix.size(), prefix) != 0) return false;
+    return name.size() == prefix.size() || name[prefix.size()] == '.';
+}
+
+std::vector<StatsRegistry::EntryMap::const_iterator>
+StatsRegistry::select(const std::string& prefix) const {
+    // Names starting with the prefix are contiguous, but for "caches.l1"
+    // they include "caches.l1d", which is not below it
+    std::vector<EntryMap::const_iterator> selected;
+    for (auto it = entries.lower_bound(prefix);
+         it != entries.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+        if (below(it->first, prefix)) selected.push_back(it);
+    }
+    return selected;
+}
+
+// =============================================================================
+// Values
+// =============================================================================
+
+uint64_t StatsRegistry::raw(const Entry& e, size_t i) {
+    return e.read ? e.read() : e.data[i];
+}
+
+uint64_t StatsRegistry::since_reset(const Entry& e, size_t i) {
+    // A component reset after the baseline was taken counts from zero again
+    uint64_t now = raw(e, i);
+    return now >= e.base[i] ? now - e.base[i] : now;
+}
+
+bool StatsRegistry::has(const std::string& name) const {
+    return entries.count(name) > 0;
+}
+
+uint64_t StatsRegistry::total(const std::string& name) const {
+    auto it = entries.find(name);
+    if (it == entries.end() || it->second.kind != Kind::COUNTER) return 0;
+    return raw(it->second, 0);
+}
+
+uint64_t StatsRegistry::value(const std::string& name) const {
+    auto it = entries.find(name);
+    if (it == entries.end() || it->second.kind != Kind::COUNTER) return 0;
+    return since_reset(it->second, 0);
+}
+
+double StatsRegistry::ratio(const std::string& num, const std::string& den) const {
+    uint64_t d = value(den);
+    return d ? static_cast<double>(value(num)) / d : 0.0;
+}
+
+void StatsRegistry::reset() {
+    for (auto& [name, e] : entries) {
+        for (size_t i = 0; i < e.base.size(); i++) e.base[i] = raw(e, i);
+    }
+}
+
+bool StatsRegistry::parse_format(const std::string& text, Format& format) {
+    if (text == "text" || text == "txt") format = Format::TEXT;
+    else if (text == "json") format = Format::JSON;
+    else if (text == "csv") format = Format::CSV;
+    else return false;
+    return true;
+}
+
+// =============================================================================
+// Dumps
+// =============================================================================
+
+void StatsRegistry::dump(std::ostream& out, Format format, const std::string& prefix) const {
+    switch (format) {
+        case Format::TEXT: dump_text(out, prefix); break;
+        case Format::JSON: dump_json(out, prefix); break;
+        case Format::CSV:  dump_csv(out, prefix); break;
+    }
+}
+
+// Formulas can divide by zero-length runs; dumps never show nan/inf
+static double finite_or_zero(double v) {
+    return std::isfinite(v) ? v : 0.0;
+}
+
+void StatsRegistry::dump_text(std::ostream& out, const std::string& prefix) const {
+    auto line = [&out](const std::string& name, const std::string& value, const std::string& desc) {
+        out << std::left << std::setw(44) << name << std::right << std::setw(16) << value;
+        if (!desc.empty()) out << "  # " << desc;
+        out << "\n";
+    };
+
+    for (auto it : select(prefix)) {
+        const std::string& name = it->first;
+        const Entry& e = it->second;
+        if (e.kind == Kind::COUNTER) {
+            line(name, std::to_string(since_reset(e, 0)), e.desc);
+        } else if (e.kind == Kind::FORMULA) {
+            std::ostringstream v;
+            v << std::setprecision(6) << finite_or_zero(e.formula(*this));
+            line(name, v.str(), e.desc);
+        } else {
+            uint64_t total = 0;
+            for (size_t i = 0; i < e.labels.size(); i++) {
+                uint64_t n = since_reset(e, i);
+                total += n;
+                line(name + "::" + e.labels[i], std::to_string(n), i == 0 ? e.desc : "");
+            }
+            line(name + "::total", std::to_string(total), "");
+        }
+    }
+}
+
+static std::string json_string(const std::string& s) {
+    std::string quoted = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') quoted += '\\';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+void StatsRegistry::dump_json(std::ostream& out, const std::string& prefix) const {
+    // Dotted names become nested objects; entries are sorted, so each
+    // object is opened once
+    std::vector<std::string> open;
+    std::vector<bool> first = {true};
+    auto indent = [&out](size_t depth) { out << std::string(2 * depth, ' '); };
+    auto item = [&]() {
+        if (!first.back()) out << ",";
+        first.back() = false;
+        out << "\n";
+        indent(open.size() + 1);
+    };
+
+    out << "{";
+    for (auto it : select(prefix)) {
+        std::vector<std::string> parts;
+        std::stringstream ss(it->first);
+        for (std::string part; std::getline(ss, part, '.');) parts.push_back(part);
+        const size_t depth = parts.size() - 1;
+
+        size_t common = 0;
+        while (common < open.size() && common < depth && open[common] == parts[common]) common++;
+        while (open.size() > common) {
+            open.pop_back();
+            first.pop_back();
+            out << "\n";
+            indent(open.size() + 1);
+            out << "}";
+        }
+        while (open.size() < depth) {
+            item();
+            out << json_string(parts[open.size()]) << ": {";
+            open.push_back(parts[open.size()]);
+            first.push_back(true);
+        }
+
+        const Entry& e = it->second;
+        item();
+        out << json_string(parts.back()) << ": ";
+        if (e.kind == Kind::COUNTER) {
+            out << since_reset(e, 0);
+        } else if (e.kind == Kind::FORMULA) {
+            out << std::setprecision(6) << finite_or_zero(e.formula(*this));
+        } else {
+            out << "{";
+            for (size_t i = 0; i < e.labels.size(); i++) {
+                out << (i ? ", " : "") << json_string(e.labels[i]) << ": " << since_reset(e, i);
+            }
+            out << "}";
+        }
+    }
+    while (!open.empty()) {
+        open.pop_back();
+        out << "\n";
+        indent(open.size() + 1);
+        out << "}";
+    }
+    out << "\n}\n";
+}
+
+static std::string csv_field(const std::string& s) {
+    if (s.find_first_of(",\"\n") == std::string::npos) return s;
+    std::string quoted = "\"";
+    for (char c : s) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+void StatsRegistry::dump_csv(std::ostream& out, const std::string& prefix) const {
+    out << "name,value,description\n";
+    for (auto it : select(prefix)) {
+        const std::string& name = it->first;
+        const Entry& e = it->second;
+        if (e.kind == Kind::COUNTER) {
+            out << name << "," << since_reset(e, 0) << "," << csv_field(e.desc) << "\n";
+        } else if (e.kind == Kind::FORMULA) {
+            out << name << "," << std::setprecision(6) << finite_or_zero(e.formula(*this)) << ","
+                << csv_field(e.desc) << "\n";
+        } else {
+            for (size_t i = 0; i < e.labels.size(); i++) {
+                out << name << "::" << e.labels[i] << "," << since_reset(e, i) << ","
+                    << csv_field(e.desc) << "\n";
+            }
+        }
+    }
+}
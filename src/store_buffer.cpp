@@ -0,0 +1,96 @@
+/**
+ * store_buffer.cpp
+ *
+ * Store buffer implementation.
+ */
+
+#include "store_buffer.hpp"
+#include <algorithm>
+
+void StoreBuffer::configure(int buffer_depth, int latency, Policy drain_policy) {
+    depth = std::clamp(buffer_depth, 0, MAX_DEPTH);
+    drain_latency = std::max(latency, 1);
+    policy = drain_policy;
+    reset();
+}
+
+void StoreBuffer::reset() {
+    head = 0;
+    count = 0;
+    next_drain = 0;
+    drained = 0;
+    occupancy_sum = 0;
+    ticks = 0;
+}
+
+void StoreBuffer::push(Address addr, int bytes, Address pc) {
+    entries[(head + count) % MAX_DEPTH] = {addr, bytes, pc};
+    count++;
+}
+
+StoreBuffer::Match StoreBuffer::lookup(Address addr, int bytes) const {
+    // Youngest first: the most recent overlapping store decides
+    for (int i = count - 1; i >= 0; i--) {
+        const Entry& e = entries[(head + i) % MAX_DEPTH];
+        if (addr < e.addr + e.bytes && e.addr < addr + bytes) {
+            bool covers = e.addr <= addr && addr + bytes <= e.addr + e.bytes;
+            return covers ? Match::FORWARD : Match::CONFLICT;
+        }
+    }
+    return Match::NONE;
+}
+
+// The policy keeps the oldest store back, unless a load is stuck behind it
+bool StoreBuffer::held(bool load_in_mem, bool load_waiting) const {
+    if (load_waiting) return false;
+    if (policy == Policy::IDLE && load_in_mem) return true;
+    if (policy == Policy::LAZY && count * 2 <= depth) return true;
+    return false;
+}
+
+bool StoreBuffer::tick(uint64_t cycle, bool load_in_mem, bool load_waiting) {
+    ticks++;
+    occupancy_sum += count;
+
+    if (count == 0 || cycle < next_drain) return false;
+    return !held(load_in_mem, load_waiting);
+}
+
+uint64_t StoreBuffer::quiet_cycles(uint64_t cycle, bool load_in_mem, bool load_waiting) const {
+    if (count == 0 || held(load_in_mem, load_waiting)) return std::numeric_limits<uint64_t>::max();
+    return next_drain > cycle ? next_drain - cycle : 0;
+}
+
+void StoreBuffer::skip(uint64_t n) {
+    ticks += n;
+    occupancy_sum += count * n;
+}
+
+void StoreBuffer::drain(uint64_t cycle, int write_latency) {
+    head = (head + 1) % MAX_DEPTH;
+    count--;
+    drained++;
+    next_drain = cycle + std::max(drain_latency, write_latency);
+}
+
+double StoreBuffer::get_avg_occupancy() const {
+    return ticks ? static_cast<double>(occupancy_sum) / ticks : 0.0;
+}
+
+void StoreBuffer::register_stats(StatsRegistry& stats, const std::string& prefix) const {
+    stats.add_counter(prefix + ".drained", &drained, "Stores written to the cache");
+    stats.add_counter(prefix + ".occupancy_sum", &occupancy_sum, "Entries summed over cycles");
+    stats.add_counter(prefix + ".cycles", &ticks, "Cycles observed");
+    stats.add_formula(prefix + ".avg_occupancy", [prefix](const StatsRegistry& s) {
+        return s.ratio(prefix + ".occupancy_sum", prefix + ".cycles");
+    }, "Average entries in use");
+}
+
+const char* StoreBuffer::policy_name(Policy p) {
+    switch (p) {
+        case Policy::EAGER: return "eager";
+        case Policy::IDLE:  return "idle";
+        case Policy::LAZY:  return "lazy";
+    }
+    return "?";
+}
@@ -0,0 +1,78 @@
+/**
+ * watchdog.cpp
+ *
+ * Run limit checking and SIGINT handling.
+ */
+
+#include "watchdog.hpp"
+#include <algorithm>
+
+volatile std::sig_atomic_t Watchdog::interrupt_flag = 0;
+
+// =============================================================================
+// Run Start
+// =============================================================================
+
+void Watchdog::start(const RunLimits& run_limits, uint64_t instructions, uint64_t cycles) {
+    limits = run_limits;
+    insn_end = instructions + limits.max_instructions;
+    cycle_end = cycles + limits.max_cycles;
+    deadline = std::chrono::steady_clock::now() +
+               std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                   std::chrono::duration<double>(limits.max_seconds));
+    clear_interrupt();
+    if (sample_period) {
+        uint64_t now = sample_cycles ? cycles : instructions;
+        sample_end = (now / sample_period + 1) * sample_period;
+    }
+
+    // Full check after the first step
+    budget = 1;
+}
+
+void Watchdog::set_sampling(uint64_t period, bool by_cycles, std::function<void()> callback) {
+    sample_period = period;
+    sample_cycles = by_cycles;
+    sample = std::move(callback);
+    sample_end = period;
+}
+
+// =============================================================================
+// Slow-Path Check
+// =============================================================================
+
+StopReason Watchdog::check(uint64_t instructions, uint64_t cycles) {
+    // Sample before stopping, so a limit on a boundary does not lose it
+    uint64_t sample_now = sample_cycles ? cycles : instructions;
+    if (sample_period && sample_now >= sample_end) {
+        sample();
+        sample_end = (sample_now / sample_period + 1) * sample_period;
+    }
+
+    if (interrupt_flag) return StopReason::INTERRUPTED;
+    if (limits.max_instructions && instructions >= insn_end) return StopReason::INSN_LIMIT;
+    if (limits.max_cycles && cycles >= cycle_end) return StopReason::CYCLE_LIMIT;
+    if (limits.max_seconds > 0 && std::chrono::steady_clock::now() >= deadline) {
+        return StopReason::TIME_LIMIT;
+    }
+
+    // Next check: never step past an instruction or cycle limit.
+    // Each step retires at most one instruction and takes at least one cycle.
+    budget = CHECK_INTERVAL;
+    if (limits.max_instructions) budget = std::min(budget, insn_end - instructions);
+    if (limits.max_cycles) budget = std::min(budget, cycle_end - cycles);
+    if (sample_period) budget = std::min(budget, sample_end - sample_now);
+    return StopReason::NONE;
+}
+
+// =============================================================================
+// Interrupt Handling
+// =============================================================================
+
+extern "C" void watchdog_sigint(int) {
+    Watchdog::request_interrupt();
+}
+
+void Watchdog::install_interrupt_handler() {
+    std::signal(SIGINT, watchdog_sigint);
+}
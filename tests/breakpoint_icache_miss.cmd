@@ -0,0 +1,8 @@
+# A breakpoint on a line that misses in the L1I stops once per arrival,
+# not on every cycle of the fill
+load examples/hazard_demo.asm
+cache load examples/caches.cfg
+mode p
+break 0x40
+run
+run
@@ -0,0 +1,56 @@
+# The Pipeline over the configured cache hierarchy ends with the registers
+# and stop reason of the single-cycle CPU
+limit cycles 100000
+cache load examples/caches.cfg
+load examples/factorial.asm
+run
+regs
+mode p
+reset
+run
+regs
+storebuf 4 policy lazy
+reset
+run
+regs
+storebuf off
+mode s
+load examples/fibonacci.asm
+run
+regs
+mode p
+reset
+run
+regs
+storebuf 4 policy lazy
+reset
+run
+regs
+storebuf off
+mode s
+load examples/hazard_demo.asm
+run
+regs
+mode p
+reset
+run
+regs
+storebuf 4 policy lazy
+reset
+run
+regs
+storebuf off
+mode s
+load tests/store_overlap.asm
+run
+regs
+mode p
+reset
+run
+regs
+storebuf 4 policy lazy
+reset
+run
+regs
+storebuf off
+mode s
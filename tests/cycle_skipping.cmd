@@ -0,0 +1,104 @@
+# With caches on, the Pipeline skips stall cycles in 'run' but not in
+# 'run until': both must take the same cycles and, for every branch
+# resolution stage, end with the registers of the single-cycle CPU
+limit cycles 100000
+cache load examples/caches.cfg
+load examples/factorial.asm
+run
+regs
+mode p
+resolve id
+reset
+run
+regs
+stats text pipeline.cycles
+stats text pipeline.skipped_cycles
+reset
+run until 0
+stats text pipeline.cycles
+resolve ex
+reset
+run
+regs
+stats text pipeline.cycles
+stats text pipeline.skipped_cycles
+reset
+run until 0
+stats text pipeline.cycles
+resolve mem
+reset
+run
+regs
+stats text pipeline.cycles
+stats text pipeline.skipped_cycles
+reset
+run until 0
+stats text pipeline.cycles
+resolve ex
+mode s
+load examples/fibonacci.asm
+run
+regs
+mode p
+resolve id
+reset
+run
+regs
+stats text pipeline.cycles
+stats text pipeline.skipped_cycles
+reset
+run until 0
+stats text pipeline.cycles
+resolve ex
+reset
+run
+regs
+stats text pipeline.cycles
+stats text pipeline.skipped_cycles
+reset
+run until 0
+stats text pipeline.cycles
+resolve mem
+reset
+run
+regs
+stats text pipeline.cycles
+stats text pipeline.skipped_cycles
+reset
+run until 0
+stats text pipeline.cycles
+resolve ex
+mode s
+load examples/hazard_demo.asm
+run
+regs
+mode p
+resolve id
+reset
+run
+regs
+stats text pipeline.cycles
+stats text pipeline.skipped_cycles
+reset
+run until 0
+stats text pipeline.cycles
+resolve ex
+reset
+run
+regs
+stats text pipeline.cycles
+stats text pipeline.skipped_cycles
+reset
+run until 0
+stats text pipeline.cycles
+resolve mem
+reset
+run
+regs
+stats text pipeline.cycles
+stats text pipeline.skipped_cycles
+reset
+run until 0
+stats text pipeline.cycles
+resolve ex
+mode s
@@ -0,0 +1,18 @@
+# forward_mem_wb.asm
+# Producers two instructions ahead of their consumer reach it over the
+# MEM/WB forwarding path
+
+.data
+value:  .word 9
+
+.text
+main:
+    li      t0, 5
+    li      t1, 7
+    add     t2, t0, t0      # t0 from MEM/WB
+    add     t3, t1, t2      # t1 from MEM/WB, t2 from EX/MEM
+    la      s0, value
+    lw      t4, 0(s0)
+    nop
+    add     t5, t4, t4      # loaded value from MEM/WB
+    ecall
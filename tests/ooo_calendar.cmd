@@ -0,0 +1,6 @@
+# Divider reservations spanning more than the initial calendar are kept:
+# 4000 independent divides on one 20-cycle divider take 80000 cycles
+load tests/ooo_divides.asm
+timing ooo rob 4096 iq 4096 regs 4200 lq 64
+run
+stats
@@ -0,0 +1,17 @@
+# ooo_divides.asm
+# Independent divides on one unpipelined divider: with a large window the
+# reservations in flight span far more than the initial calendar
+
+.text
+main:
+    li      t0, 1000
+    li      t1, 7
+    li      t2, 3
+loop:
+    div     t3, t1, t2
+    div     t4, t1, t2
+    div     t5, t1, t2
+    div     t6, t1, t2
+    addi    t0, t0, -1
+    bnez    t0, loop
+    ecall
@@ -0,0 +1,7 @@
+# MEM/WB forwarding: distance-2 producers must reach the consumer
+load tests/forward_mem_wb.asm
+mode p
+run
+reg t2
+reg t3
+reg t5
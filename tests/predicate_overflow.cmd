@@ -0,0 +1,12 @@
+# Expression arithmetic wraps instead of overflowing; the INT64_MIN / -1
+# quotient follows RISC-V. Constant and run-time operands fold the same way.
+load examples/fibonacci.asm
+if (1 << 63) / -1 == 1 << 63 pc
+if (1 << 63) % -1 == 0 pc
+if (1 << 63) / (zero - 1) == 1 << 63 pc
+if (1 << 63) % (zero - 1) == 0 pc
+if 0x7fffffffffffffff * 2 == -2 pc
+if (0x7fffffffffffffff + zero) * 2 == -2 pc
+if 0x7fffffffffffffff + 1 == 1 << 63 pc
+if 1 << (zero + 63) == -(1 << 63) pc
+if 3 << 62 == -(1 << 62) pc
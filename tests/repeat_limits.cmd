@@ -0,0 +1,10 @@
+# repeat/step until stop at the run limits, and a repeated command that
+# does not advance the program stops instead of spinning
+load examples/fibonacci.asm
+repeat regs until pc == 0x1000
+limit insns 5
+step until pc == 0x1000
+repeat step until pc == 0x1000
+repeat step 2 quiet until pc == 0x1000
+limit off
+step 2 quiet
@@ -0,0 +1,25 @@
+#!/bin/sh
+# Regression tests: run each tests/<name>.cmd script with the emulator
+# and compare its output with tests/<name>.out
+#
+# Usage: tests/run.sh [emulator]   (from the repository root)
+
+emu=${1:-bin/riscv-emu}
+failed=0
+
+for script in tests/*.cmd; do
+    name=$(basename "$script" .cmd)
+    if "$emu" -x "$script" 2>&1 | diff -u "tests/$name.out" - > "/tmp/riscv-test-$name.diff"; then
+        echo "PASS  $name"
+    else
+        echo "FAIL  $name"
+        cat "/tmp/riscv-test-$name.diff"
+        failed=$((failed + 1))
+    fi
+    rm -f "/tmp/riscv-test-$name.diff"
+done
+
+if [ "$failed" -ne 0 ]; then
+    echo "$failed test(s) failed"
+    exit 1
+fi
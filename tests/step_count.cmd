@@ -0,0 +1,7 @@
+# Step counts below 1 are rejected instead of running to the end
+load examples/fibonacci.asm
+step -1
+step 0 quiet
+mode p
+step -5 quiet
+step 3 quiet
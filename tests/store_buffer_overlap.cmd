@@ -0,0 +1,23 @@
+# Partial-overlap loads drain the store buffer under every policy
+load tests/store_overlap.asm
+mode p
+limit cycles 1000
+storebuf 4 policy eager
+run
+reg t1
+reg t3
+storebuf 4 policy idle
+reset
+run
+reg t1
+reg t3
+storebuf 4 policy lazy
+reset
+run
+reg t1
+reg t3
+cache on
+reset
+run
+reg t1
+reg t3
@@ -0,0 +1,75 @@
+# Every store buffer policy ends with the registers and stop reason of the
+# single-cycle CPU
+limit cycles 100000
+load examples/factorial.asm
+run
+regs
+mode p
+storebuf 4 policy eager
+reset
+run
+regs
+storebuf 4 policy idle
+reset
+run
+regs
+storebuf 4 policy lazy
+reset
+run
+regs
+storebuf off
+mode s
+load examples/fibonacci.asm
+run
+regs
+mode p
+storebuf 4 policy eager
+reset
+run
+regs
+storebuf 4 policy idle
+reset
+run
+regs
+storebuf 4 policy lazy
+reset
+run
+regs
+storebuf off
+mode s
+load examples/hazard_demo.asm
+run
+regs
+mode p
+storebuf 4 policy eager
+reset
+run
+regs
+storebuf 4 policy idle
+reset
+run
+regs
+storebuf 4 policy lazy
+reset
+run
+regs
+storebuf off
+mode s
+load tests/store_overlap.asm
+run
+regs
+mode p
+storebuf 4 policy eager
+reset
+run
+regs
+storebuf 4 policy idle
+reset
+run
+regs
+storebuf 4 policy lazy
+reset
+run
+regs
+storebuf off
+mode s
@@ -0,0 +1,17 @@
+# store_overlap.asm
+# Loads that only partially overlap a buffered store wait for it to drain
+
+.data
+buf:    .word 0x11223344
+        .word 0
+
+.text
+main:
+    la      s0, buf
+    li      t0, 0x55
+    sb      t0, 1(s0)
+    lw      t1, 0(s0)       # word over a buffered byte
+    sh      t0, 4(s0)
+    lb      t2, 5(s0)       # byte inside a buffered half: forwarded
+    lh      t3, 3(s0)       # half across two stores
+    ecall
@@ -0,0 +1,18 @@
+# Each timing model accepts only the options it reads, with valid values
+load examples/factorial.asm
+timing interval rob 64
+timing interval width 2
+timing ooo resolve id
+timing interval resolve id forward off
+timing inorder forward onn
+timing interval hazards yes
+timing inorder width 9
+timing inorder width 0
+timing ooo mul 9
+timing ooo regs 32
+timing inorder width 8 forward OFF
+mode p
+timing inorder fetch 2
+timing inorder width 2 div 10
+mode s
+timing inorder fetch 2 div 10
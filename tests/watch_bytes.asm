@@ -0,0 +1,18 @@
+# watch_bytes.asm
+# Narrow stores just below a watched word do not touch it
+
+.data
+below:  .word 0
+target: .word 0
+
+.text
+main:
+    la      s0, below
+    li      t0, 0x7f
+    sb      t0, 3(s0)       # last byte below target
+    sh      t0, 2(s0)       # last half below target
+    sw      t0, 0(s0)
+    li      t1, 1
+    sb      t0, 5(s0)       # inside target
+    li      t1, 2
+    ecall
@@ -0,0 +1,9 @@
+# A watchpoint stops on stores that touch the word, by their real width
+load tests/watch_bytes.asm
+watch target
+run
+reg t1
+mode p
+watch target
+run
+reg t1